@@ -0,0 +1,69 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <chrono>
+#include "bof_utils.h"
+#include "flash_blas.h"
+#include "lib_funcs.h"
+
+using namespace std::chrono;
+
+std::string mnt_dir = "/tmp/gemv_driver_temps";
+
+flash::Logger logger("gemv_driver");
+
+int main(int argc, char** argv) {
+  if (argc != 12) {
+    LOG_INFO(logger,
+             "Usage Mode : <exec> <mat_A_file> <vec_x_file> <vec_y_file> "
+             "<A_nrows> <A_ncols> <n_rhs> <alpha> <beta> <a transpose?> "
+             "<matr order> <lda_a>");
+    LOG_FATAL(logger, "expected 11 args, got ", argc - 1);
+  }
+
+  // init blas-on-flash
+  LOG_DEBUG(logger, "setting up flash context");
+  flash::flash_setup(mnt_dir);
+
+  // map matrix & vectors to flash pointers
+  std::string A_name = std::string(argv[1]);
+  std::string x_name = std::string(argv[2]);
+  std::string y_name = std::string(argv[3]);
+  LOG_DEBUG(logger, "map files to flash_ptr");
+  flash::flash_ptr<FPTYPE> mat_A =
+      flash::map_file<FPTYPE>(A_name, flash::Mode::READWRITE);
+  flash::flash_ptr<FPTYPE> vec_x =
+      flash::map_file<FPTYPE>(x_name, flash::Mode::READWRITE);
+  flash::flash_ptr<FPTYPE> vec_y =
+      flash::map_file<FPTYPE>(y_name, flash::Mode::READWRITE);
+
+  // problem dimension
+  FBLAS_UINT m = (FBLAS_UINT) std::stol(argv[4]);
+  FBLAS_UINT n = (FBLAS_UINT) std::stol(argv[5]);
+  FBLAS_UINT n_rhs = (FBLAS_UINT) std::stol(argv[6]);
+  FPTYPE     alpha = (FPTYPE) std::stof(argv[7]);
+  FPTYPE     beta = (FPTYPE) std::stof(argv[8]);
+  CHAR       trans_a = argv[9][0];
+  CHAR       mat_ord = argv[10][0];
+  FBLAS_UINT lda_a = (FBLAS_UINT) std::stol(argv[11]);
+
+  LOG_INFO(logger, "dimensions : A = ", m, "x", n, ", n_rhs = ", n_rhs);
+
+  // execute gemv call
+  high_resolution_clock::time_point t1 = high_resolution_clock::now();
+  FBLAS_INT res = flash::gemv(mat_ord, trans_a, m, n, alpha, beta, mat_A,
+                              vec_x, vec_y, n_rhs, lda_a);
+  high_resolution_clock::time_point t2 = high_resolution_clock::now();
+  duration<double> span = duration_cast<duration<double>>(t2 - t1);
+  LOG_INFO(logger, "gemv() took ", span.count());
+
+  LOG_INFO(logger, "flash::gemv() returned with ", res);
+
+  LOG_DEBUG(logger, "un-map files");
+  flash::unmap_file(mat_A);
+  flash::unmap_file(vec_x);
+  flash::unmap_file(vec_y);
+
+  LOG_DEBUG(logger, "destroying flash context");
+  flash::flash_destroy();
+}
@@ -5,8 +5,9 @@
 #include <fstream>
 #include "bof_types.h"
 #include "bof_utils.h"
-#include "mkl.h"
+#include "mkl_traits.h"
 
+typedef flash::MklTraits<FPTYPE> mkl;
 flash::Logger logger("in_mem_csrcsc");
 
 int main(int argc, char **argv) {
@@ -74,8 +75,8 @@ int main(int argc, char **argv) {
 
   // execute csrcsc call
   LOG_INFO(logger, "Starting csrcsc call");
-  mkl_csrcsc(job, &dim, vals_a, idxs_a, offs_a, vals_atr, idxs_atr, offs_atr,
-             &info);
+  mkl::csrcsc(job, &dim, vals_a, idxs_a, offs_a, vals_atr, idxs_atr, offs_atr,
+              &info);
   LOG_INFO(logger, "Finished csrcsc call");
   LOG_INFO(logger, "Input nnzs=", offs_a[dim], ", Output nnzs=", offs_atr[dim]);
 
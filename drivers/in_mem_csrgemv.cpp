@@ -5,8 +5,10 @@
 #include "bof_utils.h"
 #include "flash_blas.h"
 #include "lib_funcs.h"
+#include "mkl_traits.h"
 
 using namespace flash;
+typedef MklTraits<FPTYPE> mkl;
 flash::Logger logger("csrgemv");
 
 int main(int argc, char **argv) {
@@ -79,8 +81,8 @@ int main(int argc, char **argv) {
 
   // execute csrmm call
   LOG_INFO(logger, "Starting mkl_csrgemv call");
-  mkl_csrgemv(&trans_a, &dim, a_vals_ptr, a_offs_ptr, a_idxs_ptr, b_vals_ptr,
-              c_vals_ptr);
+  mkl::csrgemv(&trans_a, &dim, a_vals_ptr, a_offs_ptr, a_idxs_ptr, b_vals_ptr,
+               c_vals_ptr);
   LOG_INFO(logger, "Finished mkl_csrgemv");
 
   // unmap files
@@ -6,8 +6,10 @@
 #include "bof_utils.h"
 #include "flash_blas.h"
 #include "lib_funcs.h"
+#include "mkl_traits.h"
 
 using namespace flash;
+typedef MklTraits<FPTYPE> mkl;
 flash::Logger logger("in_mem");
 
 int main(int argc, char **argv) {
@@ -116,8 +118,8 @@ int main(int argc, char **argv) {
   // start MKL call
   LOG_INFO(logger, "Starting mkl_csrmm call");
   Timer timer;
-  mkl_csrmm(&trans_a, &m, &n, &k, &alpha, &matdescra[0], vals_a, idxs_a, offs_a,
-            offs_a + 1, vals_b, &ldb, &beta, vals_c, &ldc);
+  mkl::csrmm(&trans_a, &m, &n, &k, &alpha, &matdescra[0], vals_a, idxs_a,
+             offs_a, offs_a + 1, vals_b, &ldb, &beta, vals_c, &ldc);
   LOG_INFO(logger, "mkl_csrmm() took ", timer.elapsed() / 1000);
   LOG_INFO(logger, "Finished mkl_csrmm call");
 
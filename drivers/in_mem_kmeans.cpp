@@ -3,18 +3,20 @@
 
 #include "bof_types.h"
 #include "flash_blas.h"
+#include "mkl_traits.h"
 
 #include <algorithm>
 #include <vector>
 
 using namespace flash;
+typedef MklTraits<FPTYPE> mkl;
 flash::Logger logger("in_mem");
 
 FPTYPE distsq(const FPTYPE *const p1_coords, const FPTYPE *const p2_coords,
               const FBLAS_UINT dim) {
-  return mkl_dot(dim, p1_coords, 1, p1_coords, 1) +
-         mkl_dot(dim, p2_coords, 1, p2_coords, 1) -
-         2 * mkl_dot(dim, p1_coords, 1, p2_coords, 1);
+  return mkl::dot(dim, p1_coords, 1, p1_coords, 1) +
+         mkl::dot(dim, p2_coords, 1, p2_coords, 1) -
+         2 * mkl::dot(dim, p1_coords, 1, p2_coords, 1);
 }
 
 void distsq_points_to_centers(
@@ -31,15 +33,15 @@ void distsq_points_to_centers(
                 (FPTYPE) 1.0);
     ones_vec_alloc = true;
   }
-  mkl_gemm(CblasColMajor, CblasTrans, CblasNoTrans, ncenters, npoints, dim,
-           (FPTYPE) -2.0, centers, dim, points, dim, (FPTYPE) 0.0, dist_matrix,
-           ncenters);
-  mkl_gemm(CblasColMajor, CblasNoTrans, CblasTrans, ncenters, npoints, 1,
-           (FPTYPE) 1.0, centers_l2sq, ncenters, ones_vec, npoints,
-           (FPTYPE) 1.0, dist_matrix, ncenters);
-  mkl_gemm(CblasColMajor, CblasNoTrans, CblasTrans, ncenters, npoints, 1,
-           (FPTYPE) 1.0, ones_vec, ncenters, points_l2sq, npoints, (FPTYPE) 1.0,
-           dist_matrix, ncenters);
+  mkl::gemm(CblasColMajor, CblasTrans, CblasNoTrans, ncenters, npoints, dim,
+            (FPTYPE) -2.0, centers, dim, points, dim, (FPTYPE) 0.0, dist_matrix,
+            ncenters);
+  mkl::gemm(CblasColMajor, CblasNoTrans, CblasTrans, ncenters, npoints, 1,
+            (FPTYPE) 1.0, centers_l2sq, ncenters, ones_vec, npoints,
+            (FPTYPE) 1.0, dist_matrix, ncenters);
+  mkl::gemm(CblasColMajor, CblasNoTrans, CblasTrans, ncenters, npoints, 1,
+            (FPTYPE) 1.0, ones_vec, ncenters, points_l2sq, npoints,
+            (FPTYPE) 1.0, dist_matrix, ncenters);
   if (ones_vec_alloc)
     delete[] ones_vec;
 }
@@ -75,14 +77,14 @@ void closest_centers(
   FPTYPE *const centers_l2sq = new FPTYPE[ncenters];
   for (FBLAS_UINT c = 0; c < ncenters; ++c)
     centers_l2sq[c] =
-        mkl_dot(ndims, centers + c * ndims, 1, centers + c * ndims, 1);
+        mkl::dot(ndims, centers + c * ndims, 1, centers + c * ndims, 1);
   distsq_points_to_centers(ndims, ncenters, centers, centers_l2sq, npoints,
                            points, points_l2sq, dist_matrix);
 
 #pragma omp parallel for
   for (FBLAS_INT d = 0; d < npoints; ++d)
     center_index[d] =
-        (FBLAS_UINT) mkl_imin(ncenters, dist_matrix + d * ncenters, 1);
+        (FBLAS_UINT) mkl::imin(ncenters, dist_matrix + d * ncenters, 1);
   delete[] centers_l2sq;
 }
 
@@ -116,13 +118,13 @@ FPTYPE lloyds_iter(const FPTYPE *const points, const FBLAS_UINT ncenters,
     if (weighted)
       for (auto iter = closest_points[c].begin();
            iter != closest_points[c].end(); ++iter)
-        mkl_axpy(ndims, (FPTYPE)(weights[*iter]) / closest_points[c].size(),
-                 points + (*iter) * ndims, 1, centers + c * ndims, 1);
+        mkl::axpy(ndims, (FPTYPE)(weights[*iter]) / closest_points[c].size(),
+                  points + (*iter) * ndims, 1, centers + c * ndims, 1);
     else
       for (auto iter = closest_points[c].begin();
            iter != closest_points[c].end(); ++iter)
-        mkl_axpy(ndims, (FPTYPE)(1.0) / closest_points[c].size(),
-                 points + (*iter) * ndims, 1, centers + c * ndims, 1);
+        mkl::axpy(ndims, (FPTYPE)(1.0) / closest_points[c].size(),
+                  points + (*iter) * ndims, 1, centers + c * ndims, 1);
 
   FBLAS_INT BUF_PAD = 32;
   FBLAS_INT CHUNK_SIZE = 8196;
@@ -179,7 +181,7 @@ int main(int argc, char **argv) {
   FPTYPE *points_l2sq = new FPTYPE[npoints];
   for (FBLAS_INT p = 0; p < npoints; ++p)
     points_l2sq[p] =
-        mkl_dot(ndims, points + p * ndims, 1, points + p * ndims, 1);
+        mkl::dot(ndims, points + p * ndims, 1, points + p * ndims, 1);
 
   for (FBLAS_UINT i = 0; i < 1; i++) {
     lloyds_iter(points, ncenters, centers, points_l2sq, nullptr, npoints, ndims,
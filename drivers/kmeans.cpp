@@ -4,17 +4,19 @@
 #include "bof_types.h"
 #include "flash_blas.h"
 #include "lib_funcs.h"
+#include "mkl_traits.h"
 
 #include <algorithm>
 #include <vector>
 
 using namespace flash;
+typedef MklTraits<FPTYPE> mkl;
 flash::Logger logger("kmeans");
 
 FPTYPE distsq(FPTYPE *p1_coords, FPTYPE *p2_coords, const FBLAS_UINT dim) {
-  return mkl_dot(dim, p1_coords, 1, p1_coords, 1) +
-         mkl_dot(dim, p2_coords, 1, p2_coords, 1) -
-         2 * mkl_dot(dim, p1_coords, 1, p2_coords, 1);
+  return mkl::dot(dim, p1_coords, 1, p1_coords, 1) +
+         mkl::dot(dim, p2_coords, 1, p2_coords, 1) -
+         2 * mkl::dot(dim, p1_coords, 1, p2_coords, 1);
 }
 
 void distsq_points_to_centers(
@@ -85,7 +87,7 @@ void closest_centers(
     flash::read_sync(cur_center_ptr, cur_center_fptr, ndims);
 
     // compute L2-square norm
-    centers_l2sq[c] = mkl_dot(ndims, cur_center_ptr, 1, cur_center_ptr, 1);
+    centers_l2sq[c] = mkl::dot(ndims, cur_center_ptr, 1, cur_center_ptr, 1);
     delete[] cur_center_ptr;
   }
   distsq_points_to_centers(ndims, ncenters, centers, centers_l2sq, npoints,
@@ -95,7 +97,7 @@ void closest_centers(
   for (FBLAS_INT d = 0; d < npoints; ++d) {
     flash_ptr<FPTYPE> cur_pt_dists_fptr = (dist_matrix + d * ncenters);
     FPTYPE *          cur_pt_dists_ptr = cur_pt_dists_fptr.get_raw_ptr();
-    center_index[d] = (FBLAS_UINT) mkl_imin(ncenters, cur_pt_dists_ptr, 1);
+    center_index[d] = (FBLAS_UINT) mkl::imin(ncenters, cur_pt_dists_ptr, 1);
   }
   delete[] centers_l2sq;
 }
@@ -145,11 +147,11 @@ FPTYPE lloyds_iter(flash_ptr<FPTYPE> points, const FBLAS_UINT ncenters,
       flash::read_sync(cur_point_ptr, cur_point_fptr, ndims);
 
       if (weighted)
-        mkl_axpy(ndims, (FPTYPE)(weights[*iter]) / closest_points[c].size(),
-                 cur_point_ptr, 1, cur_center_ptr, 1);
+        mkl::axpy(ndims, (FPTYPE)(weights[*iter]) / closest_points[c].size(),
+                  cur_point_ptr, 1, cur_center_ptr, 1);
       else
-        mkl_axpy(ndims, (FPTYPE)(1.0) / closest_points[c].size(), cur_point_ptr,
-                 1, cur_center_ptr, 1);
+        mkl::axpy(ndims, (FPTYPE)(1.0) / closest_points[c].size(),
+                  cur_point_ptr, 1, cur_center_ptr, 1);
     }
 
     flash::write_sync(cur_center_fptr, cur_center_ptr, ndims);
@@ -213,7 +215,7 @@ int main(int argc, char **argv) {
   FPTYPE *points_l2sq = new FPTYPE[npoints];
   for (FBLAS_INT p = 0; p < npoints; ++p) {
     points_l2sq[p] =
-        mkl_dot(ndims, points_ptr + p * ndims, 1, points_ptr + p * ndims, 1);
+        mkl::dot(ndims, points_ptr + p * ndims, 1, points_ptr + p * ndims, 1);
   }
 
   for (FBLAS_UINT i = 0; i < 1; i++) {
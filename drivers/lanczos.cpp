@@ -0,0 +1,67 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <chrono>
+#include "bof_utils.h"
+#include "flash_blas.h"
+#include "lib_funcs.h"
+
+using namespace std::chrono;
+
+std::string mnt_dir = "/tmp/lanczos_driver_temps";
+
+flash::Logger logger("lanczos_driver");
+
+int main(int argc, char** argv) {
+  if (argc != 9) {
+    LOG_INFO(logger,
+             "Usage Mode : <exec> <vals_A> <indices_A> <offsets_A> <A_nrows> "
+             "<k> <blk_size> <max_iters> <tol>");
+    LOG_FATAL(logger, "expected 8 args, got ", argc - 1);
+  }
+
+  // init blas-on-flash
+  LOG_DEBUG(logger, "setting up flash context");
+  flash::flash_setup(mnt_dir);
+
+  // map CSR arrays to flash pointers
+  LOG_DEBUG(logger, "map files to flash_ptr");
+  flash::flash_ptr<FPTYPE> a_vals =
+      flash::map_file<FPTYPE>(std::string(argv[1]), flash::Mode::READWRITE);
+  flash::flash_ptr<MKL_INT> a_idxs =
+      flash::map_file<MKL_INT>(std::string(argv[2]), flash::Mode::READWRITE);
+  flash::flash_ptr<MKL_INT> a_offs =
+      flash::map_file<MKL_INT>(std::string(argv[3]), flash::Mode::READWRITE);
+
+  // problem dimension
+  FBLAS_UINT n = (FBLAS_UINT) std::stol(argv[4]);
+  FBLAS_UINT k = (FBLAS_UINT) std::stol(argv[5]);
+  FBLAS_UINT blk_size = (FBLAS_UINT) std::stol(argv[6]);
+  FBLAS_UINT max_iters = (FBLAS_UINT) std::stol(argv[7]);
+  FPTYPE     tol = (FPTYPE) std::stof(argv[8]);
+
+  LOG_INFO(logger, "dimensions : A = ", n, "x", n, ", k = ", k);
+
+  // execute lanczos call
+  FPTYPE* evals = new FPTYPE[k];
+  FPTYPE* evecs = new FPTYPE[n * k];
+  high_resolution_clock::time_point t1 = high_resolution_clock::now();
+  FBLAS_INT res = flash::lanczos(n, a_vals, a_offs, a_idxs, k, blk_size,
+                                 max_iters, tol, evals, evecs);
+  high_resolution_clock::time_point t2 = high_resolution_clock::now();
+  duration<double> span = duration_cast<duration<double>>(t2 - t1);
+  LOG_INFO(logger, "lanczos() took ", span.count());
+
+  LOG_INFO(logger, "flash::lanczos() returned with ", res);
+  LOG_INFO(logger, "largest eigenvalue = ", evals[0]);
+  delete[] evals;
+  delete[] evecs;
+
+  LOG_DEBUG(logger, "un-map files");
+  flash::unmap_file(a_vals);
+  flash::unmap_file(a_idxs);
+  flash::unmap_file(a_offs);
+
+  LOG_DEBUG(logger, "destroying flash context");
+  flash::flash_destroy();
+}
@@ -12,10 +12,11 @@
 #include <fstream>
 #include "bof_types.h"
 #include "bof_utils.h"
-#include "mkl.h"
+#include "mkl_traits.h"
 
 using namespace std::chrono;
 
+typedef flash::MklTraits<FPTYPE> mkl;
 flash::Logger logger("in_mem");
 
 int main(int argc, char** argv) {
@@ -68,10 +69,10 @@ int main(int argc, char** argv) {
   // execute gemm call
 
   high_resolution_clock::time_point t1 = high_resolution_clock::now();
-  mkl_gemm(mat_ord, trans_a, trans_b,          // ordering
-           m, n, k,                            // sizes
-           alpha, mat_A, lda_a, mat_B, lda_b,  // input
-           beta, mat_C, lda_c);                // output
+  mkl::gemm(mat_ord, trans_a, trans_b,          // ordering
+            m, n, k,                            // sizes
+            alpha, mat_A, lda_a, mat_B, lda_b,  // input
+            beta, mat_C, lda_c);                // output
   high_resolution_clock::time_point t2 = high_resolution_clock::now();
   duration<double> span = duration_cast<duration<double>>(t2 - t1);
   LOG_INFO(logger, "gemm() took ", span.count());
@@ -0,0 +1,55 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <chrono>
+#include "bof_utils.h"
+#include "flash_blas.h"
+#include "lib_funcs.h"
+
+using namespace std::chrono;
+
+std::string mnt_dir = "/tmp/potrf_driver_temps";
+
+flash::Logger logger("potrf_driver");
+
+int main(int argc, char** argv) {
+  if (argc != 6) {
+    LOG_INFO(logger,
+             "Usage Mode : <exec> <mat_A_file> <A_nrows> <uplo> <matr order> "
+             "<lda_a>");
+    LOG_FATAL(logger, "expected 5 args, got ", argc - 1);
+  }
+
+  // init blas-on-flash
+  LOG_DEBUG(logger, "setting up flash context");
+  flash::flash_setup(mnt_dir);
+
+  // map matrix to flash pointer
+  std::string A_name = std::string(argv[1]);
+  LOG_DEBUG(logger, "map matrix to flash_ptr");
+  flash::flash_ptr<FPTYPE> mat_A =
+      flash::map_file<FPTYPE>(A_name, flash::Mode::READWRITE);
+
+  // problem dimension
+  FBLAS_UINT n = (FBLAS_UINT) std::stol(argv[2]);
+  CHAR       uplo = argv[3][0];
+  CHAR       mat_ord = argv[4][0];
+  FBLAS_UINT lda_a = (FBLAS_UINT) std::stol(argv[5]);
+
+  LOG_INFO(logger, "dimensions : A = ", n, "x", n);
+
+  // execute potrf call
+  high_resolution_clock::time_point t1 = high_resolution_clock::now();
+  FBLAS_INT res = flash::potrf(mat_ord, uplo, n, mat_A, lda_a);
+  high_resolution_clock::time_point t2 = high_resolution_clock::now();
+  duration<double> span = duration_cast<duration<double>>(t2 - t1);
+  LOG_INFO(logger, "potrf() took ", span.count());
+
+  LOG_INFO(logger, "flash::potrf() returned with ", res);
+
+  LOG_DEBUG(logger, "un-map matrix");
+  flash::unmap_file(mat_A);
+
+  LOG_DEBUG(logger, "destroying flash context");
+  flash::flash_destroy();
+}
@@ -0,0 +1,69 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <chrono>
+#include "bof_utils.h"
+#include "flash_blas.h"
+#include "lib_funcs.h"
+
+using namespace std::chrono;
+
+std::string mnt_dir = "/tmp/rsvd_driver_temps";
+
+flash::Logger logger("rsvd_driver");
+
+int main(int argc, char** argv) {
+  if (argc != 10) {
+    LOG_INFO(logger,
+             "Usage Mode : <exec> <mat_A_file> <A_nrows> <A_ncols> <rank> "
+             "<oversample> <power_iters> <center?> <matr order> <lda_a>");
+    LOG_FATAL(logger, "expected 9 args, got ", argc - 1);
+  }
+
+  // init blas-on-flash
+  LOG_DEBUG(logger, "setting up flash context");
+  flash::flash_setup(mnt_dir);
+
+  // map matrix to flash pointer
+  std::string A_name = std::string(argv[1]);
+  LOG_DEBUG(logger, "map matrix to flash_ptr");
+  flash::flash_ptr<FPTYPE> mat_A =
+      flash::map_file<FPTYPE>(A_name, flash::Mode::READWRITE);
+
+  // problem dimension
+  FBLAS_UINT m = (FBLAS_UINT) std::stol(argv[2]);
+  FBLAS_UINT n = (FBLAS_UINT) std::stol(argv[3]);
+  FBLAS_UINT k = (FBLAS_UINT) std::stol(argv[4]);
+  FBLAS_UINT oversample = (FBLAS_UINT) std::stol(argv[5]);
+  FBLAS_UINT power_iters = (FBLAS_UINT) std::stol(argv[6]);
+  bool       center = (argv[7][0] == 'Y' || argv[7][0] == 'y');
+  CHAR       mat_ord = argv[8][0];
+  FBLAS_UINT lda_a = (FBLAS_UINT) std::stol(argv[9]);
+
+  LOG_INFO(logger, "dimensions : A = ", m, "x", n, ", rank = ", k);
+
+  // execute rsvd call
+  FPTYPE* vals_S = new FPTYPE[k];
+  FPTYPE* vals_U = new FPTYPE[m * k];
+  FPTYPE* vals_V = new FPTYPE[n * k];
+  FPTYPE* mean = (center ? new FPTYPE[n] : nullptr);
+  high_resolution_clock::time_point t1 = high_resolution_clock::now();
+  FBLAS_INT res = flash::rsvd(mat_ord, m, n, mat_A, k, oversample, power_iters,
+                              vals_S, vals_U, vals_V, mean, lda_a);
+  high_resolution_clock::time_point t2 = high_resolution_clock::now();
+  duration<double> span = duration_cast<duration<double>>(t2 - t1);
+  LOG_INFO(logger, "rsvd() took ", span.count());
+
+  LOG_INFO(logger, "flash::rsvd() returned with ", res);
+  LOG_INFO(logger, "largest singular value = ", vals_S[0]);
+  delete[] vals_S;
+  delete[] vals_U;
+  delete[] vals_V;
+  delete[] mean;
+
+  LOG_DEBUG(logger, "un-map matrix");
+  flash::unmap_file(mat_A);
+
+  LOG_DEBUG(logger, "destroying flash context");
+  flash::flash_destroy();
+}
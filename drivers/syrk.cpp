@@ -0,0 +1,67 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <chrono>
+#include "bof_utils.h"
+#include "flash_blas.h"
+#include "lib_funcs.h"
+
+using namespace std::chrono;
+
+std::string mnt_dir = "/tmp/syrk_driver_temps";
+
+flash::Logger logger("syrk_driver");
+
+int main(int argc, char** argv) {
+  if (argc != 13) {
+    LOG_INFO(logger,
+             "Usage Mode : <exec> <mat_A_file> <mat_C_file> <C_nrows> <k> "
+             "<alpha> <beta> <uplo> <a transpose?> <matr order> <lda_a> "
+             "<lda_c> <mirror?>");
+    LOG_FATAL(logger, "expected 12 args, got ", argc - 1);
+  }
+
+  // init blas-on-flash
+  LOG_DEBUG(logger, "setting up flash context");
+  flash::flash_setup(mnt_dir);
+
+  // map matrices to flash pointers
+  std::string A_name = std::string(argv[1]);
+  std::string C_name = std::string(argv[2]);
+  LOG_DEBUG(logger, "map matrices to flash_ptr");
+  flash::flash_ptr<FPTYPE> mat_A =
+      flash::map_file<FPTYPE>(A_name, flash::Mode::READWRITE);
+  flash::flash_ptr<FPTYPE> mat_C =
+      flash::map_file<FPTYPE>(C_name, flash::Mode::READWRITE);
+
+  // problem dimension
+  FBLAS_UINT n = (FBLAS_UINT) std::stol(argv[3]);
+  FBLAS_UINT k = (FBLAS_UINT) std::stol(argv[4]);
+  FPTYPE     alpha = (FPTYPE) std::stof(argv[5]);
+  FPTYPE     beta = (FPTYPE) std::stof(argv[6]);
+  CHAR       uplo = argv[7][0];
+  CHAR       trans = argv[8][0];
+  CHAR       mat_ord = argv[9][0];
+  FBLAS_UINT lda_a = (FBLAS_UINT) std::stol(argv[10]);
+  FBLAS_UINT lda_c = (FBLAS_UINT) std::stol(argv[11]);
+  bool       mirror = (argv[12][0] == 'Y');
+
+  LOG_INFO(logger, "dimensions : C = ", n, "x", n, ", k = ", k);
+
+  // execute syrk call
+  high_resolution_clock::time_point t1 = high_resolution_clock::now();
+  FBLAS_INT res = flash::syrk(mat_ord, uplo, trans, n, k, alpha, beta, mat_A,
+                              mat_C, lda_a, lda_c, mirror);
+  high_resolution_clock::time_point t2 = high_resolution_clock::now();
+  duration<double> span = duration_cast<duration<double>>(t2 - t1);
+  LOG_INFO(logger, "syrk() took ", span.count());
+
+  LOG_INFO(logger, "flash::syrk() returned with ", res);
+
+  LOG_DEBUG(logger, "un-map matrices");
+  flash::unmap_file(mat_A);
+  flash::unmap_file(mat_C);
+
+  LOG_DEBUG(logger, "destroying flash context");
+  flash::flash_destroy();
+}
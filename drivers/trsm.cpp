@@ -0,0 +1,67 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <chrono>
+#include "bof_utils.h"
+#include "flash_blas.h"
+#include "lib_funcs.h"
+
+using namespace std::chrono;
+
+std::string mnt_dir = "/tmp/trsm_driver_temps";
+
+flash::Logger logger("trsm_driver");
+
+int main(int argc, char** argv) {
+  if (argc != 13) {
+    LOG_INFO(logger,
+             "Usage Mode : <exec> <mat_A_file> <mat_B_file> <B_nrows> "
+             "<B_ncols> <alpha> <side> <uplo> <a transpose?> <unit diag?> "
+             "<matr order> <lda_a> <lda_b>");
+    LOG_FATAL(logger, "expected 12 args, got ", argc - 1);
+  }
+
+  // init blas-on-flash
+  LOG_DEBUG(logger, "setting up flash context");
+  flash::flash_setup(mnt_dir);
+
+  // map matrices to flash pointers
+  std::string A_name = std::string(argv[1]);
+  std::string B_name = std::string(argv[2]);
+  LOG_DEBUG(logger, "map matrices to flash_ptr");
+  flash::flash_ptr<FPTYPE> mat_A =
+      flash::map_file<FPTYPE>(A_name, flash::Mode::READWRITE);
+  flash::flash_ptr<FPTYPE> mat_B =
+      flash::map_file<FPTYPE>(B_name, flash::Mode::READWRITE);
+
+  // problem dimension
+  FBLAS_UINT m = (FBLAS_UINT) std::stol(argv[3]);
+  FBLAS_UINT n = (FBLAS_UINT) std::stol(argv[4]);
+  FPTYPE     alpha = (FPTYPE) std::stof(argv[5]);
+  CHAR       side = argv[6][0];
+  CHAR       uplo = argv[7][0];
+  CHAR       trans_a = argv[8][0];
+  CHAR       diag = argv[9][0];
+  CHAR       mat_ord = argv[10][0];
+  FBLAS_UINT lda_a = (FBLAS_UINT) std::stol(argv[11]);
+  FBLAS_UINT lda_b = (FBLAS_UINT) std::stol(argv[12]);
+
+  LOG_INFO(logger, "dimensions : B = ", m, "x", n);
+
+  // execute trsm call
+  high_resolution_clock::time_point t1 = high_resolution_clock::now();
+  FBLAS_INT res = flash::trsm(mat_ord, side, uplo, trans_a, diag, m, n, alpha,
+                              mat_A, mat_B, lda_a, lda_b);
+  high_resolution_clock::time_point t2 = high_resolution_clock::now();
+  duration<double> span = duration_cast<duration<double>>(t2 - t1);
+  LOG_INFO(logger, "trsm() took ", span.count());
+
+  LOG_INFO(logger, "flash::trsm() returned with ", res);
+
+  LOG_DEBUG(logger, "un-map matrices");
+  flash::unmap_file(mat_A);
+  flash::unmap_file(mat_B);
+
+  LOG_DEBUG(logger, "destroying flash context");
+  flash::flash_destroy();
+}
@@ -4,10 +4,13 @@
 #pragma once
 
 #include <parallel/algorithm>
+#include <random>
 #include "bof_types.h"
+#include "mkl_traits.h"
 #include "tasks/task.h"
 
 namespace flash {
+  template<typename T>
   struct SparseBlock {
     // Offsets (Row/Col)
     MKL_INT *offs = nullptr;
@@ -17,8 +20,8 @@ namespace flash {
     MKL_INT *          idxs_ptr = nullptr;
 
     // Non-zero vals (on flash)
-    flash_ptr<FPTYPE> vals_fptr;
-    FPTYPE *          vals_ptr = nullptr;
+    flash_ptr<T> vals_fptr;
+    T *          vals_ptr = nullptr;
 
     // BLOCK DESCRIPTORS
     // Block start (Row/Col)
@@ -54,10 +57,11 @@ namespace flash {
 
   // Given a <flash_ptr, in_mem_ptr> mapping, obtain indices
   // and values pointers for given SparseBlock
+  template<typename T>
   inline void fill_sparse_block_ptrs(
       std::unordered_map<flash::flash_ptr<void>, void *, flash::FlashPtrHasher,
                          flash::FlashPtrEq> &in_mem_ptrs,
-      SparseBlock &                          blk) {
+      SparseBlock<T> &                       blk) {
     if (in_mem_ptrs.find(blk.idxs_fptr) == in_mem_ptrs.end()) {
       GLOG_FATAL("idxs fptr not found in in_mem_ptrs");
     }
@@ -96,9 +100,59 @@ namespace flash {
     }
   }
 
+  // access pattern of the `blk_rows x blk_cols` block at (`row`, `col`) of a
+  // row-major matrix; sets `offset` to the block's first element
+  template<typename T>
+  inline StrideInfo block_sinfo(FBLAS_UINT row, FBLAS_UINT col,
+                                FBLAS_UINT blk_rows, FBLAS_UINT blk_cols,
+                                FBLAS_UINT lda, FBLAS_UINT &offset) {
+    StrideInfo sinfo;
+    sinfo.n_strides = blk_rows;
+    sinfo.len_per_stride = blk_cols * sizeof(T);
+    sinfo.stride = lda * sizeof(T);
+    offset = row * lda + col;
+    return sinfo;
+  }
+
+  // fill `x` with standard normal samples drawn from `gen`
+  template<typename T>
+  inline void fill_gaussian(T *x, FBLAS_UINT len, std::mt19937_64 &gen) {
+    std::normal_distribution<T> dist(0.0, 1.0);
+    for (FBLAS_UINT i = 0; i < len; i++) {
+      x[i] = dist(gen);
+    }
+  }
+
+  // orthonormalize the columns of column-major `n_rows x n_cols` x, in place;
+  // if `r` is not null, also writes the column-major `n_cols x n_cols` R
+  template<typename T>
+  inline void orthonormalize(T *x, FBLAS_UINT n_rows, FBLAS_UINT n_cols,
+                             T *r = nullptr) {
+    T *     tau = new T[n_cols];
+    MKL_INT ret =
+        MklTraits<T>::geqrf(LAPACK_COL_MAJOR, n_rows, n_cols, x, n_rows, tau);
+    if (ret != 0) {
+      GLOG_FATAL("geqrf failed with ret=", ret);
+    }
+    if (r != nullptr) {
+      for (FBLAS_UINT j = 0; j < n_cols; j++) {
+        for (FBLAS_UINT i = 0; i < n_cols; i++) {
+          r[j * n_cols + i] = (i <= j ? x[j * n_rows + i] : 0);
+        }
+      }
+    }
+    ret = MklTraits<T>::orgqr(LAPACK_COL_MAJOR, n_rows, n_cols, n_cols, x,
+                              n_rows, tau);
+    if (ret != 0) {
+      GLOG_FATAL("orgqr failed with ret=", ret);
+    }
+    delete[] tau;
+  }
+
   // to be run in DEBUG mode only
-  inline void verify_csr_block(const SparseBlock &blk,
-                               bool               one_based_indexing) {
+  template<typename T>
+  inline void verify_csr_block(const SparseBlock<T> &blk,
+                               bool                  one_based_indexing) {
     GLOG_ASSERT_LE(blk.blk_size, blk.nrows);
     GLOG_ASSERT_LE(blk.start, blk.nrows);
     GLOG_ASSERT_LE(blk.start + blk.blk_size, blk.nrows);
@@ -7,7 +7,8 @@
 #include <cstdint>
 #include "mkl.h"
 
-// By deault, compile Single Precision kernels
+// By deault, drivers & utilities use Single Precision; BLAS routines and
+// tasks are templated on the value type & instantiated for both precisions
 #define FP_SINGLE_PRECISION
 
 // USE 64-bit INT and UINT values by default
@@ -18,25 +19,50 @@ typedef char     CHAR;
 #ifdef FP_SINGLE_PRECISION
 typedef float  FPTYPE;
 typedef double LONGFPTYPE;
-#define mkl_gemm cblas_sgemm
-#define mkl_gemv cblas_sgemv
-#define mkl_axpy cblas_saxpy
-#define mkl_csrmm mkl_scsrmm
-#define mkl_csrcsc mkl_scsrcsc
-#define mkl_csrgemv mkl_cspblas_scsrgemv
-#define mkl_dot cblas_sdot
-#define mkl_imin cblas_isamin
 #define FPTYPE_MAX FLT_MAX
 #else
 typedef double      FPTYPE;
 typedef long double LONGFPTYPE;
-#define mkl_gemm cblas_dgemm
-#define mkl_gemv cblas_dgemv
-#define mkl_axpy cblas_daxpy
-#define mkl_csrmm mkl_dcsrmm
-#define mkl_csrcsc mkl_dcsrcsc
-#define mkl_csrgemv mkl_cspblas_dcsrgemv
-#define mkl_dot cblas_ddot
-#define mkl_imin cblas_idamin
 #define FPTYPE_MAX DBL_MAX
 #endif  // FP_SINGLE_PRECISION
+
+namespace flash {
+  template<typename T>
+  struct NonDeduced {
+    typedef T type;
+  };
+
+  // scalar parameter of a routine templated on `T`, never used to deduce
+  // `T`; so `1.0` binds to a `float` routine, & so does a null output array
+  template<typename T>
+  using scalar_t = typename NonDeduced<T>::type;
+
+  // 16-bit storage formats for operands on flash; never computed on, tasks
+  // widen them to `float` once read (see `half_utils.h`)
+  // * fp16_t : IEEE-754 binary16
+  // * bf16_t : bfloat16, the upper half of a `float`
+  struct fp16_t {
+    uint16_t bits;
+  };
+  struct bf16_t {
+    uint16_t bits;
+  };
+
+  template<typename T>
+  struct ComputeType {
+    typedef T type;
+  };
+  template<>
+  struct ComputeType<fp16_t> {
+    typedef float type;
+  };
+  template<>
+  struct ComputeType<bf16_t> {
+    typedef float type;
+  };
+
+  // value type that operands stored as `T` are computed in; like
+  // `scalar_t`, never used to deduce `T`
+  template<typename T>
+  using compute_t = typename ComputeType<T>::type;
+}  // namespace flash
@@ -4,6 +4,8 @@
 #pragma once
 #include <functional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "bof_logger.h"
 #include "bof_types.h"
@@ -33,6 +35,10 @@ namespace flash {
     }
   };
 
+  // gather list for vectored writes
+  // <buf, len> pairs, concatenated in order to form one logical buffer
+  typedef std::vector<std::pair<void *, FBLAS_UINT>> GatherList;
+
   extern std::function<void(void)> dummy_std_func;
 
   // File op interface
@@ -70,5 +76,12 @@ namespace flash {
         FBLAS_UINT self_offset, BaseFileHandle &dest, FBLAS_UINT dest_offset,
         StrideInfo                       sinfo,
         const std::function<void(void)> &callback = dummy_std_func) = 0;
+
+    // Gather write ops
+    // writes the concatenation of `gbufs` with access pattern `sinfo`
+    // NOTE :: sum of lens in `gbufs` == sinfo.n_strides * sinfo.len_per_stride
+    virtual FBLAS_INT gwrite(
+        FBLAS_UINT offset, StrideInfo sinfo, const GatherList &gbufs,
+        const std::function<void(void)> &callback = dummy_std_func) = 0;
   };
 }  // namespace flash
@@ -17,6 +17,11 @@
 #include "bof_utils.h"
 #include "file_handles/file_handle.h"
 
+// default max chunk size to fetch/put from/to disk in one request
+// NOTE : Some devices might have higher throughput with more requests of
+// smaller sizes (IOPS heavy); see `FlashFileHandle::chunk_size`
+#define DEFAULT_CHUNK_SIZE ((FBLAS_UINT) 1 << 25)
+
 namespace flash {
   class FlashFileHandle : public BaseFileHandle {
     // file descriptor
@@ -36,6 +41,11 @@ namespace flash {
     FBLAS_UINT file_sz;
     int        file_desc;
 
+    // max chunk size to fetch/put from/to disk in one request, shared by all
+    // handles; a multiple of SECTOR_LEN
+    // DEFAULT: `DEFAULT_CHUNK_SIZE`, adjusted at runtime by `IoController`
+    static std::atomic<FBLAS_UINT> chunk_size;
+
     FlashFileHandle();
     ~FlashFileHandle();
 
@@ -73,5 +83,10 @@ namespace flash {
     FBLAS_INT scopy(FBLAS_UINT self_offset, BaseFileHandle &dest,
                     FBLAS_UINT dest_offset, StrideInfo sinfo,
                     const std::function<void(void)> &callback = dummy_std_func);
+
+    // Gather write ops
+    FBLAS_INT gwrite(
+        FBLAS_UINT offset, StrideInfo sinfo, const GatherList &gbufs,
+        const std::function<void(void)> &callback = dummy_std_func);
   };
 }  // namespace flash
@@ -44,5 +44,10 @@ namespace flash {
     FBLAS_INT scopy(FBLAS_UINT self_offset, BaseFileHandle &dest,
                     FBLAS_UINT dest_offset, StrideInfo sinfo,
                     const std::function<void(void)> &callback = dummy_std_func);
+
+    // Gather write ops
+    FBLAS_INT gwrite(
+        FBLAS_UINT offset, StrideInfo sinfo, const GatherList &gbufs,
+        const std::function<void(void)> &callback = dummy_std_func);
   };
 }  // namespace flash
\ No newline at end of file
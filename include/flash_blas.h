@@ -9,52 +9,145 @@
 #include "pointers/pointer.h"
 
 namespace flash {
+  // BLAS routines are templated on the value type `T`, & instantiated for
+  // `float` and `double`; gemm, gemv, csrmm, csrgemv & csrcsc also take
+  // `fp16_t` or `bf16_t` operands on flash, computing in `compute_t<T>`
+  // (`float`) with in-memory operands & scalars of that type
 
   // C = alpha*A*B + beta*C
+  // * C is stored as `U`, either `T` or `compute_t<T>`
+  template<typename T, typename U>
   FBLAS_INT gemm(CHAR mat_ord, CHAR trans_a, CHAR trans_b, FBLAS_UINT m,
-                 FBLAS_UINT n, FBLAS_UINT k, FPTYPE alpha, FPTYPE beta,
-                 flash_ptr<FPTYPE> a, flash_ptr<FPTYPE> b, flash_ptr<FPTYPE> c,
-                 FBLAS_UINT lda_a = 0, FBLAS_UINT lda_b = 0,
+                 FBLAS_UINT n, FBLAS_UINT k, compute_t<T> alpha,
+                 compute_t<T> beta, flash_ptr<T> a, flash_ptr<T> b,
+                 flash_ptr<U> c, FBLAS_UINT lda_a = 0, FBLAS_UINT lda_b = 0,
                  FBLAS_UINT lda_c = 0);
 
+  // - C = alpha*A*A^T + beta*C, if trans='N'
+  // - C = alpha*A^T*A + beta*C, if trans='T'
+  // * C : n x n, only its `uplo` ('L'|'U') triangle is referenced & updated
+  // * if `mirror`, the other triangle is overwritten with the transpose
+  template<typename T>
+  FBLAS_INT syrk(CHAR mat_ord, CHAR uplo, CHAR trans, FBLAS_UINT n,
+                 FBLAS_UINT k, scalar_t<T> alpha, scalar_t<T> beta,
+                 flash_ptr<T> a, flash_ptr<T> c, FBLAS_UINT lda_a = 0,
+                 FBLAS_UINT lda_c = 0, bool mirror = false);
+
+  // Cholesky factorization A = L*L^T (uplo='L') or A = U^T*U (uplo='U')
+  // * A : n x n, symmetric positive definite, only its `uplo` triangle is
+  //   referenced & overwritten with the factor
+  // * returns `0` on success, or the 1-based row where A was found not
+  //   positive definite
+  template<typename T>
+  FBLAS_INT potrf(CHAR mat_ord, CHAR uplo, FBLAS_UINT n, flash_ptr<T> a,
+                  FBLAS_UINT lda_a = 0);
+
+  // - B = alpha*op(A)^-1*B, if side='L'
+  // - B = alpha*B*op(A)^-1, if side='R'
+  // * A : triangular ('L'|'U'), unit diagonal if diag='U'
+  // * B : m x n, overwritten with the solution
+  template<typename T>
+  FBLAS_INT trsm(CHAR mat_ord, CHAR side, CHAR uplo, CHAR trans_a, CHAR diag,
+                 FBLAS_UINT m, FBLAS_UINT n, scalar_t<T> alpha, flash_ptr<T> a,
+                 flash_ptr<T> b, FBLAS_UINT lda_a = 0, FBLAS_UINT lda_b = 0);
+
+  // Tall-skinny QR factorization A = Q*R, streaming A by row panels
+  // * A : m x n, m >= n; read once
+  // * R : n x n, in memory, upper triangular
+  // * Q : m x n with orthonormal columns, written only if `q` is not null;
+  //   may be `a` to factor in place
+  template<typename T>
+  FBLAS_INT tsqr(CHAR mat_ord, FBLAS_UINT m, FBLAS_UINT n, flash_ptr<T> a, T* r,
+                 flash_ptr<T> q = flash_ptr<T>(), FBLAS_UINT lda_a = 0,
+                 FBLAS_UINT lda_q = 0);
+
+  template<typename T>
   FBLAS_INT kmeans(CHAR mat_ord, CHAR trans_a, CHAR trans_b, FBLAS_UINT m,
-                   FBLAS_UINT n, FBLAS_UINT k, FPTYPE alpha, FPTYPE beta,
-                   flash_ptr<FPTYPE> a, flash_ptr<FPTYPE> b,
-                   flash_ptr<FPTYPE> c, FBLAS_UINT lda_a, FBLAS_UINT lda_b,
-                   FBLAS_UINT lda_c, FPTYPE* c_l2sq, FPTYPE* p_l2sq,
-                   FPTYPE* ones);
+                   FBLAS_UINT n, FBLAS_UINT k, scalar_t<T> alpha,
+                   scalar_t<T> beta, flash_ptr<T> a, flash_ptr<T> b,
+                   flash_ptr<T> c, FBLAS_UINT lda_a, FBLAS_UINT lda_b,
+                   FBLAS_UINT lda_c, T* c_l2sq, T* p_l2sq, T* ones);
 
-  // y = alpha*A*x + beta*y
+  // - y = alpha*A*x + beta*y
+  // - y = alpha*A^T*x + beta*y
+  // * A : m x n, is dense [RM|CM], read once for all `n_rhs` right-hand sides
+  // * x, y : `n_rhs` vectors stored one after another
+  template<typename T>
   FBLAS_INT gemv(CHAR mat_ord, CHAR trans_a, FBLAS_UINT m, FBLAS_UINT n,
-                 FPTYPE alpha, FPTYPE beta, flash_ptr<FPTYPE> a,
-                 flash_ptr<FPTYPE> x, flash_ptr<FPTYPE> y);
+                 compute_t<T> alpha, compute_t<T> beta, flash_ptr<T> a,
+                 flash_ptr<compute_t<T>> x, flash_ptr<compute_t<T>> y,
+                 FBLAS_UINT n_rhs = 1, FBLAS_UINT lda_a = 0);
+
+  // in-memory variant with `x` and `y` in memory
+  template<typename T>
+  FBLAS_INT gemv(CHAR mat_ord, CHAR trans_a, FBLAS_UINT m, FBLAS_UINT n,
+                 compute_t<T> alpha, compute_t<T> beta, flash_ptr<T> a,
+                 compute_t<T>* x, compute_t<T>* y, FBLAS_UINT n_rhs = 1,
+                 FBLAS_UINT lda_a = 0);
 
   // - C = alpha*A*B + beta*C
   // - C = alpha*A^T*B + beta*C
   // * A : m x n, is in CSR format
   // * B : n x k, is dense [RM|CM]
   // * C : m x k, is dense [RM|CM]
+  template<typename T>
   FBLAS_INT csrmm(CHAR trans_a, FBLAS_UINT m, FBLAS_UINT n, FBLAS_UINT k,
-                  FPTYPE alpha, FPTYPE beta, flash_ptr<FPTYPE> a,
+                  compute_t<T> alpha, compute_t<T> beta, flash_ptr<T> a,
                   flash_ptr<MKL_INT> ia, flash_ptr<MKL_INT> ja, CHAR ord_b,
-                  flash_ptr<FPTYPE> b, flash_ptr<FPTYPE> c);
+                  flash_ptr<compute_t<T>> b, flash_ptr<compute_t<T>> c);
 
   // in-memory variant with `B` and `C` in memory
+  template<typename T>
   FBLAS_INT csrmm(CHAR trans_a, FBLAS_UINT m, FBLAS_UINT n, FBLAS_UINT k,
-                  FPTYPE alpha, FPTYPE beta, flash_ptr<FPTYPE> a,
+                  compute_t<T> alpha, compute_t<T> beta, flash_ptr<T> a,
                   flash_ptr<MKL_INT> ia, flash_ptr<MKL_INT> ja, CHAR ord_b,
-                  FPTYPE* b, FPTYPE* c);
+                  compute_t<T>* b, compute_t<T>* c);
 
   // A : CSR(ia, ja, a, m, n) -> A^T : CSR(ia_tr, ja_tr, a_tr, n, m)
+  template<typename T>
   FBLAS_INT csrcsc(FBLAS_UINT m, FBLAS_UINT n, flash_ptr<MKL_INT> ia,
-                   flash_ptr<MKL_INT> ja, flash_ptr<FPTYPE> a,
+                   flash_ptr<MKL_INT> ja, flash_ptr<T> a,
                    flash_ptr<MKL_INT> ia_tr, flash_ptr<MKL_INT> ja_tr,
-                   flash_ptr<FPTYPE> a_tr);
+                   flash_ptr<T> a_tr);
 
   // A : CSR(ia, ja, a, m, n)
-  FBLAS_INT csrgemv(CHAR trans_a, FBLAS_UINT m, FBLAS_UINT n,
-                    flash_ptr<FPTYPE> a, flash_ptr<MKL_INT> ia,
-                    flash_ptr<MKL_INT> ja, FPTYPE* b, FPTYPE* c);
+  template<typename T>
+  FBLAS_INT csrgemv(CHAR trans_a, FBLAS_UINT m, FBLAS_UINT n, flash_ptr<T> a,
+                    flash_ptr<MKL_INT> ia, flash_ptr<MKL_INT> ja,
+                    compute_t<T>* b, compute_t<T>* c);
+
+  // Randomized truncated SVD A ~= U*diag(S)*V^T of rank `k`
+  // * A : m x n, is dense [RM|CM]; streamed 2 + 2*`power_iters` times (once
+  //   more if centered), each pass for all `k + oversample` samples at once
+  // * S : k, U : m x k, V : n x k, in memory, column-major; `u` and `v` may
+  //   be null to skip them
+  // * if `mean` is not null, factors A - 1*mean^T (PCA) instead, and writes
+  //   the n column means of A to `mean`; A is never centered on flash
+  template<typename T>
+  FBLAS_INT rsvd(CHAR mat_ord, FBLAS_UINT m, FBLAS_UINT n, flash_ptr<T> a,
+                 FBLAS_UINT k, FBLAS_UINT oversample, FBLAS_UINT power_iters,
+                 T* s, scalar_t<T>* u, scalar_t<T>* v,
+                 scalar_t<T>* mean = nullptr, FBLAS_UINT lda_a = 0);
+
+  // CSR variant; A : CSR(ia, ja, a, m, n), transposed once to a temp file
+  template<typename T>
+  FBLAS_INT rsvd(FBLAS_UINT m, FBLAS_UINT n, flash_ptr<T> a,
+                 flash_ptr<MKL_INT> ia, flash_ptr<MKL_INT> ja, FBLAS_UINT k,
+                 FBLAS_UINT oversample, FBLAS_UINT power_iters, T* s,
+                 scalar_t<T>* u, scalar_t<T>* v, scalar_t<T>* mean = nullptr);
+
+  // Top-`k` eigenpairs (largest first) of a symmetric sparse matrix by block
+  // Lanczos with full reorthogonalization in memory
+  // * A : n x n, CSR(ia, ja, a), symmetric with both triangles stored
+  // * each step is one csrmm pass over A for a block of `blk_size` vectors;
+  //   at most `max_iters` steps, with `blk_size` <= CSRMM_CM_CBLK_SIZE to
+  //   stream A once per step
+  // * evals : k, evecs : n x k, in memory, column-major
+  // * returns the # of pairs whose residual is above `tol` * |A|
+  template<typename T>
+  FBLAS_INT lanczos(FBLAS_UINT n, flash_ptr<T> a, flash_ptr<MKL_INT> ia,
+                    flash_ptr<MKL_INT> ja, FBLAS_UINT k, FBLAS_UINT blk_size,
+                    FBLAS_UINT max_iters, scalar_t<T> tol, T* evals, T* evecs);
 
   // parallel external memory sort
   // implements Sample Sort
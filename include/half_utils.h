@@ -0,0 +1,178 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <cstring>
+#include <type_traits>
+#include "bof_types.h"
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
+
+namespace flash {
+  namespace half {
+    inline uint32_t as_bits(float f) {
+      uint32_t u;
+      memcpy(&u, &f, sizeof(u));
+      return u;
+    }
+
+    inline float as_float(uint32_t u) {
+      float f;
+      memcpy(&f, &u, sizeof(f));
+      return f;
+    }
+
+    // binary16 -> binary32, exact
+    inline float fp16_to_float(uint16_t h) {
+      const uint32_t exp_mask = 0x7c00 << 13;
+      uint32_t       o = (h & 0x7fff) << 13;
+      uint32_t       exp = o & exp_mask;
+      o += (127 - 15) << 23;
+      if (exp == exp_mask) {
+        // Inf/NaN
+        o += (128 - 16) << 23;
+      } else if (exp == 0) {
+        // zero/subnormal; renormalize
+        o = as_bits(as_float(o + (1 << 23)) - as_float(113 << 23));
+      }
+      return as_float(o | ((uint32_t)(h & 0x8000) << 16));
+    }
+
+    // binary32 -> binary16, round to nearest even; overflows to Inf
+    inline uint16_t float_to_fp16(float f) {
+      const uint32_t denorm_magic = ((127 - 15) + (23 - 10) + 1) << 23;
+      uint32_t       u = as_bits(f);
+      uint32_t       sign = u & 0x80000000u;
+      uint16_t       o;
+      u ^= sign;
+      if (u >= (uint32_t)(127 + 16) << 23) {
+        // Inf, or a quiet NaN
+        o = (u > (uint32_t) 255 << 23 ? 0x7e00 : 0x7c00);
+      } else if (u < (uint32_t) 113 << 23) {
+        // subnormal/zero; the FPU rounds while aligning to `denorm_magic`
+        o = as_bits(as_float(u) + as_float(denorm_magic)) - denorm_magic;
+      } else {
+        uint32_t mant_odd = (u >> 13) & 1;
+        u += ((uint32_t)(15 - 127) << 23) + 0xfff + mant_odd;
+        o = u >> 13;
+      }
+      return o | (sign >> 16);
+    }
+
+    inline float bf16_to_float(uint16_t h) {
+      return as_float((uint32_t) h << 16);
+    }
+
+    // round to nearest even; NaNs stay (quiet) NaNs
+    inline uint16_t float_to_bf16(float f) {
+      uint32_t u = as_bits(f);
+      if ((u & 0x7fffffffu) > 0x7f800000u) {
+        return (u >> 16) | 0x40;
+      }
+      return (u + 0x7fff + ((u >> 16) & 1)) >> 16;
+    }
+  }  // namespace half
+
+  // same type; only instantiated (never run) by `WideBuf`
+  template<typename T>
+  inline void widen(const T* in, T* out, FBLAS_UINT len) {
+    memcpy(out, in, len * sizeof(T));
+  }
+
+  template<typename T>
+  inline void narrow(const T* in, T* out, FBLAS_UINT len) {
+    memcpy(out, in, len * sizeof(T));
+  }
+
+  // `out[i] = in[i]`, 8 lanes at a time with F16C, else auto-vectorized
+  inline void widen(const fp16_t* in, float* out, FBLAS_UINT len) {
+    FBLAS_UINT i = 0;
+#ifdef __F16C__
+    for (; i + 8 <= len; i += 8) {
+      __m128i h = _mm_loadu_si128((const __m128i*) (in + i));
+      _mm256_storeu_ps(out + i, _mm256_cvtph_ps(h));
+    }
+#endif
+    for (; i < len; i++) {
+      out[i] = half::fp16_to_float(in[i].bits);
+    }
+  }
+
+  inline void narrow(const float* in, fp16_t* out, FBLAS_UINT len) {
+    FBLAS_UINT i = 0;
+#ifdef __F16C__
+    for (; i + 8 <= len; i += 8) {
+      __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(in + i),
+                                  _MM_FROUND_TO_NEAREST_INT);
+      _mm_storeu_si128((__m128i*) (out + i), h);
+    }
+#endif
+    for (; i < len; i++) {
+      out[i].bits = half::float_to_fp16(in[i]);
+    }
+  }
+
+  // plain shifts & adds; the compiler vectorizes these at any ISA level
+  inline void widen(const bf16_t* in, float* out, FBLAS_UINT len) {
+#pragma omp simd
+    for (FBLAS_UINT i = 0; i < len; i++) {
+      out[i] = half::bf16_to_float(in[i].bits);
+    }
+  }
+
+  inline void narrow(const float* in, bf16_t* out, FBLAS_UINT len) {
+#pragma omp simd
+    for (FBLAS_UINT i = 0; i < len; i++) {
+      out[i].bits = half::float_to_bf16(in[i]);
+    }
+  }
+
+  // `len` values of an in-memory buffer holding `S`s, viewed as `T`s
+  // * `S` == `T` : the buffer itself, no copies
+  // * otherwise  : a widened copy, freed on destruction; `fill=false` skips
+  //   widening a buffer that is only written
+  template<typename T, typename S>
+  class WideBuf {
+    T*         ptr;
+    FBLAS_UINT len;
+
+   public:
+    static constexpr bool is_view = std::is_same<T, S>::value;
+
+    WideBuf(void* buf, FBLAS_UINT len, bool fill = true) {
+      this->len = len;
+      if (is_view) {
+        this->ptr = (T*) buf;
+      } else {
+        this->ptr = new T[len];
+        if (fill) {
+          widen((const S*) buf, this->ptr, len);
+        }
+      }
+    }
+
+    ~WideBuf() {
+      if (!is_view) {
+        delete[] this->ptr;
+      }
+    }
+
+    T* get() {
+      return this->ptr;
+    }
+
+    // narrow results back into `buf` before it is written to flash
+    void store(void* buf) {
+      if (!is_view) {
+        narrow(this->ptr, (S*) buf, this->len);
+      }
+    }
+
+    // memory for the widened copy of `len` values, for `BaseTask::size()`
+    static FBLAS_UINT size(FBLAS_UINT len) {
+      return (is_view ? 0 : len * sizeof(T));
+    }
+  };
+}  // namespace flash
@@ -85,6 +85,19 @@ namespace flash {
   //                     flash::dummy_std_func);
   // }
 
+  // drops all cached buffers backed by the file of `fptr`
+  // dirty buffers are written back before this call returns
+  template<typename T>
+  void evict(flash_ptr<T> fptr) {
+    sched.evict(fptr.fop);
+  }
+
+  // snapshot of cache, I/O & scheduler counters since start-up
+  // cheap enough to poll while a call is in progress
+  inline Stats get_stats() {
+    return sched.get_stats();
+  }
+
   // truncates file backing `fptr` to `fptr.foffset + new_size` bytes
   template<typename T>
   void flash_truncate(flash_ptr<T> fptr, uint64_t new_size) {
@@ -121,6 +134,8 @@ namespace flash {
 
   template<typename T>
   void flash_free(flash_ptr<T> fptr) {
+    // release buffers retained by a persistent cache
+    evict(fptr);
     unmap_file<T>(fptr);
     std::string fname = ((FlashFileHandle *) fptr.fop)->get_filename();
     GLOG_DEBUG("removing ", fname);
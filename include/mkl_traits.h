@@ -0,0 +1,62 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <utility>
+#include "mkl.h"
+
+// forwards `MklTraits<T>::name(...)` to the MKL routine `fn`; inlined away,
+// so a templated kernel costs the same as calling `fn` directly
+#define MKL_TRAITS_FORWARD(name, fn)                                \
+  template<typename... Args>                                        \
+  static inline auto name(Args&&... args)                           \
+      ->decltype(fn(std::forward<Args>(args)...)) {                 \
+    return fn(std::forward<Args>(args)...);                         \
+  }
+
+namespace flash {
+  // MKL routines for value type `T`, selected at compile time
+  template<typename T>
+  struct MklTraits;
+
+  template<>
+  struct MklTraits<float> {
+    MKL_TRAITS_FORWARD(gemm, cblas_sgemm)
+    MKL_TRAITS_FORWARD(gemv, cblas_sgemv)
+    MKL_TRAITS_FORWARD(syrk, cblas_ssyrk)
+    MKL_TRAITS_FORWARD(trsm, cblas_strsm)
+    MKL_TRAITS_FORWARD(axpy, cblas_saxpy)
+    MKL_TRAITS_FORWARD(dot, cblas_sdot)
+    MKL_TRAITS_FORWARD(imin, cblas_isamin)
+    MKL_TRAITS_FORWARD(potrf, LAPACKE_spotrf)
+    MKL_TRAITS_FORWARD(geqrf, LAPACKE_sgeqrf)
+    MKL_TRAITS_FORWARD(orgqr, LAPACKE_sorgqr)
+    MKL_TRAITS_FORWARD(gesvd, LAPACKE_sgesvd)
+    MKL_TRAITS_FORWARD(syev, LAPACKE_ssyev)
+    MKL_TRAITS_FORWARD(csrmm, mkl_scsrmm)
+    MKL_TRAITS_FORWARD(csrcsc, mkl_scsrcsc)
+    MKL_TRAITS_FORWARD(csrgemv, mkl_cspblas_scsrgemv)
+  };
+
+  template<>
+  struct MklTraits<double> {
+    MKL_TRAITS_FORWARD(gemm, cblas_dgemm)
+    MKL_TRAITS_FORWARD(gemv, cblas_dgemv)
+    MKL_TRAITS_FORWARD(syrk, cblas_dsyrk)
+    MKL_TRAITS_FORWARD(trsm, cblas_dtrsm)
+    MKL_TRAITS_FORWARD(axpy, cblas_daxpy)
+    MKL_TRAITS_FORWARD(dot, cblas_ddot)
+    MKL_TRAITS_FORWARD(imin, cblas_idamin)
+    MKL_TRAITS_FORWARD(potrf, LAPACKE_dpotrf)
+    MKL_TRAITS_FORWARD(geqrf, LAPACKE_dgeqrf)
+    MKL_TRAITS_FORWARD(orgqr, LAPACKE_dorgqr)
+    MKL_TRAITS_FORWARD(gesvd, LAPACKE_dgesvd)
+    MKL_TRAITS_FORWARD(syev, LAPACKE_dsyev)
+    MKL_TRAITS_FORWARD(csrmm, mkl_dcsrmm)
+    MKL_TRAITS_FORWARD(csrcsc, mkl_dcsrcsc)
+    MKL_TRAITS_FORWARD(csrgemv, mkl_cspblas_dcsrgemv)
+  };
+}  // namespace flash
+
+#undef MKL_TRAITS_FORWARD
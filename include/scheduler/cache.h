@@ -1,6 +1,9 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT license.
 
+#include <chrono>
+#include <list>
+#include <map>
 #include "../bof_types.h"
 #include "../bof_utils.h"
 #include "../pointers/pointer.h"
@@ -48,9 +51,42 @@ namespace flash {
     bool       write_back = false;
 
     /* used by other functions */
-    bool               evicted = false;     // used for eviction
-    bool               alloc_only = false;  // used when buf init
-    std::atomic<bool> *complete = nullptr;  // used for I/O tracking
+    bool evicted = false;     // used for eviction
+    bool alloc_only = false;  // used when buf init
+    bool cleaning = false;    // used for background write-back
+    bool prefetch = false;    // used for read priority
+    bool pinned = false;      // see `BaseTask::add_pin()`
+
+    // NUMA node `buf` is placed on, see `Cache::numa`
+    FBLAS_UINT node = 0;
+
+    // used for I/O tracking; set in place by the I/O callback of an `io_map`
+    // entry
+    std::atomic<bool> complete{false};
+
+    // next entry in the same coalesced write-back
+    std::pair<const Key, Value> *next_in_run = nullptr;
+
+    Value() = default;
+
+    Value(const Value &other) {
+      *this = other;
+    }
+
+    Value &operator=(const Value &other) {
+      this->buf = other.buf;
+      this->n_refs = other.n_refs;
+      this->write_back = other.write_back;
+      this->evicted = other.evicted;
+      this->alloc_only = other.alloc_only;
+      this->cleaning = other.cleaning;
+      this->prefetch = other.prefetch;
+      this->pinned = other.pinned;
+      this->node = other.node;
+      this->complete.store(other.complete.load());
+      this->next_in_run = other.next_in_run;
+      return *this;
+    }
   };
 }  // namespace flash
 
@@ -70,6 +106,188 @@ namespace std {
 }  // namespace std
 
 namespace flash {
+  // read count, volume & latency of one cache tier
+  struct TierStats {
+    std::atomic<FBLAS_UINT> n_reads, n_bytes, total_us;
+
+    TierStats() : n_reads(0), n_bytes(0), total_us(0) {
+    }
+
+    // records a read of `bytes` bytes issued at `start`
+    void record(FBLAS_UINT bytes,
+                std::chrono::steady_clock::time_point start) {
+      auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+      this->n_reads++;
+      this->n_bytes += bytes;
+      this->total_us += (FBLAS_UINT) us;
+    }
+
+    operator std::string() const {
+      FBLAS_UINT n = this->n_reads.load();
+      return "n_reads=" + std::to_string(n) +
+             ", MB=" + std::to_string(this->n_bytes.load() >> 20) +
+             ", avg_latency=" +
+             std::to_string(n ? this->total_us.load() / n : 0) + "us";
+    }
+  };
+
+  // second cache tier holding clean buffers evicted from `Cache` in
+  // compressed form; entries are exclusive - a hit moves the buffer back out
+  // NOTE :: all calls are thread-safe
+  class CompressedTier {
+   public:
+    // compressed copy of one buffer
+    struct Blob {
+      char *     data = nullptr;
+      FBLAS_UINT comp_size = 0;
+      FBLAS_UINT raw_size = 0;
+    };
+
+   private:
+    struct Entry : Blob {
+      std::list<Key>::iterator lru_it;
+    };
+
+    std::unordered_map<Key, Entry> entries;
+    // front = most recently inserted
+    std::list<Key> lru;
+    // compressed bytes held
+    FBLAS_UINT size;
+
+    typedef std::unique_lock<std::mutex> mutex_locker;
+    std::mutex                           mut;
+
+    // removes `it` from tier and frees its data
+    void remove(std::unordered_map<Key, Entry>::iterator it);
+
+   public:
+    // max # of compressed bytes held; `0` disables the tier
+    // Default : `0`
+    FBLAS_UINT max_size;
+
+    // buffers compressing to more than `max_ratio * raw size` are dropped
+    // Default : `0.75`
+    float max_ratio;
+
+    // stats
+    std::atomic<FBLAS_UINT> n_hits, n_inserts, n_rejects;
+    TierStats               stats;
+
+    CompressedTier();
+
+    ~CompressedTier();
+
+    inline bool enabled() const {
+      return this->max_size > 0;
+    }
+
+    // compresses `len` bytes of `buf` and adds it to tier as `k`
+    // evicts LRU entries to stay within `max_size`
+    // returns `false` if `k` was not added
+    // NOTE :: CPU-heavy; `Cache` calls it on an IO thread
+    bool put(const Key &k, const void *buf, FBLAS_UINT len);
+
+    // removes `k` from tier into `blob`, to be passed to `restore()`
+    // returns `false` if `k` is not in tier
+    bool take(const Key &k, Blob &blob);
+
+    // decompresses `blob` into `buf` & frees `blob.data`
+    // NOTE :: CPU-heavy; `Cache` calls it on an IO thread
+    void restore(Blob &blob, void *buf);
+
+    // drops `k` if in tier
+    void erase(const Key &k);
+
+    // drops all entries for which `pred(k) == true`
+    void erase_if(std::function<bool(const Key &)> pred);
+
+    // drops all entries
+    void clear();
+  };
+
+  // second cache tier holding clean buffers evicted from `Cache` in a file on
+  // a (faster) local device; entries are exclusive like `CompressedTier`
+  // NOTE :: all calls are thread-safe
+  class FlashTier {
+    struct Entry {
+      FBLAS_UINT               offset = 0;
+      FBLAS_UINT               len = 0;
+      bool                     busy = false;  // write in progress
+      std::list<Key>::iterator lru_it;
+    };
+
+    std::unordered_map<Key, Entry> entries;
+    // front = most recently inserted
+    std::list<Key> lru;
+    // free extents in backing file, <offset, len>, coalesced
+    std::map<FBLAS_UINT, FBLAS_UINT> free_map;
+
+    // backing file
+    BaseFileHandle *fop;
+    std::string     fname;
+
+    typedef std::unique_lock<std::mutex> mutex_locker;
+    std::mutex                           mut;
+
+    // first-fit allocation of `len` bytes from `free_map`
+    bool alloc_extent(FBLAS_UINT len, FBLAS_UINT &offset);
+    // returns `[offset, offset + len)` to `free_map`
+    void free_extent(FBLAS_UINT offset, FBLAS_UINT len);
+
+    // removes `it` from tier; space of busy entries is freed by `commit()`
+    void remove(std::unordered_map<Key, Entry>::iterator it);
+
+    // closes & deletes backing file
+    void teardown();
+
+   public:
+    // size of backing file
+    FBLAS_UINT max_size;
+
+    // stats
+    TierStats stats;
+
+    FlashTier();
+
+    ~FlashTier();
+
+    inline bool enabled() const {
+      return this->fop != nullptr;
+    }
+
+    // creates a `size`-byte backing file in `dir`; `size == 0` disables
+    // drops all entries; no tier I/O may be in progress
+    void setup(const std::string &dir, FBLAS_UINT size);
+
+    // reserves `len` bytes for `k`, evicting LRU entries as needed
+    // returns `false` if `k` can't be accommodated
+    // else, `fptr` points to the reserved space; caller must write `len`
+    // bytes to it and then call `commit(k, fptr, len)`
+    bool reserve(const Key &k, FBLAS_UINT len, flash_ptr<void> &fptr);
+
+    // marks write of `k` to `fptr` complete
+    void commit(const Key &k, flash_ptr<void> fptr, FBLAS_UINT len);
+
+    // removes `k` from tier; returns `false` if `k` is not in tier
+    // else, `fptr` points to the data of `k`; caller must read it and then
+    // call `release(fptr, len)`
+    bool take(const Key &k, flash_ptr<void> &fptr);
+
+    // returns space taken by `take()` to the tier
+    void release(flash_ptr<void> fptr, FBLAS_UINT len);
+
+    // drops `k` if in tier
+    void erase(const Key &k);
+
+    // drops all entries for which `pred(k) == true`
+    void erase_if(std::function<bool(const Key &)> pred);
+
+    // drops all entries
+    void clear();
+  };
+
   class Cache {
     // <key-buffer> maps
     // Value.n_refs >= 0,  no I/O in progress, in-use|promised
@@ -91,6 +309,33 @@ namespace flash {
     // Default : `false`
     bool single_use_discard;
 
+    // max # of bytes in one coalesced write-back; `0` disables coalescing
+    // Default : `1 << 26` (64MB)
+    FBLAS_UINT coalesce_window;
+
+    // If `true`, `Scheduler::flush_cache()` only writes back dirty buffers and
+    // retains up to `retain_size` bytes of clean buffers for later calls
+    // Default : `false`, `max_size / 2`
+    bool       persistent;
+    FBLAS_UINT retain_size;
+
+    // background write-back of zero-ref dirty buffers
+    // * if I/O is idle, writes back atmost `flush_batch` bytes per call
+    // * if dirty footprint exceeds `dirty_high_ratio * max_size`, writes back
+    //   until it drops below `dirty_low_ratio * max_size`
+    // Default : disabled, 0.5, 0.25, `1 << 28` (256MB)
+    bool       background_flush;
+    float      dirty_high_ratio;
+    float      dirty_low_ratio;
+    FBLAS_UINT flush_batch;
+
+    // If `true`, a task's new buffers are placed on the NUMA node holding
+    // most of its cached buffers (round-robin if none), recorded as
+    // `BaseTask::numa_node`
+    // Default : `false`
+    bool       numa;
+    FBLAS_UINT next_node;
+
     // access serialization for cache primitives
     typedef std::unique_lock<std::mutex> mutex_locker;
     std::mutex                           cache_mut;
@@ -107,6 +352,18 @@ namespace flash {
     // IO executor
     IoExecutor &io_exec;
 
+    // victim tiers for evicted clean buffers, tried in order
+    CompressedTier ctier;
+    FlashTier      ftier;
+
+    // reads from primary files
+    TierStats disk_stats;
+
+    // buffers asked for by tasks found in | missing from cache, buffers
+    // evicted & written back, peak `real_size` & `commit_size`
+    std::atomic<FBLAS_UINT> n_hits, n_misses, n_evictions, n_write_backs;
+    std::atomic<FBLAS_UINT> peak_real_size, peak_commit_size;
+
     /*  helper functions  */
     inline bool is_active(const Key &key) const {
       return this->active_map.find(key) != this->active_map.end();
@@ -141,23 +398,65 @@ namespace flash {
 
     // evicts `evict_keys` from `zero_ref_map`
     // issues writes if `zero_ref_map[k].write_back == true`
-    void evict(const std::unordered_set<Key> &evict_keys);
+    // write-backs adjacent on disk are coalesced (see `coalesce_window`)
+    // read-only bufs are offered to `ctier`, then `ftier` if `keep_victims`
+    void evict(const std::unordered_set<Key> &evict_keys,
+               bool                           keep_victims = true);
+
+    // offers evicted R-only `entry` of `len` bytes to `ctier`, then `ftier`;
+    // frees its buf once kept | rejected & marks it complete
+    // NOTE :: runs on an IO thread, without `cache_mut`
+    void keep_victim(std::pair<const Key, Value> *entry, FBLAS_UINT len);
+
+    // writes evicted R-only `entry` of `len` bytes to `ftier` at
+    // `tier_fptr`; frees its buf once written & marks it complete
+    void spill(std::pair<const Key, Value> *entry, FBLAS_UINT len,
+               flash_ptr<void> tier_fptr);
+
+    // splits `keys` into runs adjacent on disk and issues `write_back` for
+    // each run; all keys must be in `io_map`
+    void issue_write_backs(std::vector<Key> &keys, bool evict);
+
+    // issues one (gather) write for `run`; all keys must be in `io_map`
+    // and adjacent on disk, in increasing order of file offset
+    // if `evict`, bufs are freed once written, else they stay cached as clean
+    void write_back(const std::vector<Key> &run, bool evict);
+
+    // logs read latency of each enabled tier
+    void log_tier_stats();
+
+    // returns `true` if `next` continues `run` on disk
+    bool is_adjacent(const std::vector<Key> &run, const Key &next) const;
 
     // reduce `commit_size` by at least `evict_size`, but don't drop
-    // `exclude_keys`
+    // `exclude_keys`; pinned bufs are dropped only if others don't suffice
     // returns `true` if successful, `false` otherwise
     // if returns `true`, function also issues eviction orders
     // if returns `false`, no eviction orders are issued
     bool try_evict(const std::unordered_set<Key> &exclude_keys,
                    const FBLAS_UINT               evict_size);
 
+    // returns the NUMA node holding most bytes of `keys` in cache, or the
+    // next node round-robin if none is cached
+    FBLAS_UINT pick_node(const std::unordered_set<Key> &keys);
+
     // adds `k` to a backlog
     // when `has_spare_mem_for(buf_size(k.sinfo)) == true`,
     //    `v.buf` is malloc'ed and reads issued (if required)
     //    * NOTE :: malloc'ing happens in `service_backlog`
-    void add_backlog(const Key &k, bool alloc_only, bool write_back);
-
-    // deletes `io_map[k].complete`
+    // reads are issued as `IoPriority::Prefetch` if `prefetch`; a queued
+    // prefetch is promoted if `k` is asked for again without `prefetch`
+    // `v.buf` is placed on NUMA node `node` if `numa`
+    void add_backlog(const Key &k, bool alloc_only, bool write_back,
+                     bool prefetch, FBLAS_UINT node);
+
+    // inserts `v` as `io_map[k]`, with `complete` set to `complete`
+    // returns the entry, which stays in place until erased from `io_map`;
+    // I/O callbacks refer to it instead of allocating a completion flag
+    std::pair<const Key, Value> *add_to_io(const Key &k, const Value &v,
+                                           bool complete);
+
+    // checks that I/O on `io_map[k]` is complete
     // calling function must explicitly move from `io_map` to `zero_ref_map` or
     // `active_map` (if `!io_map[k].evicted`)
     // calling function must explicitly remove from `io_map` if
@@ -172,13 +471,18 @@ namespace flash {
     void move_io_to_active(const Key &k);  // after I/O completion
 
     // `claims` buffers for `tsk` and issues I/O requests for bufs not in cache
-    void alloc_bufs(BaseTask *tsk);
+    void alloc_bufs(BaseTask *tsk, bool prefetch);
 
    public:
     Cache(IoExecutor &io_exec, const FBLAS_UINT max_size);
 
     ~Cache();
 
+    // max # of bytes cached
+    FBLAS_UINT capacity() const {
+      return this->max_size;
+    }
+
     // returns `non-nullptr` if the query is already cached
     // * if access in `active_map`, returns `buf`
     // * if access in `zero_ref_map`, moves to `active_map`, and returns `buf`
@@ -190,11 +494,13 @@ namespace flash {
 
     // returns `true` if buffers successfully alloc'ed
     // if returns `false`, cache-state may still be changed by trying to evict
-    bool allocate(BaseTask *tsk);
+    // `prefetch` : `true` if `tsk` is not expected to be computed soon
+    bool allocate(BaseTask *tsk, bool prefetch = false);
 
     // reduces reference count in `active_map`
     // moves a key `k` to `zero_ref_map` if `active_map[k].n_refs == 0` to
     // maintain invariance
+    // pins the keys in `tsk->pin_list`, unpins the others
     void release(const BaseTask *tsk);
 
     // cleans up `io_map` be reaping completed I/O requests
@@ -208,11 +514,30 @@ namespace flash {
     // WARNING : program exits FATALLY if entries are active
     void flush();
 
+    // flushes all write-back entries in cache
+    // retains atmost `retain_size` bytes of read-only entries; read-only
+    // entries overlapping a flushed entry are dropped
+    // WARNING : program exits FATALLY if entries are active
+    void flush_retain();
+
+    // drops all zero-ref entries backed by `fop`, writing back dirty ones
+    // returns after all write-backs to `fop` complete
+    void evict_file(const BaseFileHandle *fop);
+
+    // writes back zero-ref dirty buffers (except pinned ones) without
+    // evicting them
+    // buffers move back to `zero_ref_map` as clean once written
+    // `io_idle` : `true` if no I/O is queued or in progress
+    void flush_dirty(bool io_idle);
+
     // drops keys if in cache
     void drop_if_in_cache(std::unordered_set<Key> &keys);
     // keeps keys if in cache
     void keep_if_in_cache(std::unordered_set<Key> &keys);
 
+    // adds cache counters & sizes to `stats`
+    void fill_stats(Stats &stats);
+
     // Allow `Scheduler` to access private variables
     friend class Scheduler;
   };
@@ -0,0 +1,64 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "../bof_types.h"
+
+namespace flash {
+  // ids of logical cores
+  typedef std::vector<FBLAS_UINT> CoreSet;
+
+  // cores compute threads may run tasks on, handed out as disjoint sets so
+  // that MKL & OpenMP teams of concurrent tasks don't oversubscribe cores
+  // * a task gets `size() / n_expected` free cores, where `n_expected` is
+  //   the # of tasks expected to run concurrently
+  // * a task finding no free core shares the core with the fewest tasks
+  // NOTE :: all calls are thread-safe
+  class CoreBudget {
+    typedef std::unique_lock<std::mutex> mutex_locker;
+    std::mutex                           mut;
+
+    // cores in the budget & # of tasks holding each; guarded by `mut`
+    CoreSet                 cores;
+    std::vector<FBLAS_UINT> n_users;
+    FBLAS_UINT              n_free;
+
+    // cores the process may run on, at start-up
+    CoreSet all_cores;
+
+   public:
+    // `true` if tasks are given core sets; see `Scheduler::compute_thread_fn`
+    std::atomic<bool> enabled;
+    // `true` if the calling thread & its OpenMP team are pinned to the set
+    std::atomic<bool> pin;
+
+    CoreBudget();
+
+    // uses the first `n_cores` cores the process may run on; `0` => all
+    // NOTE :: change only when no task holds cores
+    void setup(FBLAS_UINT n_cores);
+
+    // # of cores in the budget
+    FBLAS_UINT size();
+
+    // hands out atmost `max_cores` free cores, & atmost a fair share for
+    // `n_expected` concurrent tasks; if none are free, shares the core held
+    // by the fewest tasks
+    // cores in `prefer` are handed out first
+    CoreSet acquire(FBLAS_UINT n_expected, FBLAS_UINT max_cores,
+                    const CoreSet &prefer = CoreSet());
+
+    // returns `cores` from `acquire()` to the budget
+    void release(const CoreSet &cores);
+
+    // pins the calling thread to `cores` & the i-th thread of its OpenMP
+    // team to `cores[i]`; if `!spread`, pins all of them to all of `cores`
+    // empty `cores` unpins
+    // no-op if the calling thread is already pinned so
+    void pin_threads(const CoreSet &cores, bool spread = true);
+  };
+}  // namespace flash
@@ -0,0 +1,108 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "../bof_types.h"
+#include "../bof_utils.h"
+
+namespace flash {
+  // `void(void)` callable stored inline in `IO_CALLBACK_SIZE` bytes
+  // unlike `std::function`, never allocates; a callable that doesn't fit
+  // fails to compile
+  // NOTE :: move-only
+#define IO_CALLBACK_SIZE 64
+  class IoCallback {
+    enum class Op { Move, Destroy };
+
+    typename std::aligned_storage<IO_CALLBACK_SIZE,
+                                  alignof(std::max_align_t)>::type storage;
+    void (*invoke_fn)(void *);
+    // moves (`Op::Move`) from `src` into `dst` | destroys (`Op::Destroy`) `dst`
+    void (*manage_fn)(Op, void *dst, void *src);
+
+    template<typename F>
+    static void invoke(void *fn) {
+      (*static_cast<F *>(fn))();
+    }
+
+    template<typename F>
+    static void manage(Op op, void *dst, void *src) {
+      if (op == Op::Move) {
+        new (dst) F(std::move(*static_cast<F *>(src)));
+        static_cast<F *>(src)->~F();
+      } else {
+        static_cast<F *>(dst)->~F();
+      }
+    }
+
+    void move_from(IoCallback &other) {
+      this->invoke_fn = other.invoke_fn;
+      this->manage_fn = other.manage_fn;
+      if (this->manage_fn != nullptr) {
+        this->manage_fn(Op::Move, &this->storage, &other.storage);
+      }
+      other.invoke_fn = nullptr;
+      other.manage_fn = nullptr;
+    }
+
+   public:
+    IoCallback() : invoke_fn(nullptr), manage_fn(nullptr) {
+    }
+
+    template<typename F,
+             typename = typename std::enable_if<!std::is_same<
+                 typename std::decay<F>::type, IoCallback>::value>::type>
+    IoCallback(F &&fn) {
+      typedef typename std::decay<F>::type Fn;
+      static_assert(sizeof(Fn) <= IO_CALLBACK_SIZE,
+                    "callback too large; capture pointers instead");
+      static_assert(alignof(Fn) <= alignof(std::max_align_t),
+                    "callback over-aligned");
+      new (&this->storage) Fn(std::forward<F>(fn));
+      this->invoke_fn = &IoCallback::invoke<Fn>;
+      this->manage_fn = &IoCallback::manage<Fn>;
+    }
+
+    IoCallback(IoCallback &&other) {
+      this->move_from(other);
+    }
+
+    IoCallback &operator=(IoCallback &&other) {
+      if (this != &other) {
+        this->reset();
+        this->move_from(other);
+      }
+      return *this;
+    }
+
+    IoCallback(const IoCallback &) = delete;
+    IoCallback &operator=(const IoCallback &) = delete;
+
+    ~IoCallback() {
+      this->reset();
+    }
+
+    // destroys held callable, if any
+    void reset() {
+      if (this->manage_fn != nullptr) {
+        this->manage_fn(Op::Destroy, &this->storage, nullptr);
+      }
+      this->invoke_fn = nullptr;
+      this->manage_fn = nullptr;
+    }
+
+    explicit operator bool() const {
+      return this->invoke_fn != nullptr;
+    }
+
+    void operator()() {
+      GLOG_ASSERT(this->invoke_fn != nullptr, "empty callback");
+      this->invoke_fn(&this->storage);
+    }
+  };
+}  // namespace flash
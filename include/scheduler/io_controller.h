@@ -0,0 +1,130 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include "../bof_types.h"
+
+// # of buckets in a `LatencyHistogram`
+#define N_LATENCY_BUCKETS 24
+
+namespace flash {
+  // log2-bucketed histogram of latencies in us
+  // bucket `0` counts latencies below 2us, bucket `i` counts latencies in
+  // `[2^i, 2^(i+1))` us, and the last bucket counts all longer latencies
+  class LatencyHistogram {
+    std::atomic<FBLAS_UINT> buckets[N_LATENCY_BUCKETS];
+
+   public:
+    LatencyHistogram();
+
+    void record(FBLAS_UINT us);
+
+    // copies bucket counts to `out[0 .. N_LATENCY_BUCKETS)`
+    void snapshot(FBLAS_UINT *out) const;
+  };
+
+  // snapshot of I/O concurrency settings & observed performance
+  struct IoStats {
+    FBLAS_UINT depth;       // max # of I/O tasks in execution
+    FBLAS_UINT max_depth;   // # of I/O threads
+    FBLAS_UINT chunk_size;  // max # of bytes in one disk request
+    FBLAS_UINT n_tasks;     // # of I/O tasks completed
+    FBLAS_UINT n_bytes;     // # of bytes read | written
+    float      throughput;  // MB/s over last window
+    float      latency;     // avg task latency (us per MB) over last window
+    bool       adaptive;    // `true` if `depth` & `chunk_size` are adjusted
+
+    operator std::string() const {
+      return std::string("depth=") + std::to_string(depth) + "/" +
+             std::to_string(max_depth) +
+             ", chunk_size=" + std::to_string(chunk_size) +
+             ", n_tasks=" + std::to_string(n_tasks) +
+             ", n_bytes=" + std::to_string(n_bytes) +
+             ", throughput=" + std::to_string(throughput) +
+             "MB/s, latency=" + std::to_string(latency) + "us/MB";
+    }
+  };
+
+  // AIMD controller over I/O depth, in the style of delay-based TCP
+  // congestion control
+  // * completions are grouped into windows of atleast `WINDOW_US` us
+  // * at the end of a window where I/O was backlogged, if latency per byte
+  //   exceeds `LAT_TOLERANCE` x the lowest seen, depth is cut by 1/4th;
+  //   otherwise depth grows by 1
+  // * chunk size is hill-climbed in powers of 2 in `[CHUNK_MIN, CHUNK_MAX]`
+  //   every `CHUNK_PERIOD` backlogged windows
+  class IoController {
+    static const FBLAS_UINT WINDOW_US = 100000;
+    static const FBLAS_UINT CHUNK_PERIOD = 4;
+    static const FBLAS_UINT CHUNK_MIN = ((FBLAS_UINT) 1 << 20);
+    static const FBLAS_UINT CHUNK_MAX = ((FBLAS_UINT) 1 << 26);
+    static constexpr float  LAT_TOLERANCE = 1.5f;
+    // lowest latency seen drifts up by this factor every window, so that a
+    // stale minimum (from a different access pattern) expires
+    static constexpr float LAT_DRIFT = 1.02f;
+
+    typedef std::unique_lock<std::mutex> mutex_locker;
+    std::mutex                           mut;
+
+    // current window; guarded by `mut`
+    std::chrono::steady_clock::time_point win_start;
+    FBLAS_UINT                            win_tasks;
+    FBLAS_UINT                            win_backlogged;
+    FBLAS_UINT                            win_bytes;
+    FBLAS_UINT                            win_us;
+
+    // controller state; guarded by `mut`
+    float      base_latency;
+    float      chunk_tput;  // throughput when chunk size was last changed
+    bool       chunk_up;    // direction of next chunk size change
+    FBLAS_UINT n_windows;
+
+    std::atomic<FBLAS_UINT> depth;
+    FBLAS_UINT              max_depth;
+    // cap on `depth` set from outside, see `set_limit()`
+    std::atomic<FBLAS_UINT> limit;
+    std::atomic<FBLAS_UINT> n_tasks;
+    std::atomic<FBLAS_UINT> n_bytes;
+    std::atomic<float>      last_tput;
+    std::atomic<float>      last_latency;
+
+    // adjusts depth & chunk size using the closed window
+    // NOTE :: `mut` must be held
+    void update(float tput, float latency, bool backlogged);
+
+    // starts a new window
+    // NOTE :: `mut` must be held
+    void reset_window();
+
+   public:
+    // if `false`, `depth` stays at `max_depth` & chunk size is not changed
+    std::atomic<bool> enabled;
+
+    IoController(FBLAS_UINT max_depth);
+
+    // records a completed task that moved `bytes` in `us` micro-seconds;
+    // `backlogged` is `true` if other tasks were waiting to execute
+    void record(FBLAS_UINT bytes, FBLAS_UINT us, bool backlogged);
+
+    // max # of I/O tasks to execute concurrently
+    FBLAS_UINT get_depth() const {
+      FBLAS_UINT d = (this->enabled.load() ? this->depth.load()
+                                           : this->max_depth);
+      return std::min(d, this->limit.load());
+    }
+
+    // caps depth at `limit` in `[1, max_depth]`; `0` removes the cap
+    void set_limit(FBLAS_UINT limit);
+
+    // turns adaptation on | off; turning off restores static settings
+    void set_enabled(bool enable);
+
+    IoStats get_stats() const;
+  };
+}  // namespace flash
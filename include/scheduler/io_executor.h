@@ -4,21 +4,41 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <thread>
 #include <vector>
 #include "../bof_queue.h"
 #include "../file_handles/file_handle.h"
 #include "../pointers/pointer.h"
+#include "io_callback.h"
+#include "io_controller.h"
+#include "range_lock.h"
 
 namespace flash {
+  // IO priority classes, highest first
+  enum class IoPriority {
+    Demand = 0,    // reads for tasks about to be computed
+    Prefetch = 1,  // reads for tasks further in the future
+    WriteBack = 2  // writes of evicted | cleaned buffers
+  };
+#define N_IO_PRIORITIES 3
+
+  struct Stats;
+
   // Wrapper struct for all work to be done by an IO thread
+  // NOTE :: nodes are pooled by `IoExecutor` & re-used; see `init()`
+  // NOTE :: `fptr.fop == nullptr` => no I/O, only `callback` (`add_work()`)
   struct IoTask {
     flash_ptr<void> fptr;   // fptr to R/W from
     StrideInfo      sinfo;  // access pattern
     void*           buf;    // buf for I/O
-    bool is_write;          // if `true`, indicates a write operation, else read
-    std::function<void(void)> callback;  // `fn` to call after I/O is done
+    bool       is_write;  // if `true`, indicates a write operation, else read
+    IoCallback callback;  // `fn` to call after I/O is done
+    GatherList gbufs;     // if non-empty, write is gathered from `gbufs`
+    IoPriority prio;      // queue to execute from
+    IoTask*    next;      // next node in `IoExecutor` free list
 
     // constructor to return null IoTask
     IoTask() {
@@ -27,12 +47,20 @@ namespace flash {
       sinfo = {0, 0, 0};
       buf = 0;
       is_write = false;
+      prio = IoPriority::Demand;
+      next = nullptr;
     }
 
     // one-shot initialization of all member variables
-    IoTask(flash_ptr<void> fptr, StrideInfo sinfo, void* buf, bool is_write,
-           std::function<void(void)> fn)
-        : fptr(fptr), sinfo(sinfo), buf(buf), is_write(is_write), callback(fn) {
+    // NOTE :: `gbufs` is left as is
+    void init(flash_ptr<void> fptr, StrideInfo sinfo, void* buf,
+              bool is_write, IoCallback&& fn, IoPriority prio) {
+      this->fptr = fptr;
+      this->sinfo = sinfo;
+      this->buf = buf;
+      this->is_write = is_write;
+      this->callback = std::move(fn);
+      this->prio = prio;
     }
 
     // for DEBUG purposes
@@ -42,66 +70,166 @@ namespace flash {
   };
 
   class IoExecutor {
+    // kinds of IO tasks an IO thread executes
+    enum class ThreadRole { Any, Read, Write };
+
     // List of all IO thread objects
     std::vector<std::thread> io_threads;
 
-    // Number of IO threads spawned
+    // Number of IO threads spawned : shared, read-only, write-only
     FBLAS_UINT n_threads;
+    FBLAS_UINT n_read_threads;
+    FBLAS_UINT n_write_threads;
 
-    // List of all IO tasks being executed by each thread
-    std::vector<IoTask*> thread_tsks;
-
-    // List of access specifiers to modify thread_tsks
-    typedef std::unique_lock<std::mutex> mutex_locker;
-    std::mutex*                          thread_muts;
-
-    // Indicator variables as to whether each task executed by an IO thread is a
-    // write/read
-    std::atomic<bool>* is_writes;
+    // Sector ranges of in-flight writes; a write sharing a sector with an
+    // in-flight write waits for it to finish
+    RangeLock write_locks;
 
-    // Control Variable - Checks for overlap between IO tasks if set
+    // Control Variable - Checks for overlap between write tasks if set
     // DEFAULT: `true`
     bool overlap_check;
 
-    // Task queue for IO threads
-    ConcurrentQueue<IoTask*> tsk_queue;
+    // Queued contiguous reads of the same file at most `merge_gap` bytes apart
+    // are merged into one read of atmost `merge_max` bytes; `0` disables
+    // DEFAULT: `1 << 16` (64KB), `1 << 24` (16MB)
+    FBLAS_UINT merge_gap;
+    FBLAS_UINT merge_max;
+
+    // Task queues for IO threads, one per `IoPriority`
+    // guarded by `queue_mut`
+    typedef std::unique_lock<std::mutex> mutex_locker;
+    std::deque<IoTask*>                  queues[N_IO_PRIORITIES];
+    // # of tasks of each priority in execution
+    FBLAS_UINT n_in_flight[N_IO_PRIORITIES];
+    // max # of tasks of each priority in execution
+    FBLAS_UINT max_in_flight[N_IO_PRIORITIES];
+    // # of tasks of all priorities in execution, atmost `ctl.get_depth()`
+    FBLAS_UINT              n_executing;
+    std::mutex              queue_mut;
+    std::condition_variable queue_cv;
 
     // Atomic boolean to signal shutdown of library
     std::atomic<bool> shutdown;
 
+    // # of IO tasks queued or in execution
+    std::atomic<FBLAS_UINT> n_pending;
+
+    // adjusts # of tasks in execution & disk request size to observed
+    // latency & throughput
+    IoController ctl;
+
+    // I/O tasks completed & bytes moved, by direction; merged reads count
+    // once per task, but once per disk request in `read_latency`
+    std::atomic<FBLAS_UINT> n_read_ops, n_read_bytes;
+    std::atomic<FBLAS_UINT> n_write_ops, n_write_bytes;
+    LatencyHistogram        read_latency, write_latency;
+
+    // Free IoTask nodes, linked through `IoTask::next`
+    // guarded by `queue_mut`
+    IoTask* free_tasks;
+
     // Thread function executed by each IO thread
-    void io_thread_fn(FBLAS_UINT thread_idx);
+    void io_thread_fn(FBLAS_UINT thread_idx, ThreadRole role);
+
+    // returns a free IoTask node, allocating one if the pool is empty
+    // NOTE :: `queue_mut` must be held
+    IoTask* alloc_task();
 
-    // Overlap Check function
-    // returns `true` if `thread_tsks[t1_idx]` and `thread_tsks[t2_idx]` overlap
-    bool overlap(FBLAS_UINT t1_idx, FBLAS_UINT t2_idx);
+    // drops `tsk`'s callback & returns `tsk` to the pool
+    // NOTE :: `queue_mut` must be held
+    void free_task(IoTask* tsk);
 
-    // Advertise `tsk` as `thread_idx`'s new task
-    void set_task(FBLAS_UINT thread_idx, IoTask* tsk);
+    // queues `tsk` by its priority, releases `lk` & wakes up IO threads
+    void push_task(IoTask* tsk, mutex_locker& lk);
 
-    // Advertise NULL task for thread-`thread_idx`
-    void set_null(FBLAS_UINT thread_idx);
+    // blocks until a task `role` can execute is available within its
+    // priority's `max_in_flight` & `ctl.get_depth()`; highest priority first
+    // queued reads that can be merged with the returned task are moved to
+    // `merged` (see `merge_gap`)
+    // returns `nullptr` on shutdown
+    IoTask* pop_task(ThreadRole role, std::vector<IoTask*>& merged);
+
+    // moves reads in `queues[prio]` that extend `tsk` into `merged`
+    // NOTE :: `queue_mut` must be held
+    void collect_merges(FBLAS_UINT prio, IoTask* tsk,
+                        std::vector<IoTask*>& merged);
+
+    // executes `tsk` & `merged` as one read, then copies out each task's
+    // data and calls its callback
+    void execute_merged(IoTask* tsk, std::vector<IoTask*>& merged);
+
+    // same as `finish_task()` for a task of `add_work()`; no stats
+    void finish_work(IoTask* tsk);
+
+    // returns default `max_in_flight` for `prio`
+    FBLAS_UINT default_max_in_flight(IoPriority prio) const;
 
     // helper function to execute task
-    // also deletes `tsk`
     void execute_task(IoTask* tsk);
 
+    // marks `tsk` & `merged` that moved `bytes` in `us` micro-seconds as
+    // complete, returns them to the pool & reports them to `ctl`
+    void finish_task(IoTask* tsk, std::vector<IoTask*>& merged,
+                     FBLAS_UINT bytes, FBLAS_UINT us);
+
    public:
-    // Constructor - Spawns `n_threads` number of IO threads
-    IoExecutor(FBLAS_UINT n_threads);
+    // `true` if IO thread `i` is pinned to the cores of NUMA node
+    // `i % numa::n_nodes()`; checked by each IO thread before each task
+    std::atomic<bool> numa;
+
+    // Constructor - Spawns `n_threads` number of IO threads executing any
+    // task, and `n_read_threads` (`n_write_threads`) threads executing only
+    // reads (writes)
+    IoExecutor(FBLAS_UINT n_threads, FBLAS_UINT n_read_threads = 0,
+               FBLAS_UINT n_write_threads = 0);
 
     // Cleanup - Shutdown `this->n_threads` number of threads
     ~IoExecutor();
 
     // NOTE :: if `sinfo.n_strides==1`, pre-align `buf, fptr, sinfo` for better
     // performance
-    // creates an IoTask object and adds to the task queue
+    // takes an IoTask from the pool and adds to the task queue
     void add_read(flash_ptr<void> fptr, StrideInfo sinfo, void* buf,
-                  std::function<void(void)> callback);
+                  IoCallback&& callback, IoPriority prio = IoPriority::Demand);
 
     // Same semantics as `add_read()`, but creates a `write` task instead
+    // NOTE :: writes are always `IoPriority::WriteBack`
     void add_write(flash_ptr<void> fptr, StrideInfo sinfo, void* buf,
-                   std::function<void(void)> callback);
+                   IoCallback&& callback);
+
+    // Same semantics as `add_write()`, but writes the concatenation of
+    // `gbufs` using one vectored request
+    void add_write(flash_ptr<void> fptr, StrideInfo sinfo, GatherList&& gbufs,
+                   IoCallback&& callback);
+
+    // runs `work` on an IO thread, queued & throttled like a read (or a
+    // write for `IoPriority::WriteBack`) of priority `prio`; for CPU-heavy
+    // steps of the I/O path, e.g. (de)compressing buffers, that must not run
+    // on the scheduler thread
+    // NOTE :: counts as pending I/O, but not in I/O stats
+    void add_work(IoCallback&& work, IoPriority prio);
+
+    // returns `true` if no IO task is queued or in execution
+    bool is_idle() const {
+      return this->n_pending.load() == 0;
+    }
+
+    // caps # of tasks of all priorities in execution; `0` removes the cap
+    void set_depth_limit(FBLAS_UINT limit);
+
+    // # of reads queued, not yet in execution
+    FBLAS_UINT n_queued_reads();
+
+    // limits # of `prio` tasks in execution to `depth`; `0` restores default
+    void set_max_in_flight(IoPriority prio, FBLAS_UINT depth);
+
+    // current I/O depth, chunk size & observed performance
+    IoStats get_stats() const {
+      return this->ctl.get_stats();
+    }
+
+    // adds I/O counters & queue depths to `stats`
+    void fill_stats(Stats& stats);
 
     friend class Scheduler;
   };
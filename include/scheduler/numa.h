@@ -0,0 +1,31 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "../bof_types.h"
+#include "core_budget.h"
+
+namespace flash {
+  // NUMA topology, read once from `/sys/devices/system/node`
+  // a machine without NUMA information is treated as one node holding all
+  // cores the process may run on
+  namespace numa {
+    // # of NUMA nodes with cores the process may run on
+    FBLAS_UINT n_nodes();
+
+    // cores of `node` the process may run on
+    const CoreSet &node_cores(FBLAS_UINT node);
+
+    // node of core `core`; `0` if unknown
+    FBLAS_UINT core_node(FBLAS_UINT core);
+
+    // pins the calling thread to `cores`; empty `cores` unpins
+    void pin_thread(const CoreSet &cores);
+
+    // asks the kernel to place pages of `[buf, buf + len)` not yet touched
+    // on `node`; pages are placed elsewhere if `node` runs out of memory
+    // returns `false` if the request failed
+    bool prefer_node(void *buf, FBLAS_UINT len, FBLAS_UINT node);
+  }  // namespace numa
+}  // namespace flash
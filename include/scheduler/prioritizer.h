@@ -38,6 +38,7 @@ namespace flash {
 
     // compute `mem_reqd` using current prioritizer state
     void fill_memreqd(TaskInfo &tsk_info) {
+      tsk_info.mem_reqd = 0;
       for (auto &k : tsk_info.all_keys) {
         if (this->in_mem_keys.find(k) == this->in_mem_keys.end()) {
           tsk_info.mem_reqd += buf_size(k.sinfo);
@@ -131,10 +132,13 @@ namespace flash {
       }
 
       // sort `tsks` in decreasing order of priority (increasing order of
-      // `mem_reqd`)
+      // `mem_reqd`), ties broken by `BaseTask::order`
       std::sort(this->tsks.begin(), this->tsks.end(),
                 [](const TaskInfo &left, const TaskInfo &right) {
-                  return left.mem_reqd < right.mem_reqd;
+                  if (left.mem_reqd != right.mem_reqd) {
+                    return left.mem_reqd < right.mem_reqd;
+                  }
+                  return left.tsk->order < right.tsk->order;
                 });
     }
 
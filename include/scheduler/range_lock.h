@@ -0,0 +1,58 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "../file_handles/file_handle.h"
+
+namespace flash {
+  // sector-aligned byte ranges `[start, end)` in one file
+  typedef std::vector<std::pair<FBLAS_UINT, FBLAS_UINT>> RangeList;
+
+  // returns disjoint, sorted, sector-aligned ranges touched by an access of
+  // pattern `sinfo` at `offset`
+  RangeList sector_ranges(FBLAS_UINT offset, const StrideInfo &sinfo);
+
+  // exclusive locks over sector ranges of files, sharded by file
+  // NOTE :: ranges held at any time are disjoint within a file
+  class RangeLock {
+    struct Held {
+      FBLAS_UINT                               end;
+      std::shared_ptr<std::condition_variable> cv;
+    };
+
+    struct Shard {
+      std::mutex mut;
+      // <fop, start> -> held range
+      std::map<std::pair<BaseFileHandle *, FBLAS_UINT>, Held> held;
+    };
+
+    static const FBLAS_UINT N_SHARDS = 64;
+    Shard                   shards[N_SHARDS];
+
+    typedef std::unique_lock<std::mutex> mutex_locker;
+
+    inline Shard &shard_of(BaseFileHandle *fop) {
+      return this->shards[(std::hash<BaseFileHandle *>()(fop) >> 4) %
+                          N_SHARDS];
+    }
+
+    // returns a held range overlapping any of `ranges`, `held.end()` if none
+    std::map<std::pair<BaseFileHandle *, FBLAS_UINT>, Held>::iterator
+    find_conflict(Shard &shard, BaseFileHandle *fop, const RangeList &ranges);
+
+   public:
+    // blocks until no range of `fop` overlapping `ranges` is held, then holds
+    // all of `ranges`
+    void lock(BaseFileHandle *fop, const RangeList &ranges);
+
+    // releases `ranges` held by `lock()` and wakes up their waiters
+    void unlock(BaseFileHandle *fop, const RangeList &ranges);
+  };
+}  // namespace flash
@@ -3,6 +3,10 @@
 
 #pragma once
 
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
@@ -13,8 +17,13 @@
 #include "../pointers/pointer.h"
 #include "../tasks/task.h"
 #include "cache.h"
+#include "core_budget.h"
 #include "io_executor.h"
+#include "numa.h"
 #include "prioritizer.h"
+#include "stats.h"
+#include "thread_balancer.h"
+#include "tracer.h"
 
 namespace flash {
   class CompletionRecord {
@@ -72,14 +81,106 @@ namespace flash {
     // satisfied WARNING:: May incur overhead, use only if required
     bool enable_prioritizer = true;
 
-    // checks for overlap between every write operation
-    // very low overhead, but reduces scalability with number of I/O threads
+    // serializes write operations sharing a disk sector
+    // writes wait only on the conflicting in-flight write
     bool enable_overlap_check = true;
 
     // if true, each buffer is evicted when released
     // set for high-performance\ data-streaming from disk
     // disable for caching and re-using (may incur caching overhead)
     bool single_use_discard = false;
+
+    // if true, `flush_cache()` at the end of each call writes back dirty
+    // buffers but retains up to `retain_size` bytes of clean buffers, so that
+    // consecutive calls re-using the same inputs skip reading them again
+    // WARNING:: files modified outside the library must be released with
+    // `flash::evict()` before the next call
+    bool       persistent_cache = false;
+    FBLAS_UINT retain_size = ((FBLAS_UINT) PROGRAM_BUDGET / 2);
+
+    // max # of bytes in one coalesced write-back of buffers adjacent on disk
+    // set to `0` to issue one write per evicted buffer
+    FBLAS_UINT write_coalesce_window = ((FBLAS_UINT) 1 << 26);
+
+    // writes back unused dirty buffers in the background, keeping them cached
+    // as clean; shortens `flush_cache()` at the end of each call
+    // * when I/O is idle, `background_flush_batch` bytes per housekeeping tick
+    // * when dirty buffers exceed `dirty_high_ratio` of the budget, until they
+    //   drop below `dirty_low_ratio` of the budget
+    bool       enable_background_flush = false;
+    float      dirty_high_ratio = 0.5f;
+    float      dirty_low_ratio = 0.25f;
+    FBLAS_UINT background_flush_batch = ((FBLAS_UINT) 1 << 28);
+
+    // keeps evicted clean buffers compressed in DRAM, on top of the program
+    // budget; a later miss decompresses instead of reading from disk
+    // * `compressed_tier_size` : max compressed bytes held, `0` disables
+    // * buffers compressing to more than `compressed_tier_max_ratio` of their
+    //   size are dropped as usual
+    FBLAS_UINT compressed_tier_size = 0;
+    float      compressed_tier_max_ratio = 0.75f;
+
+    // spills evicted clean buffers (that `compressed_tier` did not take) to a
+    // file in `flash_tier_dir`, ideally on a faster device than the inputs;
+    // a later miss reads from there instead of the original file
+    // * `flash_tier_size` : size of the tier file, `0` disables
+    // NOTE:: change only between calls, when no I/O is in progress
+    std::string flash_tier_dir = "";
+    FBLAS_UINT  flash_tier_size = 0;
+
+    // max # of in-flight I/O requests per priority class; `0` => default
+    // * demand reads (for tasks about to be computed) : all read threads
+    // * prefetch reads : 3/4th of read threads
+    // * write-backs : write-only threads + half of shared threads
+    // demand reads are always serviced before prefetches, and prefetches
+    // before write-backs
+    FBLAS_UINT io_demand_depth = 0;
+    FBLAS_UINT io_prefetch_depth = 0;
+    FBLAS_UINT io_write_back_depth = 0;
+
+    // queued contiguous reads of the same file at most `io_merge_gap` bytes
+    // apart are served by one read of atmost `io_merge_max` bytes
+    // set `io_merge_max` to `0` to disable merging
+    FBLAS_UINT io_merge_gap = ((FBLAS_UINT) 1 << 16);
+    FBLAS_UINT io_merge_max = ((FBLAS_UINT) 1 << 24);
+
+    // adjusts the # of I/O requests in execution (upto the # of I/O threads)
+    // and the max size of one disk request, backing off when latency grows
+    // without a gain in throughput; see `Scheduler::get_io_stats()`
+    // disabling restores all I/O threads & `DEFAULT_CHUNK_SIZE`
+    bool enable_adaptive_io = false;
+
+    // if non-empty, appends `flash::get_stats()` as one JSON line to
+    // `stats_file` every `stats_period_ms` ms
+    std::string stats_file = "";
+    FBLAS_UINT  stats_period_ms = 1000;
+
+    // every `balance_period_ms` ms, shifts cores between compute threads,
+    // threads per task (MKL & OpenMP) & in-flight I/O, based on compute
+    // thread utilization & compute | I/O queue depths; see `ThreadBalancer`
+    // disabling restores all compute threads, I/O depth & per-task defaults
+    bool       enable_thread_balancing = false;
+    FBLAS_UINT balance_period_ms = 250;
+
+    // hands each task a disjoint set of cores when it starts; its MKL &
+    // OpenMP calls use that many threads, pinned to the set if
+    // `pin_task_threads`
+    // * `core_budget` : # of cores shared by tasks, `0` => all cores the
+    //   process may run on
+    // * a task gets an even share for the # of active compute threads,
+    //   capped by the thread balancer's threads per task; with no free core
+    //   it shares the least-loaded one
+    bool       enable_core_budget = false;
+    FBLAS_UINT core_budget = 0;
+    bool       pin_task_threads = true;
+
+    // on machines with several NUMA nodes :
+    // * compute & I/O threads are spread over nodes & pinned to their node
+    // * a task is steered to the node holding most of its cached buffers
+    //   (round-robin if none) & its new buffers are placed there
+    // * compute threads run tasks of their node first, then steal
+    // with `enable_core_budget`, a task's cores come from its thread's node
+    bool enable_numa = false;
   };
 
   class Scheduler {
@@ -101,6 +202,9 @@ namespace flash {
     ConcurrentVector<BaseTask*> alloced_tsks;
     // I/O complete AND compute NOT complete
     ConcurrentQueue<BaseTask*> compute_queue;
+    // same, steered to a NUMA node, see `SchedulerOptions::enable_numa`
+    std::vector<std::unique_ptr<ConcurrentQueue<BaseTask*>>> node_queues;
+    std::atomic<bool>                                        numa;
     // compute complete
     ConcurrentQueue<BaseTask*> complete_queue;
 
@@ -110,17 +214,88 @@ namespace flash {
     // thread functions
     void sched_thread_fn();
     void compute_thread_fn();
+    void housekeeping_thread_fn();
 
     // thread shutdown signals
     std::atomic<bool> shutdown;
 
     // threads
     std::thread              sched_thread;
+    std::thread              housekeeping_thread;
     std::vector<std::thread> compute_threads;
 
     // helper functions
     bool alloc_ready(BaseTask* tsk);
 
+    // updates status of `tsk`, tracing the transition & adding the time
+    // spent in the old status to `state_ns`
+    void set_status(BaseTask* tsk, TaskStatus st);
+
+    // time spent by all tasks in each `TaskStatus`, in ns
+    std::atomic<uint64_t> state_ns[N_TASK_STATES];
+
+    // time each compute thread spent without a task, in ns; one slot per
+    // compute thread ever spawned
+    // slots are added under `stats_mut` & never move
+    std::deque<std::atomic<uint64_t>> compute_idle_ns;
+
+    // periodic stats dump, see `SchedulerOptions::stats_file`
+    // guarded by `stats_mut`
+    std::string stats_file;
+    FBLAS_UINT  stats_period_ms;
+    std::mutex  stats_mut;
+
+    // appends `get_stats()` to `stats_file` if `stats_period_ms` has passed
+    // since `last_dump`
+    void dump_stats(std::chrono::steady_clock::time_point& last_dump);
+
+    // time all compute threads spent executing tasks, in ns
+    std::atomic<uint64_t> compute_busy_ns;
+
+    // # of compute threads allowed to pick tasks (atmost `n_compute_thr`)
+    // & threads per task (`0` => task defaults), set by `balancer`
+    std::atomic<FBLAS_UINT> compute_limit;
+    std::atomic<FBLAS_UINT> task_threads;
+
+    // thread balancing, see `SchedulerOptions::enable_thread_balancing`
+    // guarded by `balance_mut`
+    ThreadBalancer balancer;
+    bool           balance;
+    FBLAS_UINT     balance_period_ms;
+    // end of the last balancing period & `compute_busy_ns` then
+    std::chrono::steady_clock::time_point last_balance;
+    uint64_t                              last_busy_ns;
+    std::mutex                            balance_mut;
+
+    // applies one `balancer` step if `balance_period_ms` has passed since
+    // `last_balance`
+    void balance_threads();
+
+    // turns thread balancing on | off; off restores static settings
+    void set_balancing(bool enable, FBLAS_UINT period_ms);
+
+    // cores for tasks, see `SchedulerOptions::enable_core_budget`
+    CoreBudget cores;
+    // # of tasks in `execute()`
+    std::atomic<FBLAS_UINT> n_executing;
+
+    // sets up threads for `tsk` on the calling compute thread, whose home
+    // NUMA node is `node`; returns the cores reserved for `tsk`, to be
+    // released after `execute()`
+    CoreSet start_task(BaseTask* tsk, FBLAS_UINT node);
+
+    // next task for a compute thread with home node `node`; `nullptr` if
+    // none
+    BaseTask* pop_compute(FBLAS_UINT node);
+
+    // # of tasks waiting for a compute thread
+    FBLAS_UINT n_compute_queued();
+
+    // # of compute threads allowed to pick tasks
+    FBLAS_UINT n_active_compute() const {
+      return std::min(this->n_compute_thr.load(), this->compute_limit.load());
+    }
+
    public:
     Scheduler(FBLAS_UINT n_io_threads, FBLAS_UINT n_compute_thr,
               FBLAS_UINT max_mem);
@@ -133,8 +308,24 @@ namespace flash {
     // NOTE:: use only if you need result persistence before program exit
     void flush_cache();
 
+    // drops all cached buffers backed by `fop`
+    void evict(BaseFileHandle* fop);
+
     void set_options(SchedulerOptions& sched_opts);
 
+    // current I/O depth, chunk size & observed performance
+    IoStats get_io_stats() const {
+      return this->io_exec.get_stats();
+    }
+
+    // snapshot of cache, I/O & scheduler counters
+    Stats get_stats();
+
+    // max # of bytes the cache holds
+    FBLAS_UINT cache_capacity() const {
+      return this->cache.capacity();
+    }
+
     void set_num_compute_threads(FBLAS_UINT new_num);
     const FBLAS_UINT get_num_compute_threads() const {
       return this->n_compute_thr;
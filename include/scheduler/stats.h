@@ -0,0 +1,66 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include "../bof_types.h"
+#include "io_executor.h"
+
+// # of `TaskStatus` values
+#define N_TASK_STATES 6
+
+namespace flash {
+  // raises `peak` to `val` if it is lower
+  inline void update_peak(std::atomic<FBLAS_UINT> &peak, FBLAS_UINT val) {
+    FBLAS_UINT cur = peak.load(std::memory_order_relaxed);
+    while (cur < val && !peak.compare_exchange_weak(cur, val)) {
+    }
+  }
+
+  // snapshot of library counters, all cumulative since start-up unless noted
+  // see `flash::get_stats()`
+  struct Stats {
+    // cache : per buffer asked for by a task
+    FBLAS_UINT cache_hits = 0;
+    FBLAS_UINT cache_misses = 0;
+    FBLAS_UINT cache_evictions = 0;
+    FBLAS_UINT cache_write_backs = 0;
+    // cache : bytes, current & peak
+    FBLAS_UINT real_size = 0;
+    FBLAS_UINT peak_real_size = 0;
+    FBLAS_UINT commit_size = 0;
+    FBLAS_UINT peak_commit_size = 0;
+    // victim tiers : reads served
+    FBLAS_UINT compressed_tier_hits = 0;
+    FBLAS_UINT flash_tier_hits = 0;
+
+    // I/O : tasks executed & bytes moved
+    FBLAS_UINT read_ops = 0;
+    FBLAS_UINT read_bytes = 0;
+    FBLAS_UINT write_ops = 0;
+    FBLAS_UINT write_bytes = 0;
+    // I/O : task latency histograms, see `LatencyHistogram`
+    FBLAS_UINT read_latency_us[N_LATENCY_BUCKETS] = {};
+    FBLAS_UINT write_latency_us[N_LATENCY_BUCKETS] = {};
+    // I/O : tasks queued & in execution now, by `IoPriority`
+    FBLAS_UINT queued[N_IO_PRIORITIES] = {};
+    FBLAS_UINT in_flight[N_IO_PRIORITIES] = {};
+    // I/O : depth & chunk size
+    IoStats io;
+
+    // scheduler : time spent by all tasks in each `TaskStatus`, in ms
+    double state_ms[N_TASK_STATES] = {};
+    // scheduler : time each compute thread spent without a task, in ms
+    std::vector<double> compute_idle_ms;
+    // scheduler : compute threads picking tasks now & threads per task
+    // (`0` => task defaults), see `ThreadBalancer`
+    FBLAS_UINT compute_threads = 0;
+    FBLAS_UINT task_threads = 0;
+
+    // returns all counters as one JSON object
+    std::string to_json() const;
+  };
+}  // namespace flash
@@ -0,0 +1,61 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "../bof_types.h"
+
+namespace flash {
+  // splits cores between compute threads, threads per task & I/O depth
+  // * I/O-bound period (compute threads mostly idle, reads queued, no task
+  //   waiting for a compute thread) : one compute thread less, one more
+  //   in-flight I/O
+  // * compute-bound period (compute threads busy, tasks waiting for one) :
+  //   one compute thread more, one in-flight I/O less
+  // * threads per task : cores left after I/O, split evenly between active
+  //   compute threads
+  // NOTE :: not thread-safe
+  class ThreadBalancer {
+    // compute threads busier (idler) than this are compute-bound (idle)
+    static constexpr float HIGH_UTIL = 0.9f;
+    static constexpr float LOW_UTIL = 0.5f;
+    // # of in-flight I/O requests that keep one core busy; I/O threads
+    // spend most of their time blocked
+    static const FBLAS_UINT IO_PER_CORE = 4;
+
+    FBLAS_UINT n_cores;
+    FBLAS_UINT max_compute;
+    FBLAS_UINT min_io, max_io;
+
+    FBLAS_UINT n_compute;
+    FBLAS_UINT io_limit;
+    FBLAS_UINT task_threads;
+
+    void update_task_threads();
+
+   public:
+    ThreadBalancer();
+
+    // starts from `max_compute` compute threads & `max_io` in-flight I/O
+    void reset(FBLAS_UINT n_cores, FBLAS_UINT max_compute, FBLAS_UINT max_io);
+
+    // adjusts settings to one period of observations
+    // `util` : fraction of time active compute threads were executing tasks
+    // `compute_backlog` : # of tasks waiting for a compute thread
+    // `io_backlog` : # of reads waiting for an I/O thread
+    // returns `true` if any setting changed
+    bool update(float util, FBLAS_UINT compute_backlog, FBLAS_UINT io_backlog);
+
+    FBLAS_UINT get_compute_threads() const {
+      return this->n_compute;
+    }
+
+    FBLAS_UINT get_io_limit() const {
+      return this->io_limit;
+    }
+
+    FBLAS_UINT get_task_threads() const {
+      return this->task_threads;
+    }
+  };
+}  // namespace flash
@@ -0,0 +1,48 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "../bof_types.h"
+#include "../tasks/task.h"
+
+namespace flash {
+  // opt-in recorder of task, I/O, cache & scheduler events, exported as
+  // Chrome trace JSON (opens in Perfetto & chrome://tracing)
+  // * each thread records into its own buffer; no locks after the first
+  //   event of a thread
+  // * event names & categories must be string literals
+  namespace trace {
+    // `true` while recording
+    extern std::atomic<bool> enabled;
+
+    // drops events recorded so far and starts recording
+    void start();
+
+    // stops recording & writes recorded events to `path`
+    // NOTE :: call between library calls, when no task or I/O is in progress
+    void stop(const std::string &path);
+
+    // names the calling thread in the trace
+    void name_thread(const char *name);
+
+    // current time on the trace clock, in ns
+    uint64_t now();
+
+    // records task `tsk_id` moving from state `from` to `to`; each state
+    // shows as a span on the task's async track
+    void task_state(FBLAS_UINT tsk_id, TaskStatus from, TaskStatus to);
+
+    // records a span `[start, now())` on the calling thread; `arg` is shown
+    // as `arg_name` if `arg_name` is not `nullptr`
+    void span(const char *cat, const char *name, uint64_t start,
+              const char *arg_name = nullptr, uint64_t arg = 0);
+
+    // records an instant on the calling thread
+    void instant(const char *cat, const char *name,
+                 const char *arg_name = nullptr, uint64_t arg = 0);
+  }  // namespace trace
+}  // namespace flash
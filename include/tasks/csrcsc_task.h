@@ -4,19 +4,25 @@
 #pragma once
 
 #include <cstring>
+#include "half_utils.h"
+#include "mkl_traits.h"
 #include "pointers/pointer.h"
 #include "tasks/task.h"
 
 namespace flash {
+  template<typename T>
   class BlockCsrCscTask : public BaseTask {
+    typedef compute_t<T> V;
+    typedef MklTraits<V> mkl;
+
     FBLAS_UINT pdim;
     FBLAS_UINT nnzs;
 
-    SparseBlock A_blk;
-    SparseBlock A_tr_blk;
+    SparseBlock<T> A_blk;
+    SparseBlock<T> A_tr_blk;
 
    public:
-    BlockCsrCscTask(SparseBlock A_block, SparseBlock A_tr_block)
+    BlockCsrCscTask(SparseBlock<T> A_block, SparseBlock<T> A_tr_block)
         : A_blk(A_block), A_tr_blk(A_tr_block) {
       this->pdim = std::max(A_blk.nrows, A_blk.ncols);
 
@@ -34,7 +40,7 @@ namespace flash {
       this->add_write(A_tr_blk.idxs_fptr, sinfo);
 
       // reads & writes for `matrix values`
-      sinfo.len_per_stride = nnzs * sizeof(FPTYPE);
+      sinfo.len_per_stride = nnzs * sizeof(T);
       this->add_read(A_blk.vals_fptr, sinfo);
       this->add_write(A_tr_blk.vals_fptr, sinfo);
     }
@@ -54,9 +60,9 @@ namespace flash {
         input_offs[i] = input_offs[A_blk.blk_size];
       }
 
-      mkl_set_num_threads_local(CSRCSC_MKL_NTHREADS);
+      mkl_set_num_threads_local(task_threads(CSRCSC_MKL_NTHREADS));
 
-      SparseBlock A_pblk(A_blk), A_tr_pblk(A_tr_blk);
+      SparseBlock<T> A_pblk(A_blk), A_tr_pblk(A_tr_blk);
       A_pblk.offs = input_offs;
       A_tr_pblk.offs = output_offs;
 
@@ -69,12 +75,17 @@ namespace flash {
       MKL_INT dim = pdim;
       MKL_INT info = -1;  // not used
 
+      // 16-bit values are permuted as `V`; widening & narrowing is exact
+      WideBuf<V, T> vals(A_pblk.vals_ptr, nnzs);
+      WideBuf<V, T> tr_vals(A_tr_pblk.vals_ptr, nnzs, false);
+
       // make MKL call
-      mkl_csrcsc(job, &dim, A_pblk.vals_ptr, A_pblk.idxs_ptr, A_pblk.offs,
-                 A_tr_pblk.vals_ptr, A_tr_pblk.idxs_ptr, A_tr_pblk.offs, &info);
+      mkl::csrcsc(job, &dim, vals.get(), A_pblk.idxs_ptr, A_pblk.offs,
+                  tr_vals.get(), A_tr_pblk.idxs_ptr, A_tr_pblk.offs, &info);
+      tr_vals.store(A_tr_pblk.vals_ptr);
 
 // add A_blk.start to `A_pblk.idxs_ptr`
-#pragma omp parallel for num_threads(CSRCSC_MKL_NTHREADS)
+#pragma omp parallel for num_threads(task_threads(CSRCSC_MKL_NTHREADS))
       for (FBLAS_UINT i = 0; i < nnzs; i++) {
         A_tr_pblk.idxs_ptr[i] += A_blk.start;
       }
@@ -98,12 +109,14 @@ namespace flash {
   };
 
   // Horizontally merge [column join] CSR matrices into one CSR matrix
+  template<typename T>
   class BlockMergeTask : public BaseTask {
-    SparseBlock              A_blk;
-    std::vector<SparseBlock> A_blks;
+    SparseBlock<T>              A_blk;
+    std::vector<SparseBlock<T>> A_blks;
 
    public:
-    BlockMergeTask(SparseBlock A_block, std::vector<SparseBlock> A_blocks)
+    BlockMergeTask(SparseBlock<T>              A_block,
+                   std::vector<SparseBlock<T>> A_blocks)
         : A_blk(A_block) {
       A_blks.reserve(A_blocks.size());
       FBLAS_UINT total_nnzs = A_blk.offs[A_blk.blk_size] - A_blk.offs[0];
@@ -111,7 +124,7 @@ namespace flash {
       StrideInfo sinfo = {1, 1, 1};
       sinfo.len_per_stride = total_nnzs * sizeof(MKL_INT);
       this->add_write(A_blk.idxs_fptr, sinfo);
-      sinfo.len_per_stride = total_nnzs * sizeof(FPTYPE);
+      sinfo.len_per_stride = total_nnzs * sizeof(T);
       this->add_write(A_blk.vals_fptr, sinfo);
       FBLAS_UINT got_nnzs = 0;
       for (auto blk : A_blocks) {
@@ -126,7 +139,7 @@ namespace flash {
 
         sinfo.len_per_stride = blk_nnzs * sizeof(MKL_INT);
         this->add_read(blk.idxs_fptr, sinfo);
-        sinfo.len_per_stride = blk_nnzs * sizeof(FPTYPE);
+        sinfo.len_per_stride = blk_nnzs * sizeof(T);
         this->add_read(blk.vals_fptr, sinfo);
       }
       GLOG_ASSERT(got_nnzs == total_nnzs, " expected nnzs=", total_nnzs,
@@ -140,7 +153,8 @@ namespace flash {
         fill_sparse_block_ptrs(this->in_mem_ptrs, blk);
       }
 
-#pragma omp parallel for schedule(dynamic, 1) num_threads(CSRCSC_MKL_NTHREADS)
+#pragma omp parallel for schedule(dynamic, 1) \
+    num_threads(task_threads(CSRCSC_MKL_NTHREADS))
       for (FBLAS_UINT row = 0; row < A_blk.blk_size; row++) {
         FBLAS_UINT fill_offset = (A_blk.offs[row] - A_blk.offs[0]);
         for (auto &blk : A_blks) {
@@ -149,7 +163,7 @@ namespace flash {
           memcpy(A_blk.idxs_ptr + fill_offset, blk.idxs_ptr + read_offset,
                  nnzs_in_blk * sizeof(MKL_INT));
           memcpy(A_blk.vals_ptr + fill_offset, blk.vals_ptr + read_offset,
-                 nnzs_in_blk * sizeof(FPTYPE));
+                 nnzs_in_blk * sizeof(T));
           fill_offset += nnzs_in_blk;
         }
         FBLAS_UINT expected_nnzs_in_row =
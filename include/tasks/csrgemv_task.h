@@ -6,27 +6,33 @@
 #include <thread>
 #include "bof_types.h"
 #include "bof_utils.h"
+#include "half_utils.h"
+#include "mkl_traits.h"
 #include "tasks/task.h"
 
 namespace flash {
+  // CSR values are stored as `S`, & widened to `T` once read
+  template<typename T, typename S = T>
   class CsrGemvNoTransInMem : public BaseTask {
+    typedef MklTraits<T> mkl;
+
     // matrix specs
     MKL_INT*           ia;
     flash_ptr<MKL_INT> ja;
-    flash_ptr<FPTYPE>  a;
+    flash_ptr<S>       a;
     FBLAS_UINT         dim;
     FBLAS_UINT         a_nrows;
     FBLAS_UINT         nnzs;
 
     // vector specs
-    FPTYPE* in;
-    FPTYPE* out;
+    T* in;
+    T* out;
 
    public:
     CsrGemvNoTransInMem(FBLAS_UINT start_row, FBLAS_UINT a_rows,
                         FBLAS_UINT a_cols, FBLAS_UINT a_rblk_size, MKL_INT* ia,
-                        flash_ptr<MKL_INT> ja, flash_ptr<FPTYPE> a,
-                        FPTYPE* v_in, FPTYPE* v_out) {
+                        flash_ptr<MKL_INT> ja, flash_ptr<S> a, T* v_in,
+                        T* v_out) {
       // matrix specs
       this->a_nrows = std::min(a_rows - start_row, a_rblk_size);
       this->dim = std::max(a_nrows, a_cols);
@@ -51,18 +57,19 @@ namespace flash {
       StrideInfo sinfo;
       sinfo.stride = 0;
       sinfo.n_strides = 1;
-      sinfo.len_per_stride = this->nnzs * sizeof(FPTYPE);
+      sinfo.len_per_stride = this->nnzs * sizeof(S);
       this->add_read(this->a, sinfo);
       sinfo.len_per_stride = this->nnzs * sizeof(MKL_INT);
       this->add_read(this->ja, sinfo);
     }
 
     void execute() {
-      MKL_INT* ja_ptr = (MKL_INT*) this->in_mem_ptrs[this->ja];
-      FPTYPE*  a_ptr = (FPTYPE*) this->in_mem_ptrs[this->a];
-      FPTYPE*  v_out = nullptr;
+      MKL_INT*      ja_ptr = (MKL_INT*) this->in_mem_ptrs[this->ja];
+      WideBuf<T, S> a_buf(this->in_mem_ptrs[this->a], this->nnzs);
+      T*            a_ptr = a_buf.get();
+      T*            v_out = nullptr;
       if (this->dim > this->a_nrows) {
-        v_out = new FPTYPE[this->dim];
+        v_out = new T[this->dim];
       } else {
         v_out = this->out;
       }
@@ -70,11 +77,13 @@ namespace flash {
       // MKL parameters;
       char    transa = 'N';
       MKL_INT m = this->dim;
+      // `0` restores MKL's global setting
+      mkl_set_num_threads_local(task_threads(0));
       // execute MKL call
-      mkl_csrgemv(&transa, &m, a_ptr, this->ia, ja_ptr, this->in, v_out);
+      mkl::csrgemv(&transa, &m, a_ptr, this->ia, ja_ptr, this->in, v_out);
 
       if (this->dim > this->a_nrows) {
-        memcpy(this->out, v_out, this->a_nrows * sizeof(FPTYPE));
+        memcpy(this->out, v_out, this->a_nrows * sizeof(T));
         delete[] v_out;
       }
 
@@ -83,21 +92,24 @@ namespace flash {
     }
 
     FBLAS_UINT size() {
+      FBLAS_UINT a_mem = this->nnzs * (sizeof(MKL_INT) + sizeof(S)) +
+                         WideBuf<T, S>::size(this->nnzs);
       if (this->dim > this->a_nrows) {
-        return (this->nnzs * (sizeof(MKL_INT) + sizeof(FPTYPE)) +
-                (this->dim + this->a_nrows) * sizeof(FPTYPE));
+        return a_mem + (this->dim + this->a_nrows) * sizeof(T);
       } else {
-        return (this->nnzs * (sizeof(MKL_INT) + sizeof(FPTYPE)) +
-                (this->a_nrows * sizeof(FPTYPE)));
+        return a_mem + (this->a_nrows * sizeof(T));
       }
     }
   };
 
+  template<typename T, typename S = T>
   class CsrGemvTransInMem : public BaseTask {
+    typedef MklTraits<T> mkl;
+
     // matrix specs
     MKL_INT*           ia;
     flash_ptr<MKL_INT> ja;
-    flash_ptr<FPTYPE>  a;
+    flash_ptr<S>       a;
     FBLAS_UINT         blk_size;
     FBLAS_UINT         a_rows;
     FBLAS_UINT         a_cols;
@@ -108,14 +120,14 @@ namespace flash {
     std::mutex& mut;
 
     // vector specs
-    FPTYPE* in;
-    FPTYPE* out;
+    T* in;
+    T* out;
 
    public:
     CsrGemvTransInMem(FBLAS_UINT start_row, FBLAS_UINT a_rows,
                       FBLAS_UINT a_cols, FBLAS_UINT a_rblk_size, MKL_INT* ia,
-                      flash_ptr<MKL_INT> ja, flash_ptr<FPTYPE> a, FPTYPE* v_in,
-                      FPTYPE* v_out, std::mutex& sync_mut)
+                      flash_ptr<MKL_INT> ja, flash_ptr<S> a, T* v_in, T* v_out,
+                      std::mutex& sync_mut)
         : mut(std::ref(sync_mut)) {
       // matrix specs
       this->blk_size = std::min(a_rows - start_row, a_rblk_size);
@@ -143,26 +155,28 @@ namespace flash {
       StrideInfo sinfo;
       sinfo.stride = 0;
       sinfo.n_strides = 1;
-      sinfo.len_per_stride = this->nnzs * sizeof(FPTYPE);
+      sinfo.len_per_stride = this->nnzs * sizeof(S);
       this->add_read(this->a, sinfo);
       sinfo.len_per_stride = this->nnzs * sizeof(MKL_INT);
       this->add_read(this->ja, sinfo);
     }
 
     void execute() {
-      MKL_INT* ja_ptr = (MKL_INT*) this->in_mem_ptrs[this->ja];
-      FPTYPE*  a_ptr = (FPTYPE*) this->in_mem_ptrs[this->a];
+      MKL_INT*      ja_ptr = (MKL_INT*) this->in_mem_ptrs[this->ja];
+      WideBuf<T, S> a_buf(this->in_mem_ptrs[this->a], this->nnzs);
+      T*            a_ptr = a_buf.get();
       // prepare MKL parameters;
       char    transa = 'T';
       MKL_INT m = (MKL_INT) this->dim;
-      FPTYPE* v_out = new FPTYPE[this->dim];
-      memset(v_out, 0, this->dim * sizeof(FPTYPE));
-      FPTYPE* v_in = new FPTYPE[this->dim];
-      memset(v_in, 0, this->dim * sizeof(FPTYPE));
-      memcpy(v_in, this->in, this->blk_size * sizeof(FPTYPE));
+      T*      v_out = new T[this->dim];
+      memset(v_out, 0, this->dim * sizeof(T));
+      T* v_in = new T[this->dim];
+      memset(v_in, 0, this->dim * sizeof(T));
+      memcpy(v_in, this->in, this->blk_size * sizeof(T));
 
       // execute MKL call
-      mkl_csrgemv(&transa, &m, a_ptr, this->ia, ja_ptr, v_in, v_out);
+      mkl_set_num_threads_local(task_threads(0));
+      mkl::csrgemv(&transa, &m, a_ptr, this->ia, ja_ptr, v_in, v_out);
       delete[] this->ia;
       delete[] v_in;
 
@@ -179,9 +193,10 @@ namespace flash {
     }
 
     FBLAS_UINT size() {
-      return (this->nnzs * (sizeof(MKL_INT) + sizeof(FPTYPE))) +
-             (this->dim * (sizeof(FPTYPE) + sizeof(MKL_INT))) +
-             (this->dim > this->blk_size ? this->dim * sizeof(FPTYPE) : 0);
+      return (this->nnzs * (sizeof(MKL_INT) + sizeof(S))) +
+             WideBuf<T, S>::size(this->nnzs) +
+             (this->dim * (sizeof(T) + sizeof(MKL_INT))) +
+             (this->dim > this->blk_size ? this->dim * sizeof(T) : 0);
     }
   };
 }  // namespace flash
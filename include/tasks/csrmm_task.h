@@ -5,6 +5,8 @@
 
 #include <malloc.h>
 #include <cstring>
+#include "half_utils.h"
+#include "mkl_traits.h"
 #include "tasks/task.h"
 
 namespace anon {
@@ -33,26 +35,31 @@ namespace anon {
 }  // namespace anon
 
 namespace flash {
+  // CSR values of `A` are stored as `S`, & widened to `T` once read; `B`
+  // and `C` are stored as `T`
+  template<typename T, typename S = T>
   class CsrmmRmTask : public BaseTask {
+    typedef MklTraits<T> mkl;
+
     MKL_INT *          ia;
     flash_ptr<MKL_INT> ja;
-    flash_ptr<FPTYPE>  a;
-    flash_ptr<FPTYPE>  b;
-    flash_ptr<FPTYPE>  c;
+    flash_ptr<S>       a;
+    flash_ptr<T>       b;
+    flash_ptr<T>       c;
     FBLAS_UINT         a_nrows;
     FBLAS_UINT         a_ncols;
     FBLAS_UINT         b_ncols;
     FBLAS_UINT         nnzs;
-    FPTYPE             alpha;
-    FPTYPE             beta;
+    T                  alpha;
+    T                  beta;
 
    public:
     CsrmmRmTask(const FBLAS_UINT start_row, const FBLAS_UINT start_col,
                 const FBLAS_UINT a_blk_size, const FBLAS_UINT b_blk_size,
                 const FBLAS_UINT a_rows, const FBLAS_UINT a_cols,
                 const FBLAS_UINT b_cols, const MKL_INT *ia,
-                flash_ptr<MKL_INT> ja, flash_ptr<FPTYPE> a, flash_ptr<FPTYPE> b,
-                flash_ptr<FPTYPE> c, const FPTYPE alpha, const FPTYPE beta)
+                flash_ptr<MKL_INT> ja, flash_ptr<S> a, flash_ptr<T> b,
+                flash_ptr<T> c, const T alpha, const T beta)
         : ja(ja), a(a), b(b), c(c) {
       this->alpha = alpha;
       this->beta = beta;
@@ -75,15 +82,15 @@ namespace flash {
       sinfo.stride = 0;
       sinfo.n_strides = 1;
       this->add_read(this->ja, sinfo);
-      sinfo.len_per_stride = nnzs * sizeof(FPTYPE);
+      sinfo.len_per_stride = nnzs * sizeof(S);
       this->add_read(this->a, sinfo);
-      sinfo.len_per_stride = b_ncols * sizeof(FPTYPE);
+      sinfo.len_per_stride = b_ncols * sizeof(T);
       sinfo.n_strides = (this->a_ncols - 1);
-      sinfo.stride = b_cols * sizeof(FPTYPE);
+      sinfo.stride = b_cols * sizeof(T);
       this->add_read(this->b, sinfo);
-      sinfo.len_per_stride = b_ncols * sizeof(FPTYPE);
+      sinfo.len_per_stride = b_ncols * sizeof(T);
       sinfo.n_strides = (this->a_nrows - 1);
-      sinfo.stride = b_cols * sizeof(FPTYPE);
+      sinfo.stride = b_cols * sizeof(T);
 
       if (beta != 0.0f) {
         this->add_read(this->c, sinfo);
@@ -93,11 +100,12 @@ namespace flash {
     }
 
     void execute() {
-      mkl_set_num_threads_local(CSRMM_RM_MKL_NTHREADS);
-      FPTYPE * a_ptr = (FPTYPE *) this->in_mem_ptrs[this->a];
-      FPTYPE * b_ptr = (FPTYPE *) this->in_mem_ptrs[this->b];
-      FPTYPE * c_ptr = (FPTYPE *) this->in_mem_ptrs[this->c];
-      MKL_INT *ja_ptr = (MKL_INT *) this->in_mem_ptrs[this->ja];
+      mkl_set_num_threads_local(task_threads(CSRMM_RM_MKL_NTHREADS));
+      WideBuf<T, S> a_buf(this->in_mem_ptrs[this->a], this->nnzs);
+      T *           a_ptr = a_buf.get();
+      T *           b_ptr = (T *) this->in_mem_ptrs[this->b];
+      T *           c_ptr = (T *) this->in_mem_ptrs[this->c];
+      MKL_INT *     ja_ptr = (MKL_INT *) this->in_mem_ptrs[this->ja];
       GLOG_ASSERT(a_ptr != nullptr, "nullptr for a");
       GLOG_ASSERT(ja_ptr != nullptr, "nullptr for ja");
       GLOG_ASSERT(b_ptr != nullptr, "nullptr for b");
@@ -110,38 +118,42 @@ namespace flash {
       MKL_INT k = (MKL_INT) this->a_ncols;
       CHAR    matdescra[5] = {'G', 'X', 'X', 'C', 'X'};
       // execute csrmm
-      mkl_csrmm(&trans_a, &m, &n, &k, &this->alpha, &matdescra[0], a_ptr,
-                ja_ptr, this->ia, this->ia + 1, b_ptr, &n, &this->beta, c_ptr,
-                &n);
+      mkl::csrmm(&trans_a, &m, &n, &k, &this->alpha, &matdescra[0], a_ptr,
+                 ja_ptr, this->ia, this->ia + 1, b_ptr, &n, &this->beta, c_ptr,
+                 &n);
 
       // cleanup
       delete[] this->ia;
     }
 
     FBLAS_UINT size() {
-      FBLAS_UINT a_size = nnzs * (sizeof(FPTYPE) + sizeof(MKL_INT));
-      FBLAS_UINT b_size = this->a_ncols * this->b_ncols * sizeof(FPTYPE);
-      FBLAS_UINT c_size = this->a_nrows * this->b_ncols * sizeof(FPTYPE);
+      FBLAS_UINT a_size = nnzs * (sizeof(S) + sizeof(MKL_INT)) +
+                          WideBuf<T, S>::size(nnzs);
+      FBLAS_UINT b_size = this->a_ncols * this->b_ncols * sizeof(T);
+      FBLAS_UINT c_size = this->a_nrows * this->b_ncols * sizeof(T);
       return a_size + b_size + c_size;
     }
   };
 
+  template<typename T, typename S = T>
   class SimpleCsrmmRmTask : public BaseTask {
-    SparseBlock       A_blk;
-    flash_ptr<FPTYPE> b;
-    flash_ptr<FPTYPE> c;
-    FBLAS_UINT        b_ncols;
-    FBLAS_UINT        nnzs;
-    FPTYPE            alpha;
-    FPTYPE            beta;
-    FBLAS_UINT        idx_delta, val_delta;
-    FBLAS_UINT        idx_len, val_len;
+    typedef MklTraits<T> mkl;
+
+    SparseBlock<S> A_blk;
+    flash_ptr<T>   b;
+    flash_ptr<T>   c;
+    FBLAS_UINT     b_ncols;
+    FBLAS_UINT     nnzs;
+    T              alpha;
+    T              beta;
+    FBLAS_UINT     idx_delta, val_delta;
+    FBLAS_UINT     idx_len, val_len;
 
    public:
-    SimpleCsrmmRmTask(const SparseBlock &A_block, flash_ptr<FPTYPE> b,
-                      flash_ptr<FPTYPE> c, FBLAS_UINT b_start_col,
-                      FBLAS_UINT b_blk_size, FBLAS_UINT b_cols, FPTYPE alpha,
-                      FPTYPE beta) {
+    SimpleCsrmmRmTask(const SparseBlock<S> &A_block, flash_ptr<T> b,
+                      flash_ptr<T> c, FBLAS_UINT b_start_col,
+                      FBLAS_UINT b_blk_size, FBLAS_UINT b_cols, T alpha,
+                      T beta) {
       this->A_blk = A_block;
       this->alpha = alpha;
       this->beta = beta;
@@ -164,7 +176,7 @@ namespace flash {
 
       FBLAS_UINT val_start_b = ROUND_DOWN(A_blk.vals_fptr.foffset, SECTOR_LEN);
       FBLAS_UINT val_end_b =
-          ROUND_UP(A_blk.vals_fptr.foffset + nnzs * sizeof(FPTYPE), SECTOR_LEN);
+          ROUND_UP(A_blk.vals_fptr.foffset + nnzs * sizeof(S), SECTOR_LEN);
       this->val_delta = A_blk.vals_fptr.foffset - val_start_b;
       this->val_len = val_end_b - val_start_b;
       A_blk.vals_fptr.foffset = val_start_b;
@@ -176,16 +188,16 @@ namespace flash {
 
       if (use_full) {
         GLOG_INFO("Using complete B matrix");
-        sinfo.len_per_stride = A_blk.ncols * this->b_ncols * sizeof(FPTYPE);
+        sinfo.len_per_stride = A_blk.ncols * this->b_ncols * sizeof(T);
         sinfo.n_strides = 1;
         this->add_read(this->b, sinfo);
 
         // prepare sinfo for `c`
-        sinfo.len_per_stride = A_blk.blk_size * this->b_ncols * sizeof(FPTYPE);
+        sinfo.len_per_stride = A_blk.blk_size * this->b_ncols * sizeof(T);
       } else {
         sinfo.n_strides = A_blk.ncols;
-        sinfo.len_per_stride = b_ncols * sizeof(FPTYPE);
-        sinfo.stride = b_cols * sizeof(FPTYPE);
+        sinfo.len_per_stride = b_ncols * sizeof(T);
+        sinfo.stride = b_cols * sizeof(T);
         this->add_read(this->b, sinfo);
 
         sinfo.n_strides = A_blk.blk_size;
@@ -199,7 +211,7 @@ namespace flash {
     }
 
     void execute() {
-      mkl_set_num_threads_local(CSRMM_RM_MKL_NTHREADS);
+      mkl_set_num_threads_local(task_threads(CSRMM_RM_MKL_NTHREADS));
       fill_sparse_block_ptrs(this->in_mem_ptrs, A_blk);
 
       // recover original array
@@ -208,8 +220,9 @@ namespace flash {
 #ifdef DEBUG
       verify_csr_block(A_blk, false);
 #endif
-      FPTYPE *b_ptr = (FPTYPE *) this->in_mem_ptrs[this->b];
-      FPTYPE *c_ptr = (FPTYPE *) this->in_mem_ptrs[this->c];
+      WideBuf<T, S> a_buf(A_blk.vals_ptr, this->nnzs);
+      T *           b_ptr = (T *) this->in_mem_ptrs[this->b];
+      T *           c_ptr = (T *) this->in_mem_ptrs[this->c];
 
       GLOG_ASSERT(A_blk.vals_ptr != nullptr, "nullptr for A_blk.vals");
       GLOG_ASSERT(A_blk.idxs_ptr != nullptr, "nullptr for A_blk.idxs");
@@ -223,9 +236,9 @@ namespace flash {
       MKL_INT k = (MKL_INT) A_blk.ncols;
       CHAR    matdescra[5] = {'G', 'X', 'X', 'C', 'X'};
       // execute csrmm
-      mkl_csrmm(&trans_a, &m, &n, &k, &this->alpha, &matdescra[0],
-                A_blk.vals_ptr, A_blk.idxs_ptr, A_blk.offs, A_blk.offs + 1,
-                b_ptr, &n, &this->beta, c_ptr, &n);
+      mkl::csrmm(&trans_a, &m, &n, &k, &this->alpha, &matdescra[0],
+                 a_buf.get(), A_blk.idxs_ptr, A_blk.offs, A_blk.offs + 1,
+                 b_ptr, &n, &this->beta, c_ptr, &n);
     }
 
     // DEPRECATED
@@ -234,20 +247,23 @@ namespace flash {
     }
   };
 
+  template<typename T, typename S = T>
   class SimpleCsrmmCmTask : public BaseTask {
-    SparseBlock       A_blk;
-    flash_ptr<FPTYPE> b;
-    flash_ptr<FPTYPE> c;
-    FBLAS_UINT        b_ncols;
-    FBLAS_UINT        nnzs;
-    FPTYPE            alpha;
-    FPTYPE            beta;
+    typedef MklTraits<T> mkl;
+
+    SparseBlock<S> A_blk;
+    flash_ptr<T>   b;
+    flash_ptr<T>   c;
+    FBLAS_UINT     b_ncols;
+    FBLAS_UINT     nnzs;
+    T              alpha;
+    T              beta;
 
    public:
-    SimpleCsrmmCmTask(const SparseBlock &A_block, flash_ptr<FPTYPE> b,
-                      flash_ptr<FPTYPE> c, FBLAS_UINT b_start_col,
-                      FBLAS_UINT b_blk_size, FBLAS_UINT b_cols, FPTYPE alpha,
-                      FPTYPE beta) {
+    SimpleCsrmmCmTask(const SparseBlock<S> &A_block, flash_ptr<T> b,
+                      flash_ptr<T> c, FBLAS_UINT b_start_col,
+                      FBLAS_UINT b_blk_size, FBLAS_UINT b_cols, T alpha,
+                      T beta) {
       this->A_blk = A_block;
       this->alpha = alpha;
       this->beta = beta;
@@ -260,16 +276,16 @@ namespace flash {
       this->nnzs = (A_blk.offs[A_blk.blk_size] - A_blk.offs[0]);
       sinfo.len_per_stride = nnzs * sizeof(MKL_INT);
       this->add_read(A_blk.idxs_fptr, sinfo);
-      sinfo.len_per_stride = nnzs * sizeof(FPTYPE);
+      sinfo.len_per_stride = nnzs * sizeof(S);
       this->add_read(A_blk.vals_fptr, sinfo);
 
-      sinfo.len_per_stride = A_blk.ncols * this->b_ncols * sizeof(FPTYPE);
+      sinfo.len_per_stride = A_blk.ncols * this->b_ncols * sizeof(T);
       sinfo.n_strides = 1;
       this->add_read(this->b, sinfo);
 
-      sinfo.len_per_stride = A_blk.blk_size * sizeof(FPTYPE);
+      sinfo.len_per_stride = A_blk.blk_size * sizeof(T);
       sinfo.n_strides = this->b_ncols;
-      sinfo.stride = A_blk.nrows * sizeof(FPTYPE);
+      sinfo.stride = A_blk.nrows * sizeof(T);
       if (beta != 0.0f) {
         this->add_read(this->c, sinfo);
       }
@@ -277,10 +293,11 @@ namespace flash {
     }
 
     void execute() {
-      mkl_set_num_threads_local(CSRMM_CM_MKL_NTHREADS);
+      mkl_set_num_threads_local(task_threads(CSRMM_CM_MKL_NTHREADS));
       fill_sparse_block_ptrs(this->in_mem_ptrs, A_blk);
-      FPTYPE *b_ptr = (FPTYPE *) this->in_mem_ptrs[this->b];
-      FPTYPE *c_ptr = (FPTYPE *) this->in_mem_ptrs[this->c];
+      WideBuf<T, S> a_buf(A_blk.vals_ptr, this->nnzs);
+      T *           b_ptr = (T *) this->in_mem_ptrs[this->b];
+      T *           c_ptr = (T *) this->in_mem_ptrs[this->c];
 
       GLOG_ASSERT(A_blk.vals_ptr != nullptr, "nullptr for A_blk.vals");
       GLOG_ASSERT(A_blk.idxs_ptr != nullptr, "nullptr for A_blk.idxs");
@@ -288,8 +305,8 @@ namespace flash {
       GLOG_ASSERT(c_ptr != nullptr, "nullptr for c");
 
 // ja is 0-based indexing => convert to 1-based for easy MKL call
-#pragma omp parallel for schedule(static, \
-                                  1048576) num_threads(CSRMM_CM_MKL_NTHREADS)
+#pragma omp parallel for schedule(static, 1048576) \
+    num_threads(task_threads(CSRMM_CM_MKL_NTHREADS))
       for (FBLAS_UINT j = 0; j < this->nnzs; j++) {
         A_blk.idxs_ptr[j]++;
       }
@@ -307,9 +324,9 @@ namespace flash {
       CHAR matdescra[5] = {'G', 'X', 'X', 'F', 'X'};
 
       // execute csrmm
-      mkl_csrmm(&trans_a, &m, &n, &k, &this->alpha, &matdescra[0],
-                A_blk.vals_ptr, A_blk.idxs_ptr, A_blk.offs, A_blk.offs + 1,
-                b_ptr, &k, &this->beta, c_ptr, &m);
+      mkl::csrmm(&trans_a, &m, &n, &k, &this->alpha, &matdescra[0],
+                 a_buf.get(), A_blk.idxs_ptr, A_blk.offs, A_blk.offs + 1,
+                 b_ptr, &k, &this->beta, c_ptr, &m);
     }
 
     // DEPRECATED
@@ -318,26 +335,29 @@ namespace flash {
     }
   };
 
+  template<typename T, typename S = T>
   class CsrmmCmTask : public BaseTask {
+    typedef MklTraits<T> mkl;
+
     MKL_INT *          ia;
     flash_ptr<MKL_INT> ja;
-    flash_ptr<FPTYPE>  a;
-    flash_ptr<FPTYPE>  b;
-    flash_ptr<FPTYPE>  c;
+    flash_ptr<S>       a;
+    flash_ptr<T>       b;
+    flash_ptr<T>       c;
     FBLAS_UINT         a_nrows;
     FBLAS_UINT         a_ncols;
     FBLAS_UINT         b_ncols;
     FBLAS_UINT         nnzs;
-    FPTYPE             alpha;
-    FPTYPE             beta;
+    T                  alpha;
+    T                  beta;
 
    public:
     CsrmmCmTask(const FBLAS_UINT start_row, const FBLAS_UINT start_col,
                 const FBLAS_UINT a_blk_size, const FBLAS_UINT b_blk_size,
                 const FBLAS_UINT a_rows, const FBLAS_UINT a_cols,
                 const FBLAS_UINT b_cols, const MKL_INT *ia,
-                flash_ptr<MKL_INT> ja, flash_ptr<FPTYPE> a, flash_ptr<FPTYPE> b,
-                flash_ptr<FPTYPE> c, const FPTYPE alpha, const FPTYPE beta)
+                flash_ptr<MKL_INT> ja, flash_ptr<S> a, flash_ptr<T> b,
+                flash_ptr<T> c, const T alpha, const T beta)
         : ja(ja), a(a), b(b), c(c) {
       this->alpha = alpha;
       this->beta = beta;
@@ -361,13 +381,13 @@ namespace flash {
       sinfo.stride = 0;
       sinfo.n_strides = 1;
       this->add_read(this->ja, sinfo);
-      sinfo.len_per_stride = nnzs * sizeof(FPTYPE);
+      sinfo.len_per_stride = nnzs * sizeof(S);
       this->add_read(this->a, sinfo);
-      sinfo.len_per_stride = this->b_ncols * a_cols * sizeof(FPTYPE);
+      sinfo.len_per_stride = this->b_ncols * a_cols * sizeof(T);
       this->add_read(this->b, sinfo);
-      sinfo.len_per_stride = this->a_nrows * sizeof(FPTYPE);
+      sinfo.len_per_stride = this->a_nrows * sizeof(T);
       sinfo.n_strides = (this->b_ncols);
-      sinfo.stride = a_rows * sizeof(FPTYPE);
+      sinfo.stride = a_rows * sizeof(T);
       if (beta != 0.0f) {
         this->add_read(this->c, sinfo);
       }
@@ -375,11 +395,12 @@ namespace flash {
     }
 
     void execute() {
-      mkl_set_num_threads_local(CSRMM_CM_MKL_NTHREADS);
-      FPTYPE * a_ptr = (FPTYPE *) this->in_mem_ptrs[this->a];
-      FPTYPE * b_ptr = (FPTYPE *) this->in_mem_ptrs[this->b];
-      FPTYPE * c_ptr = (FPTYPE *) this->in_mem_ptrs[this->c];
-      MKL_INT *ja_ptr = (MKL_INT *) this->in_mem_ptrs[this->ja];
+      mkl_set_num_threads_local(task_threads(CSRMM_CM_MKL_NTHREADS));
+      WideBuf<T, S> a_buf(this->in_mem_ptrs[this->a], this->nnzs);
+      T *           a_ptr = a_buf.get();
+      T *           b_ptr = (T *) this->in_mem_ptrs[this->b];
+      T *           c_ptr = (T *) this->in_mem_ptrs[this->c];
+      MKL_INT *     ja_ptr = (MKL_INT *) this->in_mem_ptrs[this->ja];
 
 // ja is 0-based indexing => convert to 1-based for easy MKL call
 #pragma omp parallel for schedule(static, CSRMM_CM_MKL_NTHREADS)
@@ -387,15 +408,15 @@ namespace flash {
         ja_ptr[j]++;
       }
       /*
-            GLOG_ASSERT(malloc_usable_size(a_ptr) >= nnzs * sizeof(FPTYPE),
+            GLOG_ASSERT(malloc_usable_size(a_ptr) >= nnzs * sizeof(T),
                         "bad malloc for a");
             GLOG_ASSERT(malloc_usable_size(ja_ptr) >= nnzs * sizeof(MKL_INT),
                         "bad malloc for ja");
             GLOG_ASSERT(
-                malloc_usable_size(b_ptr) >= a_ncols * b_ncols * sizeof(FPTYPE),
+                malloc_usable_size(b_ptr) >= a_ncols * b_ncols * sizeof(T),
                 "bad malloc for b");
             GLOG_ASSERT(
-                malloc_usable_size(c_ptr) >= a_nrows * b_ncols * sizeof(FPTYPE),
+                malloc_usable_size(c_ptr) >= a_nrows * b_ncols * sizeof(T),
                 "bad malloc for c");
       */
       // prepare csrmm parameters
@@ -406,43 +427,47 @@ namespace flash {
       // NOTE :: matdescra[3] = 'F' => column major storage & 1-based indexing
       CHAR matdescra[5] = {'G', 'X', 'X', 'F', 'X'};
       // execute csrmm
-      mkl_csrmm(&trans_a, &m, &n, &k, &this->alpha, &matdescra[0], a_ptr,
-                ja_ptr, this->ia, this->ia + 1, b_ptr, &k, &this->beta, c_ptr,
-                &m);
+      mkl::csrmm(&trans_a, &m, &n, &k, &this->alpha, &matdescra[0], a_ptr,
+                 ja_ptr, this->ia, this->ia + 1, b_ptr, &k, &this->beta, c_ptr,
+                 &m);
 
       // cleanup
       delete[] this->ia;
     }
 
     FBLAS_UINT size() {
-      FBLAS_UINT a_size = nnzs * (sizeof(FPTYPE) + sizeof(MKL_INT));
-      FBLAS_UINT b_size = this->a_ncols * this->b_ncols * sizeof(FPTYPE);
-      FBLAS_UINT c_size = this->a_nrows * this->b_ncols * sizeof(FPTYPE);
+      FBLAS_UINT a_size = nnzs * (sizeof(S) + sizeof(MKL_INT)) +
+                          WideBuf<T, S>::size(nnzs);
+      FBLAS_UINT b_size = this->a_ncols * this->b_ncols * sizeof(T);
+      FBLAS_UINT c_size = this->a_nrows * this->b_ncols * sizeof(T);
       return a_size + b_size + c_size;
     }
   };
 
+  template<typename T, typename S = T>
   class CsrmmCmInMemTask : public BaseTask {
+    typedef MklTraits<T> mkl;
+
     MKL_INT *          ia;
     flash_ptr<MKL_INT> ja;
-    flash_ptr<FPTYPE>  a;
-    FPTYPE *           b;
-    FPTYPE *           c;
+    flash_ptr<S>       a;
+    T *                b;
+    T *                c;
     FBLAS_UINT         a_nrows;
     FBLAS_UINT         a_ncols;
     FBLAS_UINT         b_ncols;
     StrideInfo         c_sinfo;
     FBLAS_UINT         nnzs;
-    FPTYPE             alpha;
-    FPTYPE             beta;
+    T                  alpha;
+    T                  beta;
 
    public:
     CsrmmCmInMemTask(const FBLAS_UINT start_row, const FBLAS_UINT start_col,
                      const FBLAS_UINT a_blk_size, const FBLAS_UINT b_blk_size,
                      const FBLAS_UINT a_rows, const FBLAS_UINT a_cols,
                      const FBLAS_UINT b_cols, const MKL_INT *ia,
-                     flash_ptr<MKL_INT> ja, flash_ptr<FPTYPE> a, FPTYPE *b,
-                     FPTYPE *c, const FPTYPE alpha, const FPTYPE beta) {
+                     flash_ptr<MKL_INT> ja, flash_ptr<S> a, T *b, T *c,
+                     const T alpha, const T beta) {
       this->alpha = alpha;
       this->beta = beta;
       FBLAS_UINT start_offset = ia[start_row];
@@ -458,9 +483,9 @@ namespace flash {
       this->b_ncols = std::min(b_cols - start_col, b_blk_size);
       this->b = b + (a_cols * start_col);
       this->c = c + ((start_col * a_rows) + start_row);
-      this->c_sinfo.len_per_stride = this->a_nrows * sizeof(FPTYPE);
+      this->c_sinfo.len_per_stride = this->a_nrows * sizeof(T);
       this->c_sinfo.n_strides = this->b_ncols;
-      this->c_sinfo.stride = a_rows * sizeof(FPTYPE);
+      this->c_sinfo.stride = a_rows * sizeof(T);
 
       StrideInfo sinfo;
       nnzs = (this->ia[this->a_nrows] - this->ia[0]);
@@ -469,28 +494,32 @@ namespace flash {
       sinfo.stride = 0;
       sinfo.n_strides = 1;
       this->add_read(this->ja, sinfo);
-      sinfo.len_per_stride = nnzs * sizeof(FPTYPE);
+      sinfo.len_per_stride = nnzs * sizeof(S);
       this->add_read(this->a, sinfo);
     }
 
     void execute() {
-      mkl_set_num_threads_local(CSRMM_CM_MKL_NTHREADS);
-      FPTYPE * a_ptr = (FPTYPE *) this->in_mem_ptrs[this->a];
-      MKL_INT *ja_ptr = (MKL_INT *) this->in_mem_ptrs[this->ja];
-      FPTYPE * b_ptr = this->b;
-      FPTYPE * c_ptr = new FPTYPE[this->a_nrows * this->b_ncols];
+      mkl_set_num_threads_local(task_threads(CSRMM_CM_MKL_NTHREADS));
+      WideBuf<T, S> a_buf(this->in_mem_ptrs[this->a], this->nnzs);
+      T *           a_ptr = a_buf.get();
+      MKL_INT *     ja_ptr = (MKL_INT *) this->in_mem_ptrs[this->ja];
+      T *           b_ptr = this->b;
+      T *           c_ptr = new T[this->a_nrows * this->b_ncols];
       if (this->beta != 0.0f) {
         GLOG_DEBUG("exec gather");
-        anon::gather<FPTYPE>(c_ptr, this->c, c_sinfo);
+        anon::gather<T>(c_ptr, this->c, c_sinfo);
       } else {
-        memset(c_ptr, 0, this->a_nrows * this->b_ncols * sizeof(FPTYPE));
+        memset(c_ptr, 0, this->a_nrows * this->b_ncols * sizeof(T));
       }
 
-// ja is 0-based indexing => convert to 1-based for easy MKL call
+// ja is 0-based indexing => convert to 1-based for easy MKL call; the cached
+// `ja` is shared with later passes over A, so convert a copy
+      MKL_INT *ja_1 = new MKL_INT[this->nnzs];
 #pragma omp parallel for schedule(static, CSRMM_CM_MKL_NTHREADS)
       for (FBLAS_INT j = 0; j < (FBLAS_INT) this->nnzs; j++) {
-        ja_ptr[j]++;
+        ja_1[j] = ja_ptr[j] + 1;
       }
+      ja_ptr = ja_1;
 
       GLOG_ASSERT(a_ptr != nullptr, "nullptr for a");
       GLOG_ASSERT(ja_ptr != nullptr, "nullptr for ja");
@@ -505,37 +534,43 @@ namespace flash {
       // NOTE :: matdescra[3] = 'F' => column major storage & 1-based indexing
       CHAR matdescra[5] = {'G', 'X', 'X', 'F', 'X'};
       // execute csrmm
-      mkl_csrmm(&trans_a, &m, &n, &k, &this->alpha, &matdescra[0], a_ptr,
-                ja_ptr, this->ia, this->ia + 1, b_ptr, &k, &this->beta, c_ptr,
-                &m);
-      anon::scatter<FPTYPE>(this->c, c_ptr, c_sinfo);
+      mkl::csrmm(&trans_a, &m, &n, &k, &this->alpha, &matdescra[0], a_ptr,
+                 ja_ptr, this->ia, this->ia + 1, b_ptr, &k, &this->beta, c_ptr,
+                 &m);
+      anon::scatter<T>(this->c, c_ptr, c_sinfo);
 
       // cleanup
       delete[] this->ia;
+      delete[] ja_1;
       delete[] c_ptr;
     }
 
     FBLAS_UINT size() {
-      FBLAS_UINT a_size = nnzs * (sizeof(FPTYPE) + sizeof(MKL_INT)) +
+      // `ja` is counted twice for its 1-based copy
+      FBLAS_UINT a_size = nnzs * (sizeof(S) + 2 * sizeof(MKL_INT)) +
+                          WideBuf<T, S>::size(nnzs) +
                           (this->a_nrows * sizeof(MKL_INT));
-      FBLAS_UINT temp_c_size = this->a_nrows * this->b_ncols * sizeof(FPTYPE);
+      FBLAS_UINT temp_c_size = this->a_nrows * this->b_ncols * sizeof(T);
       return a_size + temp_c_size;
     }
   };
+  template<typename T, typename S = T>
   class CsrmmRmInMemTask : public BaseTask {
+    typedef MklTraits<T> mkl;
+
     MKL_INT *          ia;
     flash_ptr<MKL_INT> ja;
-    flash_ptr<FPTYPE>  a;
-    FPTYPE *           b;
-    FPTYPE *           c;
+    flash_ptr<S>       a;
+    T *                b;
+    T *                c;
     FBLAS_UINT         a_nrows;
     FBLAS_UINT         a_ncols;
     FBLAS_UINT         b_ncols;
     StrideInfo         b_sinfo;
     StrideInfo         c_sinfo;
     FBLAS_UINT         nnzs;
-    FPTYPE             alpha;
-    FPTYPE             beta;
+    T                  alpha;
+    T                  beta;
     bool               use_orig = false;
 
    public:
@@ -543,8 +578,8 @@ namespace flash {
                      const FBLAS_UINT a_blk_size, const FBLAS_UINT b_blk_size,
                      const FBLAS_UINT a_rows, const FBLAS_UINT a_cols,
                      const FBLAS_UINT b_cols, const MKL_INT *ia,
-                     flash_ptr<MKL_INT> ja, flash_ptr<FPTYPE> a, FPTYPE *b,
-                     FPTYPE *c, const FPTYPE alpha, const FPTYPE beta) {
+                     flash_ptr<MKL_INT> ja, flash_ptr<S> a, T *b, T *c,
+                     const T alpha, const T beta) {
       GLOG_DEBUG("const params:start_row=", start_row,
                  ", start_col=", start_col, ", a_blk_size=", a_blk_size,
                  ", b_blk_size=", b_blk_size, ", a_rows=", a_rows,
@@ -569,12 +604,12 @@ namespace flash {
       }
       this->b = b + start_col;
       this->c = c + ((start_row * b_cols) + start_col);
-      this->c_sinfo.len_per_stride = this->b_ncols * sizeof(FPTYPE);
+      this->c_sinfo.len_per_stride = this->b_ncols * sizeof(T);
       this->c_sinfo.n_strides = this->a_nrows;
-      this->c_sinfo.stride = b_cols * sizeof(FPTYPE);
-      this->b_sinfo.len_per_stride = this->b_ncols * sizeof(FPTYPE);
+      this->c_sinfo.stride = b_cols * sizeof(T);
+      this->b_sinfo.len_per_stride = this->b_ncols * sizeof(T);
       this->b_sinfo.n_strides = a_cols;
-      this->b_sinfo.stride = b_cols * sizeof(FPTYPE);
+      this->b_sinfo.stride = b_cols * sizeof(T);
 
       StrideInfo sinfo;
       this->nnzs = (this->ia[this->a_nrows] - this->ia[0]);
@@ -583,41 +618,42 @@ namespace flash {
       sinfo.stride = 0;
       sinfo.n_strides = 1;
       this->add_read(this->ja, sinfo);
-      sinfo.len_per_stride = nnzs * sizeof(FPTYPE);
+      sinfo.len_per_stride = nnzs * sizeof(S);
       this->add_read(this->a, sinfo);
     }
 
     void execute() {
       // GLOG_WARN("using original B and C as direct input/output arrays");
-      mkl_set_num_threads_local(CSRMM_RM_MKL_NTHREADS);
-      FPTYPE * a_ptr = (FPTYPE *) this->in_mem_ptrs[this->a];
-      MKL_INT *ja_ptr = (MKL_INT *) this->in_mem_ptrs[this->ja];
-      FPTYPE * b_ptr = nullptr;
-      FPTYPE * c_ptr = nullptr;
+      mkl_set_num_threads_local(task_threads(CSRMM_RM_MKL_NTHREADS));
+      WideBuf<T, S> a_buf(this->in_mem_ptrs[this->a], this->nnzs);
+      T *           a_ptr = a_buf.get();
+      MKL_INT *     ja_ptr = (MKL_INT *) this->in_mem_ptrs[this->ja];
+      T *           b_ptr = nullptr;
+      T *           c_ptr = nullptr;
       // allocate & gather/scatter only if not working on original B & C
       if (!this->use_orig) {
-        b_ptr = new FPTYPE[this->a_ncols * this->b_ncols];
-        anon::gather<FPTYPE>(b_ptr, this->b, this->b_sinfo);
-        c_ptr = new FPTYPE[this->a_nrows * this->b_ncols];
+        b_ptr = new T[this->a_ncols * this->b_ncols];
+        anon::gather<T>(b_ptr, this->b, this->b_sinfo);
+        c_ptr = new T[this->a_nrows * this->b_ncols];
         if (this->beta != 0.0f) {
-          anon::gather<FPTYPE>(c_ptr, this->c, this->c_sinfo);
+          anon::gather<T>(c_ptr, this->c, this->c_sinfo);
         } else {
-          memset(c_ptr, 0, this->a_nrows * this->b_ncols * sizeof(FPTYPE));
+          memset(c_ptr, 0, this->a_nrows * this->b_ncols * sizeof(T));
         }
       } else {
         b_ptr = this->b;
         c_ptr = this->c;
       }
-      GLOG_ASSERT(malloc_usable_size(a_ptr) >= this->nnzs * sizeof(FPTYPE),
+      GLOG_ASSERT(malloc_usable_size(a_ptr) >= this->nnzs * sizeof(T),
                   "bad alloc for a_ptr");
       GLOG_ASSERT(malloc_usable_size(ja_ptr) >= this->nnzs * sizeof(MKL_INT),
                   "bad alloc for ja_ptr");
       if (!this->use_orig) {
         GLOG_ASSERT(malloc_usable_size(b_ptr) >=
-                        this->a_ncols * this->b_ncols * sizeof(FPTYPE),
+                        this->a_ncols * this->b_ncols * sizeof(T),
                     "bad alloc for b_ptr");
         GLOG_ASSERT(malloc_usable_size(c_ptr) >=
-                        this->a_nrows * this->b_ncols * sizeof(FPTYPE),
+                        this->a_nrows * this->b_ncols * sizeof(T),
                     "bad alloc for c_ptr, expected=");
       }
       // prepare csrmm parameters
@@ -629,13 +665,13 @@ namespace flash {
       GLOG_DEBUG("mkl_in_params:m=", m, ", n=", n, ", k=", k);
 
       // execute csrmm
-      mkl_csrmm(&trans_a, &m, &n, &k, &this->alpha, &matdescra[0], a_ptr,
-                ja_ptr, this->ia, this->ia + 1, this->b, &n, &this->beta,
-                this->c, &n);
+      mkl::csrmm(&trans_a, &m, &n, &k, &this->alpha, &matdescra[0], a_ptr,
+                 ja_ptr, this->ia, this->ia + 1, this->b, &n, &this->beta,
+                 this->c, &n);
 
       // write results out and delete temp outputs
       if (!this->use_orig) {
-        anon::scatter<FPTYPE>(this->c, c_ptr, c_sinfo);
+        anon::scatter<T>(this->c, c_ptr, c_sinfo);
         // cleanup
         delete[] b_ptr;
         delete[] c_ptr;
@@ -645,12 +681,13 @@ namespace flash {
     }
 
     FBLAS_UINT size() {
-      FBLAS_UINT a_size = this->nnzs * (sizeof(FPTYPE) + sizeof(MKL_INT)) +
+      FBLAS_UINT a_size = this->nnzs * (sizeof(S) + sizeof(MKL_INT)) +
+                          WideBuf<T, S>::size(this->nnzs) +
                           (this->a_nrows * sizeof(MKL_INT));
       // If not using original B and C matrices, then we need temporary copies
       if (!this->use_orig) {
-        return (this->a_ncols * this->b_ncols * sizeof(FPTYPE)) +
-               (this->a_nrows * this->b_ncols * sizeof(FPTYPE)) + a_size;
+        return (this->a_ncols * this->b_ncols * sizeof(T)) +
+               (this->a_nrows * this->b_ncols * sizeof(T)) + a_size;
       } else {
         return a_size;
       }
@@ -4,28 +4,42 @@
 #pragma once
 #include "bof_types.h"
 #include "bof_utils.h"
-#include "mkl.h"
+#include "half_utils.h"
+#include "mkl_traits.h"
 #include "pointers/pointer.h"
 #include "tasks/task.h"
 
 namespace flash {
-  // C = alpha*A*B + beta*C
+  // C = alpha*A*B + beta*C, computed in `T`
+  // * A, B stored as `S`; C stored as `U`; widened to `T` after I/O, & C is
+  //   narrowed back before write-back
+  // * with `acc`, the k-chain of a C tile sums into `*acc` in `T`, allocated
+  //   by its first task; only the `last` task reads/writes C, narrowing once
+  template<typename T, typename S = T, typename U = T>
   class GemmTask : public BaseTask {
-    flash_ptr<FPTYPE>       matA, matB, matC;
+    typedef MklTraits<T> mkl;
+
+    flash_ptr<S>            matA, matB;
+    flash_ptr<U>            matC;
     MKL_INT                 a_nrows, a_ncols, b_ncols;
     MKL_INT                 lda_a, lda_b, lda_c;
-    FPTYPE                  alpha, beta;
+    T                       alpha, beta;
+    T**                     acc;
+    bool                    last;
     decltype(CblasNoTrans)  trans_a, trans_b;
     decltype(CblasRowMajor) mat_ord;
 
    public:
-    GemmTask(flash_ptr<FPTYPE> a, flash_ptr<FPTYPE> b, flash_ptr<FPTYPE> c,
+    GemmTask(flash_ptr<S> a, flash_ptr<S> b, flash_ptr<U> c,
              FBLAS_UINT a_nrows, FBLAS_UINT a_ncols, FBLAS_UINT b_ncols,
              FBLAS_UINT ptr_offset[3], FBLAS_UINT lda_a, FBLAS_UINT lda_b,
-             FBLAS_UINT lda_c, StrideInfo stride_info[3], FPTYPE alpha,
-             FPTYPE beta, CHAR trans_a, CHAR trans_b, CHAR mat_ord) {
+             FBLAS_UINT lda_c, StrideInfo stride_info[3], T alpha, T beta,
+             CHAR trans_a, CHAR trans_b, CHAR mat_ord, T** acc = nullptr,
+             bool last = true) {
       this->alpha = alpha;
       this->beta = beta;
+      this->acc = acc;
+      this->last = last;
       this->trans_a = (trans_a == 'T' ? CblasTrans : CblasNoTrans);
       this->trans_b = (trans_b == 'T' ? CblasTrans : CblasNoTrans);
       this->mat_ord = (mat_ord == 'R' ? CblasRowMajor : CblasColMajor);
@@ -45,6 +59,10 @@ namespace flash {
 
       this->add_read(this->matA, stride_info[0]);
       this->add_read(this->matB, stride_info[1]);
+      // C is untouched until the last task of an accumulated k-chain
+      if (acc != nullptr && !last) {
+        return;
+      }
       // if source is not required, don't read
       if (beta != 0.0f) {
         this->add_read(this->matC, stride_info[2]);
@@ -55,7 +73,7 @@ namespace flash {
       this->add_write(this->matC, stride_info[2]);
     }
 
-    void print_matrix(FPTYPE* a, FBLAS_UINT M, FBLAS_UINT N) {
+    void print_matrix(T* a, FBLAS_UINT M, FBLAS_UINT N) {
       // printf("\nMatrix %s\n", s.c_str());
       for (FBLAS_UINT i = 0; i < M; i++) {
         for (FBLAS_UINT j = 0; j < N; j++)
@@ -67,13 +85,21 @@ namespace flash {
     void execute() {
       static std::atomic<FBLAS_UINT> cnt(0);
       GLOG_DEBUG("Executing tsk#", cnt.fetch_add(1));
-      mkl_set_num_threads_local(GEMM_MKL_NTHREADS);
-      FPTYPE* a_ptr = (FPTYPE*) in_mem_ptrs[matA];
-      FPTYPE* b_ptr = (FPTYPE*) in_mem_ptrs[matB];
-      FPTYPE* c_ptr = (FPTYPE*) in_mem_ptrs[matC];
-      GLOG_ASSERT(a_ptr != nullptr, "null a_ptr");
-      GLOG_ASSERT(b_ptr != nullptr, "null b_ptr");
-      GLOG_ASSERT(c_ptr != nullptr, "null c_ptr");
+      mkl_set_num_threads_local(task_threads(GEMM_MKL_NTHREADS));
+      GLOG_ASSERT(in_mem_ptrs[matA] != nullptr, "null a_ptr");
+      GLOG_ASSERT(in_mem_ptrs[matB] != nullptr, "null b_ptr");
+      WideBuf<T, S> a_buf(in_mem_ptrs[matA], a_nrows * a_ncols);
+      WideBuf<T, S> b_buf(in_mem_ptrs[matB], a_ncols * b_ncols);
+      if (acc != nullptr) {
+        accumulate(a_buf.get(), b_buf.get());
+        return;
+      }
+      GLOG_ASSERT(in_mem_ptrs[matC] != nullptr, "null c_ptr");
+      // C is not read if beta = 0
+      WideBuf<T, U> c_buf(in_mem_ptrs[matC], a_nrows * b_ncols, beta != 0.0f);
+      T*            a_ptr = a_buf.get();
+      T*            b_ptr = b_buf.get();
+      T*            c_ptr = c_buf.get();
       GLOG_DEBUG("MKL params : trans_a:", trans_a == CblasTrans ? 'T' : 'N',
                  ", trans_b:", trans_b == CblasTrans ? 'T' : 'N',
                  ", a_nrows:", a_nrows, ", b_ncols:", b_ncols,
@@ -84,18 +110,50 @@ namespace flash {
       // print_matrix(c_ptr, a_nrows, b_ncols, "C bef");
 
       // Determine parameters for MKL call
-      mkl_gemm(mat_ord, trans_a, trans_b,          // ordering
-               a_nrows, b_ncols, a_ncols,          // sizes
-               alpha, a_ptr, lda_a, b_ptr, lda_b,  // input
-               beta, c_ptr, lda_c);                // output
+      mkl::gemm(mat_ord, trans_a, trans_b,          // ordering
+                a_nrows, b_ncols, a_ncols,          // sizes
+                alpha, a_ptr, lda_a, b_ptr, lda_b,  // input
+                beta, c_ptr, lda_c);                // output
+      c_buf.store(in_mem_ptrs[matC]);
 
       // print_matrix(c_ptr, a_nrows, b_ncols, "C aft");
     }
 
+    // C = `*acc` + beta*C on the last task; `*acc` = 0 before the first
+    void accumulate(T* a_ptr, T* b_ptr) {
+      FBLAS_UINT c_len = a_nrows * b_ncols;
+      bool       first = (*acc == nullptr);
+      if (first) {
+        *acc = new T[c_len];
+      }
+      mkl::gemm(mat_ord, trans_a, trans_b, a_nrows, b_ncols, a_ncols, alpha,
+                a_ptr, lda_a, b_ptr, lda_b, first ? (T) 0.0f : (T) 1.0f, *acc,
+                lda_c);
+      if (!last) {
+        return;
+      }
+
+      GLOG_ASSERT(in_mem_ptrs[matC] != nullptr, "null c_ptr");
+      WideBuf<T, U> c_buf(in_mem_ptrs[matC], c_len, beta != 0.0f);
+      T*            c_ptr = c_buf.get();
+      for (FBLAS_UINT e = 0; e < c_len; e++) {
+        c_ptr[e] = (*acc)[e] + (beta != 0.0f ? beta * c_ptr[e] : (T) 0.0f);
+      }
+      c_buf.store(in_mem_ptrs[matC]);
+      delete[] *acc;
+      *acc = nullptr;
+    }
+
     FBLAS_UINT size() {
-      FBLAS_UINT a_mem = a_nrows * a_ncols * sizeof(FPTYPE);
-      FBLAS_UINT b_mem = a_ncols * b_ncols * sizeof(FPTYPE);
-      FBLAS_UINT c_mem = a_nrows * b_ncols * sizeof(FPTYPE);
+      FBLAS_UINT a_len = a_nrows * a_ncols;
+      FBLAS_UINT b_len = a_ncols * b_ncols;
+      FBLAS_UINT c_len = a_nrows * b_ncols;
+      FBLAS_UINT a_mem = a_len * sizeof(S) + WideBuf<T, S>::size(a_len);
+      FBLAS_UINT b_mem = b_len * sizeof(S) + WideBuf<T, S>::size(b_len);
+      FBLAS_UINT c_mem = c_len * sizeof(U) + WideBuf<T, U>::size(c_len);
+      if (acc != nullptr) {
+        c_mem = (last ? c_mem : 0) + c_len * sizeof(T);
+      }
 
       return (a_mem + b_mem + c_mem);
     }
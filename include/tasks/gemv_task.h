@@ -0,0 +1,170 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include "bof_types.h"
+#include "bof_utils.h"
+#include "half_utils.h"
+#include "mkl_traits.h"
+#include "pointers/pointer.h"
+#include "tasks/task.h"
+
+namespace flash {
+  // partial sums of `A^T*X`, one per concurrently executing `GemvTask`, so
+  // that row panels accumulate without serializing on the output
+  template<typename T>
+  class GemvAccumulator {
+    typedef std::unique_lock<std::mutex> mutex_locker;
+    std::mutex                           mut;
+    // all buffers, & those not held by a task; guarded by `mut`
+    std::vector<T*> bufs;
+    std::vector<T*> free_bufs;
+    FBLAS_UINT      len;
+
+   public:
+    GemvAccumulator(FBLAS_UINT len) {
+      this->len = len;
+    }
+
+    ~GemvAccumulator() {
+      for (auto buf : this->bufs) {
+        delete[] buf;
+      }
+    }
+
+    // a partial sum no other task holds; zeroed if new
+    T* acquire() {
+      mutex_locker lk(this->mut);
+      if (!this->free_bufs.empty()) {
+        T* buf = this->free_bufs.back();
+        this->free_bufs.pop_back();
+        return buf;
+      }
+      lk.unlock();
+      T* buf = new T[this->len];
+      memset(buf, 0, this->len * sizeof(T));
+      lk.lock();
+      this->bufs.push_back(buf);
+      return buf;
+    }
+
+    void release(T* buf) {
+      mutex_locker lk(this->mut);
+      this->free_bufs.push_back(buf);
+    }
+
+    // out = alpha * (sum of partial sums) + beta * out
+    // NOTE :: call once all tasks are complete
+    void reduce(T alpha, T beta, T* out) {
+      FBLAS_INT n = this->len;
+#pragma omp parallel for
+      for (FBLAS_INT i = 0; i < n; i++) {
+        T sum = 0;
+        for (auto buf : this->bufs) {
+          sum += buf[i];
+        }
+        out[i] = alpha * sum + (beta == 0 ? 0 : beta * out[i]);
+      }
+    }
+  };
+
+  // one row panel of a row-major matrix `A` on flash, multiplying `n_rhs`
+  // vectors at once; the i-th vector of `X` (`Y`) starts at `x + i * ldx`
+  // (`y + i * ldy`)
+  // - trans_a='N' : Y[rows] = alpha * A[rows, :] * X + beta * Y[rows]
+  // - trans_a='T' : acc += A[rows, :]^T * X[rows]
+  // `A` is stored as `S`, & widened to `T` once read
+  template<typename T, typename S = T>
+  class GemvTask : public BaseTask {
+    typedef MklTraits<T> mkl;
+
+    flash_ptr<S>        a;
+    FBLAS_UINT          start_row, n_rows, n_cols, n_rhs;
+    FBLAS_UINT          ldx, ldy;
+    T                   alpha, beta;
+    CHAR                trans_a;
+    T *                 x, *y;
+    GemvAccumulator<T>* acc;
+
+   public:
+    GemvTask(CHAR trans_a, flash_ptr<S> a, FBLAS_UINT lda_a,
+             FBLAS_UINT start_row, FBLAS_UINT n_rows, FBLAS_UINT n_cols,
+             FBLAS_UINT n_rhs, T alpha, T beta, T* x, FBLAS_UINT ldx, T* y,
+             FBLAS_UINT ldy, GemvAccumulator<T>* acc) {
+      this->trans_a = trans_a;
+      this->a = a + start_row * lda_a;
+      this->start_row = start_row;
+      this->n_rows = n_rows;
+      this->n_cols = n_cols;
+      this->n_rhs = n_rhs;
+      this->alpha = alpha;
+      this->beta = beta;
+      this->x = x;
+      this->ldx = ldx;
+      this->y = y;
+      this->ldy = ldy;
+      this->acc = acc;
+
+      // one sequential read if the panel is contiguous on flash
+      StrideInfo sinfo;
+      if (lda_a == n_cols) {
+        sinfo.n_strides = 1;
+        sinfo.len_per_stride = n_rows * n_cols * sizeof(S);
+        sinfo.stride = sinfo.len_per_stride;
+      } else {
+        sinfo.n_strides = n_rows;
+        sinfo.len_per_stride = n_cols * sizeof(S);
+        sinfo.stride = lda_a * sizeof(S);
+      }
+      this->add_read(this->a, sinfo);
+    }
+
+    void execute() {
+      GLOG_ASSERT(this->in_mem_ptrs[this->a] != nullptr, "null a_ptr");
+      WideBuf<T, S> a_buf(this->in_mem_ptrs[this->a],
+                          this->n_rows * this->n_cols);
+      T*            a_ptr = a_buf.get();
+      // `0` restores MKL's global setting
+      mkl_set_num_threads_local(task_threads(0));
+
+      if (this->trans_a == 'N') {
+        T* y_ptr = this->y + this->start_row;
+        if (this->n_rhs == 1) {
+          mkl::gemv(CblasRowMajor, CblasNoTrans, this->n_rows, this->n_cols,
+                    this->alpha, a_ptr, this->n_cols, this->x, 1, this->beta,
+                    y_ptr, 1);
+        } else {
+          // column-major view of the panel is `n_cols x n_rows`
+          mkl::gemm(CblasColMajor, CblasTrans, CblasNoTrans, this->n_rows,
+                    this->n_rhs, this->n_cols, this->alpha, a_ptr, this->n_cols,
+                    this->x, this->ldx, this->beta, y_ptr, this->ldy);
+        }
+        return;
+      }
+
+      T* x_ptr = this->x + this->start_row;
+      T* sum = this->acc->acquire();
+      if (this->n_rhs == 1) {
+        mkl::gemv(CblasRowMajor, CblasTrans, this->n_rows, this->n_cols, 1.0f,
+                  a_ptr, this->n_cols, x_ptr, 1, 1.0f, sum, 1);
+      } else {
+        mkl::gemm(CblasColMajor, CblasNoTrans, CblasNoTrans, this->n_cols,
+                  this->n_rhs, this->n_rows, 1.0f, a_ptr, this->n_cols, x_ptr,
+                  this->ldx, 1.0f, sum, this->n_cols);
+      }
+      this->acc->release(sum);
+    }
+
+    FBLAS_UINT size() {
+      FBLAS_UINT a_len = this->n_rows * this->n_cols;
+      FBLAS_UINT a_mem = a_len * sizeof(S) + WideBuf<T, S>::size(a_len);
+      if (this->trans_a == 'N') {
+        return a_mem;
+      }
+      return a_mem + (this->n_cols * this->n_rhs * sizeof(T));
+    }
+  };
+}  // namespace flash
@@ -4,28 +4,31 @@
 #pragma once
 #include "bof_types.h"
 #include "bof_utils.h"
-#include "mkl.h"
+#include "mkl_traits.h"
 #include "pointers/pointer.h"
 #include "tasks/task.h"
 
 namespace flash {
 
+  template<typename T>
   class KMeansTask : public BaseTask {
-    flash_ptr<FPTYPE>       matA, matB, matC;
-    FPTYPE *                c_l2sq, *p_l2sq, *ones;
+    typedef MklTraits<T> mkl;
+
+    flash_ptr<T>            matA, matB, matC;
+    T *                     c_l2sq, *p_l2sq, *ones;
     MKL_INT                 a_nrows, a_ncols, b_ncols;
     MKL_INT                 lda_a, lda_b, lda_c;
-    FPTYPE                  alpha, beta;
+    T                       alpha, beta;
     decltype(CblasNoTrans)  trans_a, trans_b;
     decltype(CblasRowMajor) mat_ord;
 
    public:
-    KMeansTask(flash_ptr<FPTYPE> a, flash_ptr<FPTYPE> b, flash_ptr<FPTYPE> c,
+    KMeansTask(flash_ptr<T> a, flash_ptr<T> b, flash_ptr<T> c,
                FBLAS_UINT a_nrows, FBLAS_UINT a_ncols, FBLAS_UINT b_ncols,
                FBLAS_UINT ptr_offset[3], FBLAS_UINT lda_a, FBLAS_UINT lda_b,
-               FBLAS_UINT lda_c, StrideInfo stride_info[3], FPTYPE alpha,
-               FPTYPE beta, CHAR trans_a, CHAR trans_b, CHAR mat_ord,
-               FPTYPE* c_l2sq, FPTYPE* p_l2sq, FPTYPE* ones) {
+               FBLAS_UINT lda_c, StrideInfo stride_info[3], T alpha, T beta,
+               CHAR trans_a, CHAR trans_b, CHAR mat_ord, T* c_l2sq, T* p_l2sq,
+               T* ones) {
       this->alpha = alpha;
       this->beta = beta;
       this->c_l2sq = c_l2sq;
@@ -51,10 +54,10 @@ namespace flash {
     }
 
     void execute() {
-      mkl_set_num_threads_local(GEMM_MKL_NTHREADS);
-      FPTYPE* a_ptr = (FPTYPE*) in_mem_ptrs[matA];
-      FPTYPE* b_ptr = (FPTYPE*) in_mem_ptrs[matB];
-      FPTYPE* c_ptr = (FPTYPE*) in_mem_ptrs[matC];
+      mkl_set_num_threads_local(task_threads(GEMM_MKL_NTHREADS));
+      T* a_ptr = (T*) in_mem_ptrs[matA];
+      T* b_ptr = (T*) in_mem_ptrs[matB];
+      T* c_ptr = (T*) in_mem_ptrs[matC];
       GLOG_ASSERT(a_ptr != NULL, "null a_ptr");
       GLOG_ASSERT(b_ptr != NULL, "null b_ptr");
       GLOG_ASSERT(c_ptr != NULL, "null c_ptr");
@@ -65,26 +68,26 @@ namespace flash {
                  ", lda_a:", lda_a, ", lda_b:", lda_b, ", lda_c:", lda_c);
 
       // Determine parameters for MKL call
-      mkl_gemm(mat_ord, trans_a, trans_b,          // ordering
-               a_nrows, b_ncols, a_ncols,          // sizes
-               alpha, a_ptr, lda_a, b_ptr, lda_b,  // input
-               beta, c_ptr, lda_c);                // output
+      mkl::gemm(mat_ord, trans_a, trans_b,          // ordering
+                a_nrows, b_ncols, a_ncols,          // sizes
+                alpha, a_ptr, lda_a, b_ptr, lda_b,  // input
+                beta, c_ptr, lda_c);                // output
 
-      mkl_gemm(mat_ord, CblasNoTrans, CblasTrans,    // ordering
-               a_nrows, b_ncols, 1,                  // sizes
-               1.0, c_l2sq, a_nrows, ones, b_ncols,  // input
-               1.0, c_ptr, lda_c);                   // output
+      mkl::gemm(mat_ord, CblasNoTrans, CblasTrans,    // ordering
+                a_nrows, b_ncols, 1,                  // sizes
+                1.0, c_l2sq, a_nrows, ones, b_ncols,  // input
+                1.0, c_ptr, lda_c);                   // output
 
-      mkl_gemm(mat_ord, CblasNoTrans, CblasTrans,    // ordering
-               a_nrows, b_ncols, 1,                  // sizes
-               1.0, ones, a_nrows, p_l2sq, b_ncols,  // input
-               1.0, c_ptr, lda_c);                   // output
+      mkl::gemm(mat_ord, CblasNoTrans, CblasTrans,    // ordering
+                a_nrows, b_ncols, 1,                  // sizes
+                1.0, ones, a_nrows, p_l2sq, b_ncols,  // input
+                1.0, c_ptr, lda_c);                   // output
     }
 
     FBLAS_UINT size() {
-      FBLAS_UINT a_mem = a_nrows * a_ncols * sizeof(FPTYPE);
-      FBLAS_UINT b_mem = a_ncols * b_ncols * sizeof(FPTYPE);
-      FBLAS_UINT c_mem = a_nrows * b_ncols * sizeof(FPTYPE);
+      FBLAS_UINT a_mem = a_nrows * a_ncols * sizeof(T);
+      FBLAS_UINT b_mem = a_ncols * b_ncols * sizeof(T);
+      FBLAS_UINT c_mem = a_nrows * b_ncols * sizeof(T);
 
       return (a_mem + b_mem + c_mem);
     }
@@ -36,7 +36,7 @@ namespace flash {
       InType * in_ptr = (InType *) this->in_mem_ptrs[this->in_fptr];
       OutType *out_ptr = (OutType *) this->in_mem_ptrs[this->out_fptr];
 
-#pragma omp parallel for
+#pragma omp parallel for num_threads(task_threads(omp_get_max_threads()))
       for (FBLAS_UINT i = 0; i < len; i++) {
         out_ptr[i] = this->map_fn(in_ptr[i]);
       }
@@ -71,7 +71,7 @@ namespace flash {
     void execute() {
       T *in_ptr = (T *) this->in_mem_ptrs[this->in_fptr];
       GLOG_ASSERT(in_ptr != nullptr, "null input to ReduceTask");
-      FBLAS_UINT n_threads = omp_get_num_threads();
+      FBLAS_UINT n_threads = task_threads(omp_get_max_threads());
       FBLAS_UINT thread_blk_size = ROUND_UP(this->len, n_threads) / n_threads;
       this->result = id;
 #pragma omp parallel for num_threads(n_threads)
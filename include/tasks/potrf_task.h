@@ -0,0 +1,111 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+#include <atomic>
+#include "bof_types.h"
+#include "bof_utils.h"
+#include "mkl_traits.h"
+#include "pointers/pointer.h"
+#include "tasks/task.h"
+
+namespace flash {
+  // Cholesky factorization of one `n x n` row-major diagonal tile, in place
+  template<typename T>
+  class PotrfTask : public BaseTask {
+    typedef MklTraits<T> mkl;
+
+    flash_ptr<T> tile;
+    MKL_INT      n;
+    CHAR         uplo;
+    // index of the tile's first row in the whole matrix
+    FBLAS_UINT              start;
+    std::atomic<FBLAS_INT>& info;
+
+   public:
+    // on failure, `info` is set to the 1-based row of the whole matrix where
+    // it was found not positive definite, if it is the first such row
+    PotrfTask(flash_ptr<T> tile, StrideInfo sinfo, FBLAS_UINT n, CHAR uplo,
+              FBLAS_UINT start, std::atomic<FBLAS_INT>& info)
+        : info(info) {
+      this->tile = tile;
+      this->n = n;
+      this->uplo = uplo;
+      this->start = start;
+      this->add_read(this->tile, sinfo);
+      this->add_write(this->tile, sinfo);
+    }
+
+    void execute() {
+      mkl_set_num_threads_local(task_threads(GEMM_MKL_NTHREADS));
+      T* t_ptr = (T*) in_mem_ptrs[this->tile];
+      GLOG_ASSERT(t_ptr != nullptr, "null t_ptr");
+      MKL_INT ret = mkl::potrf(LAPACK_ROW_MAJOR, this->uplo, this->n, t_ptr,
+                               this->n);
+      if (ret < 0) {
+        GLOG_FATAL("potrf failed with ret=", ret);
+      }
+      if (ret > 0) {
+        FBLAS_INT row = this->start + ret;
+        FBLAS_INT cur = this->info.load();
+        while ((cur == 0 || row < cur) &&
+               !this->info.compare_exchange_weak(cur, row)) {
+        }
+      }
+    }
+
+    FBLAS_UINT size() {
+      return this->n * this->n * sizeof(T);
+    }
+  };
+
+  // B = alpha*op(A)^-1*B (side='L') or B = alpha*B*op(A)^-1 (side='R') for
+  // one row-major tile `B`, in place; `A` is a triangular diagonal tile
+  template<typename T>
+  class TrsmTask : public BaseTask {
+    typedef MklTraits<T> mkl;
+
+    flash_ptr<T> mat_a, mat_b;
+    MKL_INT      b_nrows, b_ncols;
+    T            alpha;
+    CHAR         side, uplo, trans, diag;
+
+   public:
+    // `sinfo[0..1]` : access patterns of A & B
+    TrsmTask(flash_ptr<T> a, flash_ptr<T> b, StrideInfo sinfo[2],
+             FBLAS_UINT b_nrows, FBLAS_UINT b_ncols, T alpha, CHAR side,
+             CHAR uplo, CHAR trans, CHAR diag) {
+      this->mat_a = a;
+      this->mat_b = b;
+      this->b_nrows = b_nrows;
+      this->b_ncols = b_ncols;
+      this->alpha = alpha;
+      this->side = side;
+      this->uplo = uplo;
+      this->trans = trans;
+      this->diag = diag;
+      this->add_read(this->mat_a, sinfo[0]);
+      this->add_read(this->mat_b, sinfo[1]);
+      this->add_write(this->mat_b, sinfo[1]);
+    }
+
+    void execute() {
+      mkl_set_num_threads_local(task_threads(GEMM_MKL_NTHREADS));
+      T* a_ptr = (T*) in_mem_ptrs[this->mat_a];
+      T* b_ptr = (T*) in_mem_ptrs[this->mat_b];
+      GLOG_ASSERT(a_ptr != nullptr, "null a_ptr");
+      GLOG_ASSERT(b_ptr != nullptr, "null b_ptr");
+      MKL_INT a_dim = (this->side == 'L' ? this->b_nrows : this->b_ncols);
+      mkl::trsm(CblasRowMajor, (this->side == 'L' ? CblasLeft : CblasRight),
+                (this->uplo == 'L' ? CblasLower : CblasUpper),
+                (this->trans == 'T' ? CblasTrans : CblasNoTrans),
+                (this->diag == 'U' ? CblasUnit : CblasNonUnit), this->b_nrows,
+                this->b_ncols, this->alpha, a_ptr, a_dim, b_ptr, this->b_ncols);
+    }
+
+    FBLAS_UINT size() {
+      FBLAS_UINT a_dim = (this->side == 'L' ? this->b_nrows : this->b_ncols);
+      return (a_dim * a_dim + this->b_nrows * this->b_ncols) * sizeof(T);
+    }
+  };
+}  // namespace flash
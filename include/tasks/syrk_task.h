@@ -0,0 +1,123 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+#include "bof_types.h"
+#include "bof_utils.h"
+#include "mkl_traits.h"
+#include "pointers/pointer.h"
+#include "tasks/task.h"
+
+namespace flash {
+  // one tile of C = alpha*op(A)*op(A)^T + beta*C, all row-major
+  // * C_ij = alpha*P_i*P_j^T + beta*C_ij, where P_i is the i-th row block
+  //   of op(A) restricted to one block of `k`
+  // * diagonal tiles read one panel of A & use `syrk`, filling only the
+  //   `uplo` triangle of the tile
+  // * if `mirror`, also writes C_ij^T to C_ji (or the other triangle of a
+  //   diagonal tile)
+  template<typename T>
+  class SyrkTask : public BaseTask {
+    typedef MklTraits<T> mkl;
+
+    flash_ptr<T> pan_i, pan_j, mat_c, mat_cm;
+    MKL_INT      rows_i, rows_j, k_size;
+    T            alpha, beta;
+    CHAR         uplo, trans;
+    bool         diag, mirror;
+
+   public:
+    // `sinfo[0..3]` : access patterns of P_i, P_j, C_ij & C_ji
+    SyrkTask(flash_ptr<T> pan_i, flash_ptr<T> pan_j, flash_ptr<T> mat_c,
+             flash_ptr<T> mat_cm, FBLAS_UINT rows_i, FBLAS_UINT rows_j,
+             FBLAS_UINT k_size, StrideInfo sinfo[4], T alpha, T beta,
+             CHAR uplo, CHAR trans, bool diag, bool mirror) {
+      this->pan_i = pan_i;
+      this->pan_j = pan_j;
+      this->mat_c = mat_c;
+      this->mat_cm = mat_cm;
+      this->rows_i = rows_i;
+      this->rows_j = rows_j;
+      this->k_size = k_size;
+      this->alpha = alpha;
+      this->beta = beta;
+      this->uplo = uplo;
+      this->trans = trans;
+      this->diag = diag;
+      this->mirror = mirror;
+
+      this->add_read(this->pan_i, sinfo[0]);
+      if (!diag) {
+        this->add_read(this->pan_j, sinfo[1]);
+      }
+      // if source is not required, don't read; a diagonal tile that is not
+      // mirrored keeps its other triangle, so it is always read
+      if (beta != 0.0f || (diag && !mirror)) {
+        this->add_read(this->mat_c, sinfo[2]);
+      }
+      this->add_write(this->mat_c, sinfo[2]);
+      if (mirror && !diag) {
+        this->add_write(this->mat_cm, sinfo[3]);
+      }
+    }
+
+    void execute() {
+      mkl_set_num_threads_local(task_threads(GEMM_MKL_NTHREADS));
+      T* i_ptr = (T*) in_mem_ptrs[this->pan_i];
+      T* c_ptr = (T*) in_mem_ptrs[this->mat_c];
+      GLOG_ASSERT(i_ptr != nullptr, "null i_ptr");
+      GLOG_ASSERT(c_ptr != nullptr, "null c_ptr");
+      // panels are `rows x k_size` for 'N', `k_size x rows` for 'T'
+      bool    tr = (this->trans == 'T');
+      MKL_INT ld_i = (tr ? this->rows_i : this->k_size);
+
+      if (this->diag) {
+        mkl::syrk(CblasRowMajor, (this->uplo == 'L' ? CblasLower : CblasUpper),
+                  (tr ? CblasTrans : CblasNoTrans), this->rows_i, this->k_size,
+                  this->alpha, i_ptr, ld_i, this->beta, c_ptr, this->rows_i);
+        if (this->mirror) {
+          MKL_INT n = this->rows_i;
+          bool    lower = (this->uplo == 'L');
+#pragma omp parallel for num_threads(task_threads(GEMM_MKL_NTHREADS))
+          for (MKL_INT r = 0; r < n; r++) {
+            for (MKL_INT c = r + 1; c < n; c++) {
+              if (lower) {
+                c_ptr[r * n + c] = c_ptr[c * n + r];
+              } else {
+                c_ptr[c * n + r] = c_ptr[r * n + c];
+              }
+            }
+          }
+        }
+        return;
+      }
+
+      T* j_ptr = (T*) in_mem_ptrs[this->pan_j];
+      GLOG_ASSERT(j_ptr != nullptr, "null j_ptr");
+      MKL_INT ld_j = (tr ? this->rows_j : this->k_size);
+      mkl::gemm(CblasRowMajor, (tr ? CblasTrans : CblasNoTrans),
+                (tr ? CblasNoTrans : CblasTrans), this->rows_i, this->rows_j,
+                this->k_size, this->alpha, i_ptr, ld_i, j_ptr, ld_j, this->beta,
+                c_ptr, this->rows_j);
+
+      if (this->mirror) {
+        T* m_ptr = (T*) in_mem_ptrs[this->mat_cm];
+        GLOG_ASSERT(m_ptr != nullptr, "null m_ptr");
+        MKL_INT ri = this->rows_i, rj = this->rows_j;
+#pragma omp parallel for num_threads(task_threads(GEMM_MKL_NTHREADS))
+        for (MKL_INT c = 0; c < rj; c++) {
+          for (MKL_INT r = 0; r < ri; r++) {
+            m_ptr[c * ri + r] = c_ptr[r * rj + c];
+          }
+        }
+      }
+    }
+
+    FBLAS_UINT size() {
+      FBLAS_UINT p_mem = (this->rows_i + (this->diag ? 0 : this->rows_j)) *
+                         this->k_size * sizeof(T);
+      FBLAS_UINT c_mem = this->rows_i * this->rows_j * sizeof(T);
+      return p_mem + (this->mirror && !this->diag ? 2 : 1) * c_mem;
+    }
+  };
+}  // namespace flash
@@ -11,6 +11,16 @@
 
 namespace flash {
   extern std::atomic<FBLAS_UINT> global_task_counter;
+
+  // # of threads the task executing on the calling thread should use, set
+  // by `Scheduler` before `execute()`; `0` => the task's default
+  extern thread_local FBLAS_UINT task_n_threads;
+
+  // returns # of threads for MKL | OpenMP in `execute()`; `dflt` unless
+  // `Scheduler` decided otherwise
+  inline FBLAS_UINT task_threads(FBLAS_UINT dflt) {
+    return (task_n_threads != 0 ? task_n_threads : dflt);
+  }
   // Different states of a Task
   enum TaskStatus {
     Wait,          // task not yet started
@@ -28,6 +38,8 @@ namespace flash {
     // <ptr, strides, R|W>
     std::vector<std::pair<flash_ptr<void>, StrideInfo>> read_list;
     std::vector<std::pair<flash_ptr<void>, StrideInfo>> write_list;
+    // subset of `read_list` | `write_list` to keep cached for a later task
+    std::vector<std::pair<flash_ptr<void>, StrideInfo>> pin_list;
     std::vector<FBLAS_UINT> parents;
 
     std::unordered_map<flash_ptr<void>, void*, FlashPtrHasher, FlashPtrEq>
@@ -35,6 +47,8 @@ namespace flash {
 
     // Status of Task
     std::atomic<TaskStatus> st;
+    // time `st` was last set by `Scheduler`, in ns; `0` if never
+    uint64_t st_start;
 
     // Continuation
     BaseTask* next;
@@ -42,11 +56,22 @@ namespace flash {
     // Unique Task ID
     FBLAS_UINT task_id;
 
+    // NUMA node holding the task's buffers, set by `Cache`
+    FBLAS_UINT numa_node;
+
+    // position in the submitting routine's preferred execution order;
+    // `task_id` unless set. A hint, not a dependency : `Prioritizer` runs
+    // ready tasks needing the same I/O in increasing `order`
+    FBLAS_UINT order;
+
    public:
     BaseTask() {
       this->st.store(Wait);
+      this->st_start = 0;
+      this->numa_node = 0;
       this->next = nullptr;
       this->task_id = global_task_counter.fetch_add(1);
+      this->order = this->task_id;
     }
 
     virtual ~BaseTask() {
@@ -66,6 +91,14 @@ namespace flash {
       this->write_list.push_back(std::make_pair(fptr, sinfo));
     }
 
+    // keeps a buffer read | written by this task cached after it completes,
+    // for a later task : it is not written back in the background & evicted
+    // only if nothing else can be. The pin lasts until the next task using
+    // the buffer completes without pinning it again
+    void add_pin(flash_ptr<void> fptr, StrideInfo& sinfo) {
+      this->pin_list.push_back(std::make_pair(fptr, sinfo));
+    }
+
     virtual FBLAS_UINT size() = 0;
 
     void add_parent(FBLAS_UINT id) {
@@ -95,6 +128,10 @@ namespace flash {
       return this->task_id;
     }
 
+    void set_order(FBLAS_UINT order) {
+      this->order = order;
+    }
+
     friend class Scheduler;
     friend class Cache;
     friend class Prioritizer;
@@ -0,0 +1,196 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+#include <cstring>
+#include <vector>
+#include "bof_types.h"
+#include "bof_utils.h"
+#include "mkl_traits.h"
+#include "pointers/pointer.h"
+#include "tasks/task.h"
+
+namespace flash {
+  // R factors & tree Q blocks are `n x n` row-major, in memory
+
+  // QR of one `n_rows x n` row panel of A
+  // * writes the panel's R to `r`
+  // * if `q` is not null, writes the panel's explicit Q to `q` (may be `a`)
+  template<typename T>
+  class TsqrPanelTask : public BaseTask {
+    typedef MklTraits<T> mkl;
+
+    flash_ptr<T> a, q;
+    MKL_INT      n_rows, n;
+    bool         col_major, write_q;
+    T*           r;
+
+   public:
+    // `sinfo[0..1]` : access patterns of the panel in A & Q
+    TsqrPanelTask(flash_ptr<T> a, flash_ptr<T> q, StrideInfo sinfo[2],
+                  FBLAS_UINT n_rows, FBLAS_UINT n, bool col_major, T* r) {
+      this->a = a;
+      this->q = q;
+      this->n_rows = n_rows;
+      this->n = n;
+      this->col_major = col_major;
+      this->write_q = (q.fop != nullptr);
+      this->r = r;
+      this->add_read(this->a, sinfo[0]);
+      if (this->write_q) {
+        this->add_write(this->q, sinfo[1]);
+      }
+    }
+
+    void execute() {
+      mkl_set_num_threads_local(task_threads(GEMM_MKL_NTHREADS));
+      T* a_ptr = (T*) in_mem_ptrs[this->a];
+      GLOG_ASSERT(a_ptr != nullptr, "null a_ptr");
+      FBLAS_UINT len = this->n_rows * this->n;
+
+      // the cached panel of A is shared; factor a copy unless it is Q's
+      T* work = nullptr;
+      if (this->write_q) {
+        work = (T*) in_mem_ptrs[this->q];
+        GLOG_ASSERT(work != nullptr, "null q_ptr");
+      } else {
+        work = new T[len];
+      }
+      if (work != a_ptr) {
+        memcpy(work, a_ptr, len * sizeof(T));
+      }
+
+      int     layout = (this->col_major ? LAPACK_COL_MAJOR : LAPACK_ROW_MAJOR);
+      MKL_INT ld = (this->col_major ? this->n_rows : this->n);
+      T*      tau = new T[this->n];
+      MKL_INT ret = mkl::geqrf(layout, this->n_rows, this->n, work, ld, tau);
+      if (ret != 0) {
+        GLOG_FATAL("geqrf failed with ret=", ret);
+      }
+      for (MKL_INT i = 0; i < this->n; i++) {
+        for (MKL_INT j = 0; j < this->n; j++) {
+          T v = (this->col_major ? work[j * ld + i] : work[i * ld + j]);
+          this->r[i * this->n + j] = (j >= i ? v : 0);
+        }
+      }
+      if (this->write_q) {
+        ret = mkl::orgqr(layout, this->n_rows, this->n, this->n, work, ld, tau);
+        if (ret != 0) {
+          GLOG_FATAL("orgqr failed with ret=", ret);
+        }
+      } else {
+        delete[] work;
+      }
+      delete[] tau;
+    }
+
+    FBLAS_UINT size() {
+      return (2 * this->n_rows * this->n + this->n) * sizeof(T);
+    }
+  };
+
+  // QR of the stacked R factors of `rs.size()` children, in memory
+  // * frees the children's R & writes the stacked R's QR into `r`
+  // * if `q` is not null, writes the explicit `(rs.size() * n) x n` Q to it
+  template<typename T>
+  class TsqrTreeTask : public BaseTask {
+    typedef MklTraits<T> mkl;
+
+    std::vector<T*> rs;
+    MKL_INT         n;
+    T *             r, *q;
+
+   public:
+    TsqrTreeTask(const std::vector<T*>& rs, FBLAS_UINT n, T* r, T* q) {
+      this->rs = rs;
+      this->n = n;
+      this->r = r;
+      this->q = q;
+    }
+
+    void execute() {
+      mkl_set_num_threads_local(task_threads(GEMM_MKL_NTHREADS));
+      MKL_INT n_rows = this->rs.size() * this->n;
+      MKL_INT blk = this->n * this->n;
+      T*      work = (this->q != nullptr ? this->q : new T[n_rows * n]);
+      for (FBLAS_UINT c = 0; c < this->rs.size(); c++) {
+        memcpy(work + c * blk, this->rs[c], blk * sizeof(T));
+        delete[] this->rs[c];
+      }
+
+      T*      tau = new T[this->n];
+      MKL_INT ret =
+          mkl::geqrf(LAPACK_ROW_MAJOR, n_rows, this->n, work, this->n, tau);
+      if (ret != 0) {
+        GLOG_FATAL("geqrf failed with ret=", ret);
+      }
+      for (MKL_INT i = 0; i < this->n; i++) {
+        for (MKL_INT j = 0; j < this->n; j++) {
+          this->r[i * this->n + j] = (j >= i ? work[i * this->n + j] : 0);
+        }
+      }
+      if (this->q != nullptr) {
+        ret = mkl::orgqr(LAPACK_ROW_MAJOR, n_rows, this->n, this->n, work,
+                         this->n, tau);
+        if (ret != 0) {
+          GLOG_FATAL("orgqr failed with ret=", ret);
+        }
+      } else {
+        delete[] work;
+      }
+      delete[] tau;
+    }
+
+    FBLAS_UINT size() {
+      return (this->rs.size() + 1) * this->n * this->n * sizeof(T);
+    }
+  };
+
+  // Q_p = Q_p * W for one `n_rows x n` row panel of Q on flash, where `W`
+  // folds the tree's Q blocks from the panel's leaf up to the root
+  template<typename T>
+  class TsqrApplyTask : public BaseTask {
+    typedef MklTraits<T> mkl;
+
+    flash_ptr<T> q;
+    MKL_INT      n_rows, n;
+    bool         col_major;
+    T*           w;
+
+   public:
+    TsqrApplyTask(flash_ptr<T> q, StrideInfo sinfo, FBLAS_UINT n_rows,
+                  FBLAS_UINT n, bool col_major, T* w) {
+      this->q = q;
+      this->n_rows = n_rows;
+      this->n = n;
+      this->col_major = col_major;
+      this->w = w;
+      this->add_read(this->q, sinfo);
+      this->add_write(this->q, sinfo);
+    }
+
+    void execute() {
+      mkl_set_num_threads_local(task_threads(GEMM_MKL_NTHREADS));
+      T* q_ptr = (T*) in_mem_ptrs[this->q];
+      GLOG_ASSERT(q_ptr != nullptr, "null q_ptr");
+      FBLAS_UINT len = this->n_rows * this->n;
+      T*         tmp = new T[len];
+      memcpy(tmp, q_ptr, len * sizeof(T));
+      if (this->col_major) {
+        // row-major `W` is column-major `W^T`
+        mkl::gemm(CblasColMajor, CblasNoTrans, CblasTrans, this->n_rows,
+                  this->n, this->n, 1.0f, tmp, this->n_rows, this->w, this->n,
+                  0.0f, q_ptr, this->n_rows);
+      } else {
+        mkl::gemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, this->n_rows,
+                  this->n, this->n, 1.0f, tmp, this->n, this->w, this->n, 0.0f,
+                  q_ptr, this->n);
+      }
+      delete[] tmp;
+    }
+
+    FBLAS_UINT size() {
+      return (2 * this->n_rows + this->n) * this->n * sizeof(T);
+    }
+  };
+}  // namespace flash
@@ -29,10 +29,11 @@ namespace flash {
   // expect a scheduler to be defined in some compile unit
   extern Scheduler sched;
 
+  template<typename T>
   FBLAS_INT csrcsc(FBLAS_UINT m, FBLAS_UINT n, flash_ptr<MKL_INT> ia,
-                   flash_ptr<MKL_INT> ja, flash_ptr<FPTYPE> a,
+                   flash_ptr<MKL_INT> ja, flash_ptr<T> a,
                    flash_ptr<MKL_INT> ia_tr, flash_ptr<MKL_INT> ja_tr,
-                   flash_ptr<FPTYPE> a_tr) {
+                   flash_ptr<T> a_tr) {
     // first read `ia` into memory
     MKL_INT *ia_ptr = new MKL_INT[m + 1];
     flash::read_sync(ia_ptr, ia, m + 1);
@@ -46,9 +47,10 @@ namespace flash {
 
     FBLAS_UINT n_rblks = rblk_sizes.size();
 
-    std::vector<SparseBlock> A_rblks(n_rblks);
-    std::vector<SparseBlock> A_tr_cblks(n_rblks);
-    BlockCsrCscTask **       transpose_tasks = new BlockCsrCscTask *[n_rblks];
+    std::vector<SparseBlock<T>> A_rblks(n_rblks);
+    std::vector<SparseBlock<T>> A_tr_cblks(n_rblks);
+    BlockCsrCscTask<T> **       transpose_tasks =
+        new BlockCsrCscTask<T> *[n_rblks];
     for (FBLAS_UINT i = 0; i < n_rblks; i++) {
       FBLAS_UINT rstart = rblk_offsets[i];
       FBLAS_UINT rend = rblk_offsets[i] + rblk_sizes[i];
@@ -65,14 +67,14 @@ namespace flash {
       A_tr_cblks[i].idxs_fptr =
           flash_malloc<MKL_INT>(blk_nnzs * sizeof(MKL_INT),
                                 std::string("blk_ja-") + std::to_string(i));
-      A_tr_cblks[i].vals_fptr = flash_malloc<FPTYPE>(
-          blk_nnzs * sizeof(FPTYPE), std::string("blk_a-") + std::to_string(i));
+      A_tr_cblks[i].vals_fptr = flash_malloc<T>(
+          blk_nnzs * sizeof(T), std::string("blk_a-") + std::to_string(i));
       A_tr_cblks[i].nrows = n;
       A_tr_cblks[i].ncols = m;
       A_tr_cblks[i].start = 0;
       A_tr_cblks[i].blk_size = n;
 
-      transpose_tasks[i] = new BlockCsrCscTask(A_rblks[i], A_tr_cblks[i]);
+      transpose_tasks[i] = new BlockCsrCscTask<T>(A_rblks[i], A_tr_cblks[i]);
       sched.add_task(transpose_tasks[i]);
     }
 
@@ -104,13 +106,13 @@ namespace flash {
     FBLAS_UINT n_cblks = cblk_sizes.size();
     GLOG_DEBUG("Using n_cblks=", n_cblks);
 
-    BlockMergeTask **merge_tasks = new BlockMergeTask *[n_cblks];
+    BlockMergeTask<T> **merge_tasks = new BlockMergeTask<T> *[n_cblks];
     // collect block offset information
     for (FBLAS_UINT j = 0; j < n_cblks; j++) {
       FBLAS_UINT cstart = cblk_offsets[j];
       FBLAS_UINT cblk_size = cblk_sizes[j];
 
-      SparseBlock A_tr_rblk;
+      SparseBlock<T> A_tr_rblk;
       A_tr_rblk.offs = ia_tr_ptr + cstart;
       A_tr_rblk.idxs_fptr = ja_tr + *A_tr_rblk.offs;
       A_tr_rblk.vals_fptr = a_tr + *A_tr_rblk.offs;
@@ -119,10 +121,10 @@ namespace flash {
       A_tr_rblk.nrows = n;
       A_tr_rblk.ncols = m;
 
-      std::vector<SparseBlock> A_tr_rblks;
+      std::vector<SparseBlock<T>> A_tr_rblks;
       for (FBLAS_UINT i = 0; i < n_rblks; i++) {
-        SparseBlock &cblk = A_tr_cblks[i];
-        SparseBlock  rblk;
+        SparseBlock<T> &cblk = A_tr_cblks[i];
+        SparseBlock<T>  rblk;
         rblk.offs = cblk.offs + cstart;
         rblk.idxs_fptr = cblk.idxs_fptr + *rblk.offs;
         rblk.vals_fptr = cblk.vals_fptr + *rblk.offs;
@@ -133,7 +135,7 @@ namespace flash {
         A_tr_rblks.push_back(rblk);
       }
 
-      merge_tasks[j] = new BlockMergeTask(A_tr_rblk, A_tr_rblks);
+      merge_tasks[j] = new BlockMergeTask<T>(A_tr_rblk, A_tr_rblks);
       sched.add_task(merge_tasks[j]);
     }
 
@@ -158,4 +160,20 @@ namespace flash {
     return 0;
   }
 
+  template FBLAS_INT csrcsc<float>(FBLAS_UINT, FBLAS_UINT, flash_ptr<MKL_INT>,
+                                   flash_ptr<MKL_INT>, flash_ptr<float>,
+                                   flash_ptr<MKL_INT>, flash_ptr<MKL_INT>,
+                                   flash_ptr<float>);
+  template FBLAS_INT csrcsc<double>(FBLAS_UINT, FBLAS_UINT, flash_ptr<MKL_INT>,
+                                    flash_ptr<MKL_INT>, flash_ptr<double>,
+                                    flash_ptr<MKL_INT>, flash_ptr<MKL_INT>,
+                                    flash_ptr<double>);
+  template FBLAS_INT csrcsc<fp16_t>(FBLAS_UINT, FBLAS_UINT, flash_ptr<MKL_INT>,
+                                    flash_ptr<MKL_INT>, flash_ptr<fp16_t>,
+                                    flash_ptr<MKL_INT>, flash_ptr<MKL_INT>,
+                                    flash_ptr<fp16_t>);
+  template FBLAS_INT csrcsc<bf16_t>(FBLAS_UINT, FBLAS_UINT, flash_ptr<MKL_INT>,
+                                    flash_ptr<MKL_INT>, flash_ptr<bf16_t>,
+                                    flash_ptr<MKL_INT>, flash_ptr<MKL_INT>,
+                                    flash_ptr<bf16_t>);
 }  // namespace flash
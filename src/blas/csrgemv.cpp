@@ -11,28 +11,29 @@ namespace flash {
 
 namespace {
   using namespace flash;
-  void csrgemv_notrans_inmem(FBLAS_UINT m, FBLAS_UINT n, flash_ptr<FPTYPE> a,
-                             MKL_INT* ia, flash_ptr<MKL_INT> ja, FPTYPE* b,
-                             FPTYPE* c) {
+  // `a` is stored as `S`, & computed on as `T`
+  template<typename T, typename S>
+  void csrgemv_notrans_inmem(FBLAS_UINT m, FBLAS_UINT n, flash_ptr<S> a,
+                             MKL_INT* ia, flash_ptr<MKL_INT> ja, T* b, T* c) {
     std::vector<FBLAS_UINT> blks;
     std::vector<FBLAS_UINT> offs;
     FBLAS_UINT              cur_start = 0;
     for (; cur_start < m;) {
       FBLAS_UINT cblk_size =
           get_next_blk_size(ia + cur_start, m - cur_start,
-                            SECTOR_LEN / sizeof(FPTYPE), CSRMM_RM_RBLK_SIZE);
+                            SECTOR_LEN / sizeof(T), CSRMM_RM_RBLK_SIZE);
       blks.push_back(cblk_size);
       offs.push_back(cur_start);
       cur_start += cblk_size;
       GLOG_DEBUG("choosing blk_size=", cblk_size);
     }
     FBLAS_UINT n_blks = blks.size();
-    auto**     tasks = new CsrGemvNoTransInMem*[n_blks];
+    auto**     tasks = new CsrGemvNoTransInMem<T, S>*[n_blks];
     for (FBLAS_UINT i = 0; i < n_blks; i++) {
       FBLAS_UINT start_row = offs[i];
       FBLAS_UINT rblk_size = blks[i];
-      tasks[i] =
-          new CsrGemvNoTransInMem(start_row, m, n, rblk_size, ia, ja, a, b, c);
+      tasks[i] = new CsrGemvNoTransInMem<T, S>(start_row, m, n, rblk_size, ia,
+                                               ja, a, b, c);
       sched.add_task(tasks[i]);
     }
 
@@ -43,9 +44,9 @@ namespace {
     delete[] tasks;
   }
 
-  void csrgemv_trans_inmem(FBLAS_UINT m, FBLAS_UINT n, flash_ptr<FPTYPE> a,
-                           MKL_INT* ia, flash_ptr<MKL_INT> ja, FPTYPE* b,
-                           FPTYPE* c) {
+  template<typename T, typename S>
+  void csrgemv_trans_inmem(FBLAS_UINT m, FBLAS_UINT n, flash_ptr<S> a,
+                           MKL_INT* ia, flash_ptr<MKL_INT> ja, T* b, T* c) {
     // mutex to synchronize access to `c` vector
     std::mutex              sync_mut;
     std::vector<FBLAS_UINT> blks;
@@ -54,20 +55,20 @@ namespace {
     for (; cur_start < m;) {
       FBLAS_UINT cblk_size =
           get_next_blk_size(ia + cur_start, m - cur_start,
-                            SECTOR_LEN / sizeof(FPTYPE), CSRMM_RM_RBLK_SIZE);
+                            SECTOR_LEN / sizeof(T), CSRMM_RM_RBLK_SIZE);
       blks.push_back(cblk_size);
       offs.push_back(cur_start);
       cur_start += cblk_size;
       GLOG_DEBUG("choosing blk_size=", cblk_size);
     }
     FBLAS_UINT n_blks = blks.size();
-    memset(c, 0, n * sizeof(FPTYPE));
-    auto** tasks = new CsrGemvTransInMem*[n_blks];
+    memset(c, 0, n * sizeof(T));
+    auto** tasks = new CsrGemvTransInMem<T, S>*[n_blks];
     for (FBLAS_UINT i = 0; i < n_blks; i++) {
       FBLAS_UINT start_row = offs[i];
       FBLAS_UINT rblk_size = blks[i];
-      tasks[i] = new CsrGemvTransInMem(start_row, m, n, rblk_size, ia, ja, a, b,
-                                       c, sync_mut);
+      tasks[i] = new CsrGemvTransInMem<T, S>(start_row, m, n, rblk_size, ia,
+                                             ja, a, b, c, sync_mut);
       sched.add_task(tasks[i]);
     }
     sleep_wait_for_complete(tasks, n_blks);
@@ -79,9 +80,10 @@ namespace {
 }  // namespace
 
 namespace flash {
-  FBLAS_INT csrgemv(CHAR trans_a, FBLAS_UINT m, FBLAS_UINT n,
-                    flash_ptr<FPTYPE> a, flash_ptr<MKL_INT> ia,
-                    flash_ptr<MKL_INT> ja, FPTYPE* b, FPTYPE* c) {
+  template<typename T>
+  FBLAS_INT csrgemv(CHAR trans_a, FBLAS_UINT m, FBLAS_UINT n, flash_ptr<T> a,
+                    flash_ptr<MKL_INT> ia, flash_ptr<MKL_INT> ja,
+                    compute_t<T>* b, compute_t<T>* c) {
     auto* ia_ptr = new MKL_INT[m + 1];
     ia.fop->read(ia.foffset, (m + 1) * sizeof(MKL_INT), ia_ptr,
                  flash::dummy_std_func);
@@ -95,4 +97,17 @@ namespace flash {
     delete[] ia_ptr;
     return 0;
   }
-}  // namespace flash
\ No newline at end of file
+
+  template FBLAS_INT csrgemv<float>(CHAR, FBLAS_UINT, FBLAS_UINT,
+                                    flash_ptr<float>, flash_ptr<MKL_INT>,
+                                    flash_ptr<MKL_INT>, float*, float*);
+  template FBLAS_INT csrgemv<double>(CHAR, FBLAS_UINT, FBLAS_UINT,
+                                     flash_ptr<double>, flash_ptr<MKL_INT>,
+                                     flash_ptr<MKL_INT>, double*, double*);
+  template FBLAS_INT csrgemv<fp16_t>(CHAR, FBLAS_UINT, FBLAS_UINT,
+                                     flash_ptr<fp16_t>, flash_ptr<MKL_INT>,
+                                     flash_ptr<MKL_INT>, float*, float*);
+  template FBLAS_INT csrgemv<bf16_t>(CHAR, FBLAS_UINT, FBLAS_UINT,
+                                     flash_ptr<bf16_t>, flash_ptr<MKL_INT>,
+                                     flash_ptr<MKL_INT>, float*, float*);
+}  // namespace flash
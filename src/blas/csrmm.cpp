@@ -12,10 +12,12 @@ namespace flash {
 
 namespace {
   using namespace flash;
-  void csrmm_no_trans_rm(FBLAS_UINT m, FBLAS_UINT n, FBLAS_UINT k, FPTYPE alpha,
-                         FPTYPE beta, flash_ptr<FPTYPE> a,
-                         flash_ptr<MKL_INT> ia, flash_ptr<MKL_INT> ja,
-                         flash_ptr<FPTYPE> b, flash_ptr<FPTYPE> c) {
+  // `a` is stored as `S`, & computed on as `T`
+  template<typename T, typename S>
+  void csrmm_no_trans_rm(FBLAS_UINT m, FBLAS_UINT n, FBLAS_UINT k, T alpha,
+                         T beta, flash_ptr<S> a, flash_ptr<MKL_INT> ia,
+                         flash_ptr<MKL_INT> ja, flash_ptr<T> b,
+                         flash_ptr<T> c) {
     // read `ia` into buffer
     MKL_INT *ia_ptr = new MKL_INT[m + 1];
     ia.fop->read(ia.foffset, (m + 1) * sizeof(MKL_INT), (void *) ia_ptr,
@@ -26,23 +28,24 @@ namespace {
     for (; cur_start < m;) {
       FBLAS_UINT cblk_size =
           get_next_blk_size(ia_ptr + cur_start, m - cur_start,
-                            SECTOR_LEN / sizeof(FPTYPE), CSRMM_RM_RBLK_SIZE);
+                            SECTOR_LEN / sizeof(T), CSRMM_RM_RBLK_SIZE);
       blks.push_back(cblk_size);
       offs.push_back(cur_start);
       cur_start += cblk_size;
       GLOG_DEBUG("choosing blk_size=", cblk_size);
     }
-    FBLAS_UINT    col_blk_size = CSRMM_RM_CBLK_SIZE;
-    FBLAS_UINT    n_row_blks = blks.size();
-    FBLAS_UINT    n_col_blks = ROUND_UP(k, col_blk_size) / col_blk_size;
-    CsrmmRmTask **csr_tasks = new CsrmmRmTask *[n_row_blks * n_col_blks];
+    FBLAS_UINT          col_blk_size = CSRMM_RM_CBLK_SIZE;
+    FBLAS_UINT          n_row_blks = blks.size();
+    FBLAS_UINT          n_col_blks = ROUND_UP(k, col_blk_size) / col_blk_size;
+    CsrmmRmTask<T, S> **csr_tasks =
+        new CsrmmRmTask<T, S> *[n_row_blks * n_col_blks];
 
     // iterate over row blocks
     for (FBLAS_UINT i = 0; i < n_row_blks; i++) {
       FBLAS_UINT start_row = offs[i];
       FBLAS_UINT rblk_size = blks[i];
       for (FBLAS_UINT j = 0; j < n_col_blks; j++) {
-        csr_tasks[i * n_col_blks + j] = new CsrmmRmTask(
+        csr_tasks[i * n_col_blks + j] = new CsrmmRmTask<T, S>(
             start_row, j * col_blk_size, rblk_size, col_blk_size, m, n, k,
             ia_ptr, ja, a, b, c, alpha, beta);
         sched.add_task(csr_tasks[i * n_col_blks + j]);
@@ -61,10 +64,11 @@ namespace {
     sched.flush_cache();
   }
 
-  void csrmm_no_trans_rm2(FBLAS_UINT m, FBLAS_UINT n, FBLAS_UINT k,
-                          FPTYPE alpha, FPTYPE beta, flash_ptr<FPTYPE> a,
-                          flash_ptr<MKL_INT> ia, flash_ptr<MKL_INT> ja,
-                          flash_ptr<FPTYPE> b, flash_ptr<FPTYPE> c) {
+  template<typename T, typename S>
+  void csrmm_no_trans_rm2(FBLAS_UINT m, FBLAS_UINT n, FBLAS_UINT k, T alpha,
+                          T beta, flash_ptr<S> a, flash_ptr<MKL_INT> ia,
+                          flash_ptr<MKL_INT> ja, flash_ptr<T> b,
+                          flash_ptr<T> c) {
     // read `ia` into buffer
     MKL_INT *ia_ptr = new MKL_INT[m + 1];
     ia.fop->read(ia.foffset, (m + 1) * sizeof(MKL_INT), (void *) ia_ptr,
@@ -73,15 +77,16 @@ namespace {
     std::vector<FBLAS_UINT> blks;
     std::vector<FBLAS_UINT> offs;
 
-    fill_blocks(ia_ptr, m, blks, offs, SECTOR_LEN / sizeof(FPTYPE),
+    fill_blocks(ia_ptr, m, blks, offs, SECTOR_LEN / sizeof(T),
                 CSRMM_RM_RBLK_SIZE);
 
-    FBLAS_UINT          col_blk_size = CSRMM_RM_CBLK_SIZE;
-    FBLAS_UINT          n_row_blks = blks.size();
-    FBLAS_UINT          n_col_blks = ROUND_UP(k, col_blk_size) / col_blk_size;
-    SimpleCsrmmRmTask **csr_tasks =
-        new SimpleCsrmmRmTask *[n_row_blks * n_col_blks];
-    std::vector<SparseBlock> row_blks;
+    FBLAS_UINT                col_blk_size = CSRMM_RM_CBLK_SIZE;
+    FBLAS_UINT                n_row_blks = blks.size();
+    FBLAS_UINT                n_col_blks =
+        ROUND_UP(k, col_blk_size) / col_blk_size;
+    SimpleCsrmmRmTask<T, S> **csr_tasks =
+        new SimpleCsrmmRmTask<T, S> *[n_row_blks * n_col_blks];
+    std::vector<SparseBlock<S>> row_blks;
 
     // iterate over row blocks
     for (FBLAS_UINT i = 0; i < n_row_blks; i++) {
@@ -89,7 +94,7 @@ namespace {
       FBLAS_UINT rblk_size = blks[i];
 
       // construct row-block
-      SparseBlock A_blk;
+      SparseBlock<S> A_blk;
       A_blk.nrows = m;
       A_blk.ncols = n;
       A_blk.start = start_row;
@@ -104,7 +109,7 @@ namespace {
 
       // construct one task for each col-block
       for (FBLAS_UINT j = 0; j < n_col_blks; j++) {
-        csr_tasks[i * n_col_blks + j] = new SimpleCsrmmRmTask(
+        csr_tasks[i * n_col_blks + j] = new SimpleCsrmmRmTask<T, S>(
             A_blk, b, c, j * col_blk_size, col_blk_size, k, alpha, beta);
         sched.add_task(csr_tasks[i * n_col_blks + j]);
       }
@@ -125,10 +130,11 @@ namespace {
     sched.flush_cache();
   }
 
-  void csrmm_no_trans_cm(FBLAS_UINT m, FBLAS_UINT n, FBLAS_UINT k, FPTYPE alpha,
-                         FPTYPE beta, flash_ptr<FPTYPE> a,
-                         flash_ptr<MKL_INT> ia, flash_ptr<MKL_INT> ja,
-                         flash_ptr<FPTYPE> b, flash_ptr<FPTYPE> c) {
+  template<typename T, typename S>
+  void csrmm_no_trans_cm(FBLAS_UINT m, FBLAS_UINT n, FBLAS_UINT k, T alpha,
+                         T beta, flash_ptr<S> a, flash_ptr<MKL_INT> ia,
+                         flash_ptr<MKL_INT> ja, flash_ptr<T> b,
+                         flash_ptr<T> c) {
     // read `ia` into buffer
     MKL_INT *ia_ptr = new MKL_INT[m + 1];
     ia.fop->read(ia.foffset, (m + 1) * sizeof(MKL_INT), (void *) ia_ptr,
@@ -139,23 +145,24 @@ namespace {
     for (; cur_start < m;) {
       FBLAS_UINT cblk_size =
           get_next_blk_size(ia_ptr + cur_start, m - cur_start,
-                            SECTOR_LEN / sizeof(FPTYPE), CSRMM_CM_RBLK_SIZE);
+                            SECTOR_LEN / sizeof(T), CSRMM_CM_RBLK_SIZE);
       blks.push_back(cblk_size);
       offs.push_back(cur_start);
       cur_start += cblk_size;
       GLOG_DEBUG("choosing blk_size=", cblk_size);
     }
-    FBLAS_UINT    n_row_blks = blks.size();
-    FBLAS_UINT    col_blk_size = CSRMM_CM_CBLK_SIZE;
-    FBLAS_UINT    n_col_blks = ROUND_UP(k, col_blk_size) / col_blk_size;
-    CsrmmCmTask **csr_tasks = new CsrmmCmTask *[blks.size() * n_col_blks];
+    FBLAS_UINT          n_row_blks = blks.size();
+    FBLAS_UINT          col_blk_size = CSRMM_CM_CBLK_SIZE;
+    FBLAS_UINT          n_col_blks = ROUND_UP(k, col_blk_size) / col_blk_size;
+    CsrmmCmTask<T, S> **csr_tasks =
+        new CsrmmCmTask<T, S> *[blks.size() * n_col_blks];
 
     // iterate over row blocks
     for (FBLAS_UINT i = 0; i < n_row_blks; i++) {
       FBLAS_UINT start_row = offs[i];
       FBLAS_UINT rblk_size = blks[i];
       for (FBLAS_UINT j = 0; j < n_col_blks; j++) {
-        csr_tasks[i * n_col_blks + j] = new CsrmmCmTask(
+        csr_tasks[i * n_col_blks + j] = new CsrmmCmTask<T, S>(
             start_row, j * col_blk_size, rblk_size, col_blk_size, m, n, k,
             ia_ptr, ja, a, b, c, alpha, beta);
         sched.add_task(csr_tasks[i * n_col_blks + j]);
@@ -200,10 +207,11 @@ namespace {
     sched.flush_cache();
   }
 
-  void csrmm_no_trans_cm2(FBLAS_UINT m, FBLAS_UINT n, FBLAS_UINT k,
-                          FPTYPE alpha, FPTYPE beta, flash_ptr<FPTYPE> a,
-                          flash_ptr<MKL_INT> ia, flash_ptr<MKL_INT> ja,
-                          flash_ptr<FPTYPE> b, flash_ptr<FPTYPE> c) {
+  template<typename T, typename S>
+  void csrmm_no_trans_cm2(FBLAS_UINT m, FBLAS_UINT n, FBLAS_UINT k, T alpha,
+                          T beta, flash_ptr<S> a, flash_ptr<MKL_INT> ia,
+                          flash_ptr<MKL_INT> ja, flash_ptr<T> b,
+                          flash_ptr<T> c) {
     // read `ia` into buffer
     MKL_INT *ia_ptr = new MKL_INT[m + 1];
     ia.fop->read(ia.foffset, (m + 1) * sizeof(MKL_INT), (void *) ia_ptr,
@@ -212,15 +220,16 @@ namespace {
     std::vector<FBLAS_UINT> blks;
     std::vector<FBLAS_UINT> offs;
 
-    fill_blocks(ia_ptr, m, blks, offs, SECTOR_LEN / sizeof(FPTYPE),
+    fill_blocks(ia_ptr, m, blks, offs, SECTOR_LEN / sizeof(T),
                 CSRMM_CM_RBLK_SIZE);
 
-    FBLAS_UINT          col_blk_size = CSRMM_CM_CBLK_SIZE;
-    FBLAS_UINT          n_row_blks = blks.size();
-    FBLAS_UINT          n_col_blks = ROUND_UP(k, col_blk_size) / col_blk_size;
-    SimpleCsrmmCmTask **csr_tasks =
-        new SimpleCsrmmCmTask *[n_row_blks * n_col_blks];
-    std::vector<SparseBlock> row_blks;
+    FBLAS_UINT                col_blk_size = CSRMM_CM_CBLK_SIZE;
+    FBLAS_UINT                n_row_blks = blks.size();
+    FBLAS_UINT                n_col_blks =
+        ROUND_UP(k, col_blk_size) / col_blk_size;
+    SimpleCsrmmCmTask<T, S> **csr_tasks =
+        new SimpleCsrmmCmTask<T, S> *[n_row_blks * n_col_blks];
+    std::vector<SparseBlock<S>> row_blks;
 
     // iterate over row blocks
     for (FBLAS_UINT i = 0; i < n_row_blks; i++) {
@@ -228,7 +237,7 @@ namespace {
       FBLAS_UINT rblk_size = blks[i];
 
       // construct row-block
-      SparseBlock A_blk;
+      SparseBlock<S> A_blk;
       A_blk.nrows = m;
       A_blk.ncols = n;
       A_blk.start = start_row;
@@ -244,7 +253,7 @@ namespace {
 
       // construct one task for each col-block
       for (FBLAS_UINT j = 0; j < n_col_blks; j++) {
-        csr_tasks[i * n_col_blks + j] = new SimpleCsrmmCmTask(
+        csr_tasks[i * n_col_blks + j] = new SimpleCsrmmCmTask<T, S>(
             A_blk, b, c, j * col_blk_size, col_blk_size, k, alpha, beta);
         sched.add_task(csr_tasks[i * n_col_blks + j]);
       }
@@ -265,10 +274,10 @@ namespace {
     sched.flush_cache();
   }
 
-  void csrmm_no_trans_cm_im(FBLAS_UINT m, FBLAS_UINT n, FBLAS_UINT k,
-                            FPTYPE alpha, FPTYPE beta, flash_ptr<FPTYPE> a,
-                            flash_ptr<MKL_INT> ia, flash_ptr<MKL_INT> ja,
-                            FPTYPE *b, FPTYPE *c) {
+  template<typename T, typename S>
+  void csrmm_no_trans_cm_im(FBLAS_UINT m, FBLAS_UINT n, FBLAS_UINT k, T alpha,
+                            T beta, flash_ptr<S> a, flash_ptr<MKL_INT> ia,
+                            flash_ptr<MKL_INT> ja, T *b, T *c) {
     // read `ia` into buffer
     MKL_INT *ia_ptr = new MKL_INT[m + 1];
     ia.fop->read(ia.foffset, (m + 1) * sizeof(MKL_INT), (void *) ia_ptr,
@@ -279,17 +288,18 @@ namespace {
     for (; cur_start < m;) {
       FBLAS_UINT cblk_size =
           get_next_blk_size(ia_ptr + cur_start, m - cur_start,
-                            SECTOR_LEN / sizeof(FPTYPE), CSRMM_RM_RBLK_SIZE);
+                            SECTOR_LEN / sizeof(T), CSRMM_RM_RBLK_SIZE);
       blks.push_back(cblk_size);
       offs.push_back(cur_start);
       cur_start += cblk_size;
       GLOG_DEBUG("choosing blk_size=", cblk_size);
     }
-    FBLAS_UINT         n_row_blks = blks.size();
-    FBLAS_UINT         col_blk_size = CSRMM_CM_CBLK_SIZE;
-    FBLAS_UINT         n_col_blks = ROUND_UP(k, col_blk_size) / col_blk_size;
-    CsrmmCmInMemTask **csr_tasks =
-        new CsrmmCmInMemTask *[n_row_blks * n_col_blks];
+    FBLAS_UINT               n_row_blks = blks.size();
+    FBLAS_UINT               col_blk_size = CSRMM_CM_CBLK_SIZE;
+    FBLAS_UINT               n_col_blks =
+        ROUND_UP(k, col_blk_size) / col_blk_size;
+    CsrmmCmInMemTask<T, S> **csr_tasks =
+        new CsrmmCmInMemTask<T, S> *[n_row_blks * n_col_blks];
 
     // iterate over row blocks
     for (FBLAS_UINT l = 0; l < n_row_blks * n_col_blks; l++) {
@@ -297,9 +307,9 @@ namespace {
       FBLAS_UINT col_idx = (l / n_row_blks);
       FBLAS_UINT start_row = offs[row_idx];
       FBLAS_UINT rblk_size = blks[row_idx];
-      csr_tasks[l] = new CsrmmCmInMemTask(start_row, col_idx * col_blk_size,
-                                          rblk_size, col_blk_size, m, n, k,
-                                          ia_ptr, ja, a, b, c, alpha, beta);
+      csr_tasks[l] = new CsrmmCmInMemTask<T, S>(
+          start_row, col_idx * col_blk_size, rblk_size, col_blk_size, m, n, k,
+          ia_ptr, ja, a, b, c, alpha, beta);
       sched.add_task(csr_tasks[l]);
     }
     // sync and cleanup
@@ -311,10 +321,10 @@ namespace {
     delete[] ia_ptr;
   }
 
-  void csrmm_no_trans_rm_im(FBLAS_UINT m, FBLAS_UINT n, FBLAS_UINT k,
-                            FPTYPE alpha, FPTYPE beta, flash_ptr<FPTYPE> a,
-                            flash_ptr<MKL_INT> ia, flash_ptr<MKL_INT> ja,
-                            FPTYPE *b, FPTYPE *c) {
+  template<typename T, typename S>
+  void csrmm_no_trans_rm_im(FBLAS_UINT m, FBLAS_UINT n, FBLAS_UINT k, T alpha,
+                            T beta, flash_ptr<S> a, flash_ptr<MKL_INT> ia,
+                            flash_ptr<MKL_INT> ja, T *b, T *c) {
     // read `ia` into buffer
     MKL_INT *ia_ptr = new MKL_INT[m + 1];
     ia.fop->read(ia.foffset, (m + 1) * sizeof(MKL_INT), (void *) ia_ptr,
@@ -325,24 +335,25 @@ namespace {
     for (; cur_start < m;) {
       FBLAS_UINT cblk_size =
           get_next_blk_size(ia_ptr + cur_start, m - cur_start,
-                            SECTOR_LEN / sizeof(FPTYPE), CSRMM_RM_RBLK_SIZE);
+                            SECTOR_LEN / sizeof(T), CSRMM_RM_RBLK_SIZE);
       blks.push_back(cblk_size);
       offs.push_back(cur_start);
       cur_start += cblk_size;
       GLOG_DEBUG("choosing blk_size=", cblk_size);
     }
-    FBLAS_UINT         n_row_blks = blks.size();
-    FBLAS_UINT         col_blk_size = CSRMM_RM_CBLK_SIZE;
-    FBLAS_UINT         n_col_blks = ROUND_UP(k, col_blk_size) / col_blk_size;
-    CsrmmRmInMemTask **csr_tasks =
-        new CsrmmRmInMemTask *[n_row_blks * n_col_blks];
+    FBLAS_UINT               n_row_blks = blks.size();
+    FBLAS_UINT               col_blk_size = CSRMM_RM_CBLK_SIZE;
+    FBLAS_UINT               n_col_blks =
+        ROUND_UP(k, col_blk_size) / col_blk_size;
+    CsrmmRmInMemTask<T, S> **csr_tasks =
+        new CsrmmRmInMemTask<T, S> *[n_row_blks * n_col_blks];
 
     // iterate over row blocks
     for (FBLAS_UINT i = 0; i < n_row_blks; i++) {
       FBLAS_UINT start_row = offs[i];
       FBLAS_UINT rblk_size = blks[i];
       for (FBLAS_UINT j = 0; j < n_col_blks; j++) {
-        csr_tasks[i * n_col_blks + j] = new CsrmmRmInMemTask(
+        csr_tasks[i * n_col_blks + j] = new CsrmmRmInMemTask<T, S>(
             start_row, j * col_blk_size, rblk_size, col_blk_size, m, n, k,
             ia_ptr, ja, a, b, c, alpha, beta);
         sched.add_task(csr_tasks[i * n_col_blks + j]);
@@ -361,10 +372,10 @@ namespace {
     // retain cache
   }
 
-  void csrmm_trans_rm(FBLAS_UINT m, FBLAS_UINT n, FBLAS_UINT k, FPTYPE alpha,
-                      FPTYPE beta, flash_ptr<FPTYPE> a, flash_ptr<MKL_INT> ia,
-                      flash_ptr<MKL_INT> ja, flash_ptr<FPTYPE> b,
-                      flash_ptr<FPTYPE> c) {
+  template<typename T, typename S>
+  void csrmm_trans_rm(FBLAS_UINT m, FBLAS_UINT n, FBLAS_UINT k, T alpha, T beta,
+                      flash_ptr<S> a, flash_ptr<MKL_INT> ia,
+                      flash_ptr<MKL_INT> ja, flash_ptr<T> b, flash_ptr<T> c) {
     // obtain `nnzs`
     MKL_INT *ia_ptr = new MKL_INT[m + 1];
     ia.fop->read(ia.foffset, (m + 1) * sizeof(MKL_INT), (void *) ia_ptr,
@@ -376,8 +387,7 @@ namespace {
         flash_malloc<MKL_INT>((k + 1) * sizeof(MKL_INT), "ia_tr_temp");
     flash_ptr<MKL_INT> ja_tr =
         flash_malloc<MKL_INT>(nnzs * sizeof(MKL_INT), "ja_tr_temp");
-    flash_ptr<FPTYPE> a_tr =
-        flash_malloc<FPTYPE>((k + 1) * sizeof(MKL_INT), "a_tr_temp");
+    flash_ptr<S> a_tr = flash_malloc<S>((k + 1) * sizeof(MKL_INT), "a_tr_temp");
 
     // run csrcsc
     csrcsc(m, k, ia, ja, a, ia_tr, ja_tr, a_tr);
@@ -390,10 +400,10 @@ namespace {
     flash_free(a_tr);
   }
 
-  void csrmm_trans_cm(FBLAS_UINT m, FBLAS_UINT n, FBLAS_UINT k, FPTYPE alpha,
-                      FPTYPE beta, flash_ptr<FPTYPE> a, flash_ptr<MKL_INT> ia,
-                      flash_ptr<MKL_INT> ja, flash_ptr<FPTYPE> b,
-                      flash_ptr<FPTYPE> c) {
+  template<typename T, typename S>
+  void csrmm_trans_cm(FBLAS_UINT m, FBLAS_UINT n, FBLAS_UINT k, T alpha, T beta,
+                      flash_ptr<S> a, flash_ptr<MKL_INT> ia,
+                      flash_ptr<MKL_INT> ja, flash_ptr<T> b, flash_ptr<T> c) {
     // obtain `nnzs`
     MKL_INT *ia_ptr = new MKL_INT[m + 1];
     ia.fop->read(ia.foffset, (m + 1) * sizeof(MKL_INT), (void *) ia_ptr,
@@ -405,8 +415,7 @@ namespace {
         flash_malloc<MKL_INT>((k + 1) * sizeof(MKL_INT), "ia_tr_temp");
     flash_ptr<MKL_INT> ja_tr =
         flash_malloc<MKL_INT>(nnzs * sizeof(MKL_INT), "ja_tr_temp");
-    flash_ptr<FPTYPE> a_tr =
-        flash_malloc<FPTYPE>((k + 1) * sizeof(MKL_INT), "a_tr_temp");
+    flash_ptr<S> a_tr = flash_malloc<S>((k + 1) * sizeof(MKL_INT), "a_tr_temp");
 
     // run csrcsc
     csrcsc(m, k, ia, ja, a, ia_tr, ja_tr, a_tr);
@@ -421,10 +430,11 @@ namespace {
 }  // namespace
 
 namespace flash {
+  template<typename T>
   FBLAS_INT csrmm(CHAR trans_a, FBLAS_UINT m, FBLAS_UINT n, FBLAS_UINT k,
-                  FPTYPE alpha, FPTYPE beta, flash_ptr<FPTYPE> a,
+                  compute_t<T> alpha, compute_t<T> beta, flash_ptr<T> a,
                   flash_ptr<MKL_INT> ia, flash_ptr<MKL_INT> ja, CHAR ord_b,
-                  flash_ptr<FPTYPE> b, flash_ptr<FPTYPE> c) {
+                  flash_ptr<compute_t<T>> b, flash_ptr<compute_t<T>> c) {
     if (trans_a == 'T') {
       if (ord_b == 'C') {
         csrmm_trans_cm(m, n, k, alpha, beta, a, ia, ja, b, c);
@@ -450,10 +460,11 @@ namespace flash {
     return 0;
   }
 
+  template<typename T>
   FBLAS_INT csrmm(CHAR trans_a, FBLAS_UINT m, FBLAS_UINT n, FBLAS_UINT k,
-                  FPTYPE alpha, FPTYPE beta, flash_ptr<FPTYPE> a,
+                  compute_t<T> alpha, compute_t<T> beta, flash_ptr<T> a,
                   flash_ptr<MKL_INT> ia, flash_ptr<MKL_INT> ja, CHAR ord_b,
-                  FPTYPE *b, FPTYPE *c) {
+                  compute_t<T> *b, compute_t<T> *c) {
     if (trans_a == 'T') {
       GLOG_ERROR("csrmm in mem transpose not implemented");
       return -1;
@@ -470,4 +481,37 @@ namespace flash {
     }
     return 0;
   }
+
+  template FBLAS_INT csrmm<float>(CHAR, FBLAS_UINT, FBLAS_UINT, FBLAS_UINT,
+                                  float, float, flash_ptr<float>,
+                                  flash_ptr<MKL_INT>, flash_ptr<MKL_INT>, CHAR,
+                                  flash_ptr<float>, flash_ptr<float>);
+  template FBLAS_INT csrmm<double>(CHAR, FBLAS_UINT, FBLAS_UINT, FBLAS_UINT,
+                                   double, double, flash_ptr<double>,
+                                   flash_ptr<MKL_INT>, flash_ptr<MKL_INT>, CHAR,
+                                   flash_ptr<double>, flash_ptr<double>);
+  template FBLAS_INT csrmm<fp16_t>(CHAR, FBLAS_UINT, FBLAS_UINT, FBLAS_UINT,
+                                   float, float, flash_ptr<fp16_t>,
+                                   flash_ptr<MKL_INT>, flash_ptr<MKL_INT>, CHAR,
+                                   flash_ptr<float>, flash_ptr<float>);
+  template FBLAS_INT csrmm<bf16_t>(CHAR, FBLAS_UINT, FBLAS_UINT, FBLAS_UINT,
+                                   float, float, flash_ptr<bf16_t>,
+                                   flash_ptr<MKL_INT>, flash_ptr<MKL_INT>, CHAR,
+                                   flash_ptr<float>, flash_ptr<float>);
+  template FBLAS_INT csrmm<float>(CHAR, FBLAS_UINT, FBLAS_UINT, FBLAS_UINT,
+                                  float, float, flash_ptr<float>,
+                                  flash_ptr<MKL_INT>, flash_ptr<MKL_INT>, CHAR,
+                                  float *, float *);
+  template FBLAS_INT csrmm<double>(CHAR, FBLAS_UINT, FBLAS_UINT, FBLAS_UINT,
+                                   double, double, flash_ptr<double>,
+                                   flash_ptr<MKL_INT>, flash_ptr<MKL_INT>, CHAR,
+                                   double *, double *);
+  template FBLAS_INT csrmm<fp16_t>(CHAR, FBLAS_UINT, FBLAS_UINT, FBLAS_UINT,
+                                   float, float, flash_ptr<fp16_t>,
+                                   flash_ptr<MKL_INT>, flash_ptr<MKL_INT>, CHAR,
+                                   float *, float *);
+  template FBLAS_INT csrmm<bf16_t>(CHAR, FBLAS_UINT, FBLAS_UINT, FBLAS_UINT,
+                                   float, float, flash_ptr<bf16_t>,
+                                   flash_ptr<MKL_INT>, flash_ptr<MKL_INT>, CHAR,
+                                   float *, float *);
 }
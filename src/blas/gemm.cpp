@@ -5,6 +5,7 @@
 #include <unistd.h>
 #include <algorithm>
 #include <cassert>
+#include <type_traits>
 #include <vector>
 #include "bof_types.h"
 #include "bof_utils.h"
@@ -21,13 +22,42 @@ using vec2 = vector<vector<T>>;
 template<typename T>
 using vec3 = vector<vec2<T>>;
 
+namespace {
+  // picks the `p x q` C tiles `flash::gemm` completes at a time, for
+  // `nm x nk x nn` tiles of `a_len`, `b_len` & `c_len` bytes
+  // * the group's C tiles & the `p` A tiles, `q` B tiles of one k-step fit
+  //   in `budget` bytes; else `1 x 1`
+  // * minimizes A & B bytes read, `(nm/p)*(nn/q)*nk*(p*a_len + q*b_len)`;
+  //   ties go to larger groups
+  void pick_group(FBLAS_UINT nm, FBLAS_UINT nk, FBLAS_UINT nn, FBLAS_UINT a_len,
+                  FBLAS_UINT b_len, FBLAS_UINT c_len, FBLAS_UINT budget,
+                  FBLAS_UINT &p, FBLAS_UINT &q) {
+    FBLAS_UINT best = 0;
+    p = 1, q = 1;
+    for (FBLAS_UINT cp = 1; cp <= nm; cp++) {
+      for (FBLAS_UINT cq = 1; cq <= nn; cq++) {
+        if (cp * cq * c_len + cp * a_len + cq * b_len > budget)
+          break;
+        FBLAS_UINT n_grps = ((nm + cp - 1) / cp) * ((nn + cq - 1) / cq);
+        FBLAS_UINT cost = n_grps * nk * (cp * a_len + cq * b_len);
+        if (best == 0 || cost < best || (cost == best && cp * cq > p * q)) {
+          best = cost, p = cp, q = cq;
+        }
+      }
+    }
+  }
+}  // namespace
+
 namespace flash {
   extern Scheduler sched;
 
+  template<typename T, typename U>
   FBLAS_INT gemm(CHAR mat_ord, CHAR trans_a, CHAR trans_b, FBLAS_UINT m,
-                 FBLAS_UINT n, FBLAS_UINT k, FPTYPE alpha, FPTYPE beta,
-                 flash_ptr<FPTYPE> a, flash_ptr<FPTYPE> b, flash_ptr<FPTYPE> c,
-                 FBLAS_UINT lda_a, FBLAS_UINT lda_b, FBLAS_UINT lda_c) {
+                 FBLAS_UINT n, FBLAS_UINT k, compute_t<T> alpha,
+                 compute_t<T> beta, flash_ptr<T> a, flash_ptr<T> b,
+                 flash_ptr<U> c, FBLAS_UINT lda_a, FBLAS_UINT lda_b,
+                 FBLAS_UINT lda_c) {
+    typedef GemmTask<compute_t<T>, T, U> Task;
     GLOG_DEBUG("parameters: mat_ord=", mat_ord, ", trans_a=", trans_a,
                ", trans_b=", trans_b, ", m=", m, ", n=", n, ", k=", k,
                ", alpha=", alpha, ", beta=", beta);
@@ -42,6 +72,7 @@ namespace flash {
     bool       swapMat[3] = {false, false, false};
     FBLAS_UINT NUM_B[3], MKN_B[3], ROW[3], COL[3];
     FBLAS_UINT MKN[3] = {m, k, n}, LDA[3] = {lda_a, lda_b, lda_c};
+    FBLAS_UINT ELT_SIZE[3] = {sizeof(T), sizeof(T), sizeof(U)};
 
     for (int i = 0; i < 3; i++) {
       ROW[i] = min(i, (i + 1) % 3), COL[i] = max(i, (i + 1) % 3);
@@ -68,7 +99,7 @@ namespace flash {
 
     for (int i = 0; i < 3; i++) {
       FBLAS_UINT div = (MKN[i] / MKN_B[i]);
-      if (MKN[i] - div * MKN_B[i] < SECTOR_LEN / sizeof(FPTYPE))
+      if (MKN[i] - div * MKN_B[i] < SECTOR_LEN / sizeof(T))
         NUM_B[i] = div;
       else
         NUM_B[i] = div + 1;
@@ -77,8 +108,13 @@ namespace flash {
     GLOG_DEBUG("blocking info: a_nrow_blks=", NUM_B[0],
                ", a_ncol_blks=", NUM_B[1], ", b_ncol_blks=", NUM_B[2]);
 
-    vec3<GemmTask *> tasks(
-        NUM_B[1], vec2<GemmTask *>(NUM_B[0], vector<GemmTask *>(NUM_B[2])));
+    vec3<Task *> tasks(NUM_B[1],
+                       vec2<Task *>(NUM_B[0], vector<Task *>(NUM_B[2])));
+
+    // a 16-bit C is summed over the k-loop in `compute_t<T>`, & narrowed once
+    bool wide_acc = !std::is_same<U, compute_t<T>>::value && NUM_B[1] > 1;
+    vec2<compute_t<T> *> acc(NUM_B[0],
+                             vector<compute_t<T> *>(NUM_B[2], nullptr));
 
     for (FBLAS_UINT l = 0; l < NUM_B[1]; l++) {
       for (FBLAS_UINT i = 0; i < NUM_B[0]; i++) {
@@ -105,20 +141,26 @@ namespace flash {
             FBLAS_UINT n_num = IKJ_NUM[COL[mat]];
 
             stride_info[mat].n_strides = m_num;
-            stride_info[mat].len_per_stride = n_num * sizeof(FPTYPE);
-            stride_info[mat].stride = LDA[mat] * sizeof(FPTYPE);
+            stride_info[mat].len_per_stride = n_num * ELT_SIZE[mat];
+            stride_info[mat].stride = LDA[mat] * ELT_SIZE[mat];
 
             ptr_offset[mat] = m_b * LDA[mat] + n_b;
           }
 
-          if (l > 0)
+          // an accumulated k-chain applies beta once, on its last task
+          if (l > 0 && !wide_acc)
             beta = 1.0;
 
-          tasks[l][i][j] = new GemmTask(
+          tasks[l][i][j] = new Task(
               a, b, c, IKJ_NUM[0], IKJ_NUM[1], IKJ_NUM[2], ptr_offset,
               IKJ_NUM[COL[0]], IKJ_NUM[COL[1]], IKJ_NUM[COL[2]], stride_info,
-              alpha, beta, trans_a, trans_b, mat_ord);
+              alpha, beta, trans_a, trans_b, mat_ord,
+              (wide_acc ? &acc[i][j] : nullptr), l + 1 == NUM_B[1]);
 
+          // C stays cached until the last k-step, & is written once
+          if (!wide_acc && l + 1 < NUM_B[1]) {
+            tasks[l][i][j]->add_pin(c + ptr_offset[2], stride_info[2]);
+          }
           if (l > 0) {
             tasks[l][i][j]->add_parent(tasks[l - 1][i][j]->get_id());
             GLOG_DEBUG("adding dependency:", tasks[l - 1][i][j]->get_id(), "->",
@@ -128,57 +170,44 @@ namespace flash {
       }
     }
 
-    // TODO : change once /blas-on-flash/issues/40 is complete
-    /*
-    for (FBLAS_UINT it = 1; it < NUM_B[0] * NUM_B[2]; it += 2) {
-      if (colMajor) {
-        FBLAS_UINT i = it % NUM_B[0], j = it / NUM_B[0];
-        FBLAS_UINT i_n = (it + 1) % NUM_B[0], j_n = (it + 1) / NUM_B[0];
-        FBLAS_UINT i_p = (it - 1) % NUM_B[0], j_p = (it - 1) / NUM_B[0];
-
-        if (it + 1 < NUM_B[0] * NUM_B[2]) {
-          tasks[0][i][j]->add_parent(tasks[NUM_B[1] - 1][i_n][j_n]->get_id());
-          GLOG_DEBUG("adding dependency:", tasks[0][i_n][j_n]->get_id(), "->",
-                     tasks[NUM_B[1] - 1][i][j]->get_id());
-        }
-        tasks[0][i][j]->add_parent(tasks[NUM_B[1] - 1][i_p][j_p]->get_id());
-        GLOG_DEBUG("adding dependency:", tasks[0][i_p][j_p]->get_id(), "->",
-                   tasks[NUM_B[1] - 1][i][j]->get_id());
-
-      } else {
-        FBLAS_UINT i = it / NUM_B[2], j = it % NUM_B[2];
-        FBLAS_UINT i_n = (it + 1) / NUM_B[2], j_n = (it + 1) % NUM_B[2];
-        FBLAS_UINT i_p = (it - 1) / NUM_B[2], j_p = (it - 1) % NUM_B[2];
-
-        if (it + 1 < NUM_B[0] * NUM_B[2]) {
-          tasks[0][i][j]->add_parent(tasks[NUM_B[1] - 1][i_n][j_n]->get_id());
-          GLOG_DEBUG("adding dependency:", tasks[0][i_n][j_n]->get_id(), "->",
-                     tasks[NUM_B[1] - 1][i][j]->get_id());
-        }
-        tasks[0][i][j]->add_parent(tasks[NUM_B[1] - 1][i_p][j_p]->get_id());
-        GLOG_DEBUG("adding dependency:", tasks[0][i_p][j_p]->get_id(), "->",
-                   tasks[NUM_B[1] - 1][i][j]->get_id());
-      }
-    }
-    if (colMajor) {
-      for (FBLAS_UINT c = 0; c < NUM_B[2]; c++)
-        if (NUM_B[0] != 1 and (NUM_B[0] & 1) != 0)
-          tasks[0][NUM_B[0] - 1][c]->add_parent(
-              tasks[NUM_B[1] - 1][0][c]->get_id());
-    } else {
-      for (FBLAS_UINT r = 0; r < NUM_B[0]; r++)
-        if (NUM_B[2] != 1 and (NUM_B[2] & 1) != 0)
-          tasks[0][r][NUM_B[2] - 1]->add_parent(
-              tasks[NUM_B[1] - 1][r][0]->get_id());
-    }
+    // C tiles are completed a group of `grp[0] x grp[1]` tiles at a time, in
+    // serpentine order over groups; a group's tiles advance k-step by
+    // k-step, in serpentine order, so consecutive tasks share an A or a B
+    // tile & the group's C tiles stay cached across the k-loop
+    // NOTE:: `order` is only a hint to the scheduler; the k-chain of each C
+    // tile is the only dependency
+    FBLAS_UINT grp[2];
+    ::pick_group(NUM_B[0], NUM_B[1], NUM_B[2],
+                 MKN_B[0] * MKN_B[1] * ELT_SIZE[0],
+                 MKN_B[1] * MKN_B[2] * ELT_SIZE[1],
+                 MKN_B[0] * MKN_B[2] *
+                     (wide_acc ? sizeof(compute_t<T>) : ELT_SIZE[2]),
+                 sched.cache_capacity() / 4 * 3, grp[0], grp[1]);
+    GLOG_DEBUG("C tile groups: ", grp[0], "x", grp[1]);
 
-    */
-    for (FBLAS_UINT l = 0; l < NUM_B[1]; l++) {
-      for (FBLAS_UINT i = 0; i < NUM_B[0]; i++) {
-        for (FBLAS_UINT j = 0; j < NUM_B[2]; j++) {
-          GLOG_DEBUG("added task[", l, ", ", i, ", ", j,
-                     "]: addr=", tasks[l][i][j]);
-          sched.add_task(tasks[l][i][j]);
+    FBLAS_UINT n_grps[2] = {(NUM_B[0] + grp[0] - 1) / grp[0],
+                            (NUM_B[2] + grp[1] - 1) / grp[1]};
+    FBLAS_UINT order = 0;
+    for (FBLAS_UINT gi = 0; gi < n_grps[0]; gi++) {
+      for (FBLAS_UINT g = 0; g < n_grps[1]; g++) {
+        FBLAS_UINT gj = (gi % 2 == 0 ? g : n_grps[1] - 1 - g);
+        FBLAS_UINT i_beg = gi * grp[0], i_end = min(NUM_B[0], i_beg + grp[0]);
+        FBLAS_UINT j_beg = gj * grp[1], j_end = min(NUM_B[2], j_beg + grp[1]);
+        // each k-step starts at the C tile the previous one ended on
+        bool i_rev = false, j_rev = false;
+        for (FBLAS_UINT l = 0; l < NUM_B[1]; l++) {
+          for (FBLAS_UINT ii = i_beg; ii < i_end; ii++) {
+            FBLAS_UINT i = (i_rev ? i_beg + i_end - 1 - ii : ii);
+            for (FBLAS_UINT jj = j_beg; jj < j_end; jj++) {
+              FBLAS_UINT j = (j_rev ? j_beg + j_end - 1 - jj : jj);
+              tasks[l][i][j]->set_order(order++);
+              GLOG_DEBUG("added task[", l, ", ", i, ", ", j,
+                         "]: addr=", tasks[l][i][j]);
+              sched.add_task(tasks[l][i][j]);
+            }
+            j_rev = !j_rev;
+          }
+          i_rev = !i_rev;
         }
       }
     }
@@ -200,4 +229,35 @@ namespace flash {
     sched.flush_cache();
     return 0;
   }
+
+  template FBLAS_INT gemm<float, float>(CHAR, CHAR, CHAR, FBLAS_UINT,
+                                        FBLAS_UINT, FBLAS_UINT, float, float,
+                                        flash_ptr<float>, flash_ptr<float>,
+                                        flash_ptr<float>, FBLAS_UINT,
+                                        FBLAS_UINT, FBLAS_UINT);
+  template FBLAS_INT gemm<double, double>(CHAR, CHAR, CHAR, FBLAS_UINT,
+                                          FBLAS_UINT, FBLAS_UINT, double,
+                                          double, flash_ptr<double>,
+                                          flash_ptr<double>, flash_ptr<double>,
+                                          FBLAS_UINT, FBLAS_UINT, FBLAS_UINT);
+  template FBLAS_INT gemm<fp16_t, fp16_t>(CHAR, CHAR, CHAR, FBLAS_UINT,
+                                          FBLAS_UINT, FBLAS_UINT, float, float,
+                                          flash_ptr<fp16_t>, flash_ptr<fp16_t>,
+                                          flash_ptr<fp16_t>, FBLAS_UINT,
+                                          FBLAS_UINT, FBLAS_UINT);
+  template FBLAS_INT gemm<fp16_t, float>(CHAR, CHAR, CHAR, FBLAS_UINT,
+                                         FBLAS_UINT, FBLAS_UINT, float, float,
+                                         flash_ptr<fp16_t>, flash_ptr<fp16_t>,
+                                         flash_ptr<float>, FBLAS_UINT,
+                                         FBLAS_UINT, FBLAS_UINT);
+  template FBLAS_INT gemm<bf16_t, bf16_t>(CHAR, CHAR, CHAR, FBLAS_UINT,
+                                          FBLAS_UINT, FBLAS_UINT, float, float,
+                                          flash_ptr<bf16_t>, flash_ptr<bf16_t>,
+                                          flash_ptr<bf16_t>, FBLAS_UINT,
+                                          FBLAS_UINT, FBLAS_UINT);
+  template FBLAS_INT gemm<bf16_t, float>(CHAR, CHAR, CHAR, FBLAS_UINT,
+                                         FBLAS_UINT, FBLAS_UINT, float, float,
+                                         flash_ptr<bf16_t>, flash_ptr<bf16_t>,
+                                         flash_ptr<float>, FBLAS_UINT,
+                                         FBLAS_UINT, FBLAS_UINT);
 }  // namespace flash
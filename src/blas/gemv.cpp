@@ -0,0 +1,145 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <algorithm>
+#include <vector>
+#include "bof_types.h"
+#include "bof_utils.h"
+#include "flash_blas.h"
+#include "scheduler/scheduler.h"
+#include "tasks/gemv_task.h"
+
+namespace flash {
+  extern Scheduler sched;
+}  // namespace flash
+
+namespace {
+  using namespace flash;
+
+  // `a` is a row-major `n_rows x n_cols` matrix; each task streams one row
+  // panel of atmost `GEMV_BLK_SIZE` elements, so `a` is read exactly once
+  // - trans_a='N' : x has `n_cols` rows, y has `n_rows` rows
+  // - trans_a='T' : x has `n_rows` rows, y has `n_cols` rows
+  // `a` is stored as `S`, & computed on as `T`
+  template<typename T, typename S>
+  void gemv_rm(CHAR trans_a, FBLAS_UINT n_rows, FBLAS_UINT n_cols,
+               FBLAS_UINT n_rhs, T alpha, T beta, flash_ptr<S> a,
+               FBLAS_UINT lda_a, T* x, T* y) {
+    FBLAS_UINT x_len = (trans_a == 'N' ? n_cols : n_rows);
+    FBLAS_UINT y_len = (trans_a == 'N' ? n_rows : n_cols);
+    FBLAS_UINT blk_rows =
+        std::max((FBLAS_UINT) GEMV_BLK_SIZE / n_cols, (FBLAS_UINT) 1);
+    FBLAS_UINT n_blks = ROUND_UP(n_rows, blk_rows) / blk_rows;
+    GLOG_DEBUG("blk_rows=", blk_rows, ", n_blks=", n_blks);
+
+    GemvAccumulator<T>* acc = nullptr;
+    if (trans_a == 'T') {
+      acc = new GemvAccumulator<T>(n_cols * n_rhs);
+    }
+    auto** tasks = new GemvTask<T, S>*[n_blks];
+    for (FBLAS_UINT i = 0; i < n_blks; i++) {
+      FBLAS_UINT start_row = i * blk_rows;
+      FBLAS_UINT rblk_size = std::min(blk_rows, n_rows - start_row);
+      tasks[i] = new GemvTask<T, S>(trans_a, a, lda_a, start_row, rblk_size,
+                                    n_cols, n_rhs, alpha, beta, x, x_len, y,
+                                    y_len, acc);
+      sched.add_task(tasks[i]);
+    }
+
+    sleep_wait_for_complete(tasks, n_blks);
+    for (FBLAS_UINT i = 0; i < n_blks; i++) {
+      delete tasks[i];
+    }
+    delete[] tasks;
+
+    if (acc != nullptr) {
+      acc->reduce(alpha, beta, y);
+      delete acc;
+    }
+  }
+}  // namespace
+
+namespace flash {
+  template<typename T>
+  FBLAS_INT gemv(CHAR mat_ord, CHAR trans_a, FBLAS_UINT m, FBLAS_UINT n,
+                 compute_t<T> alpha, compute_t<T> beta, flash_ptr<T> a,
+                 compute_t<T>* x, compute_t<T>* y, FBLAS_UINT n_rhs,
+                 FBLAS_UINT lda_a) {
+    GLOG_DEBUG("parameters: mat_ord=", mat_ord, ", trans_a=", trans_a,
+               ", m=", m, ", n=", n, ", n_rhs=", n_rhs, ", alpha=", alpha,
+               ", beta=", beta);
+    GLOG_ASSERT(mat_ord == 'R' || mat_ord == 'C', "mat_ord must be 'C' or 'R'");
+    GLOG_ASSERT(trans_a == 'N' || trans_a == 'T', "trans_a must be 'T' or 'N'");
+    if (m == 0 || n == 0 || n_rhs == 0) {
+      return 0;
+    }
+
+    // column-major `A` is row-major `A^T`
+    FBLAS_UINT n_rows = (mat_ord == 'R' ? m : n);
+    FBLAS_UINT n_cols = (mat_ord == 'R' ? n : m);
+    if (mat_ord == 'C') {
+      trans_a = (trans_a == 'N' ? 'T' : 'N');
+    }
+    if (lda_a == 0) {
+      lda_a = n_cols;
+    }
+    GLOG_ASSERT(lda_a >= n_cols, "lda specified too small");
+
+    gemv_rm(trans_a, n_rows, n_cols, n_rhs, alpha, beta, a, lda_a, x, y);
+    return 0;
+  }
+
+  template<typename T>
+  FBLAS_INT gemv(CHAR mat_ord, CHAR trans_a, FBLAS_UINT m, FBLAS_UINT n,
+                 compute_t<T> alpha, compute_t<T> beta, flash_ptr<T> a,
+                 flash_ptr<compute_t<T>> x, flash_ptr<compute_t<T>> y,
+                 FBLAS_UINT n_rhs, FBLAS_UINT lda_a) {
+    typedef compute_t<T> V;
+    FBLAS_UINT x_len = (trans_a == 'N' ? n : m) * n_rhs;
+    FBLAS_UINT y_len = (trans_a == 'N' ? m : n) * n_rhs;
+    if (x_len == 0 || y_len == 0) {
+      return 0;
+    }
+
+    // vectors are small next to `A`; stage them in memory
+    V* x_ptr = new V[x_len];
+    V* y_ptr = new V[y_len];
+    x.fop->read(x.foffset, x_len * sizeof(V), x_ptr);
+    if (beta != 0) {
+      y.fop->read(y.foffset, y_len * sizeof(V), y_ptr);
+    }
+
+    FBLAS_INT ret = gemv(mat_ord, trans_a, m, n, alpha, beta, a, x_ptr, y_ptr,
+                         n_rhs, lda_a);
+
+    y.fop->write(y.foffset, y_len * sizeof(V), y_ptr);
+    delete[] x_ptr;
+    delete[] y_ptr;
+    return ret;
+  }
+
+  template FBLAS_INT gemv<float>(CHAR, CHAR, FBLAS_UINT, FBLAS_UINT, float,
+                                 float, flash_ptr<float>, float*, float*,
+                                 FBLAS_UINT, FBLAS_UINT);
+  template FBLAS_INT gemv<double>(CHAR, CHAR, FBLAS_UINT, FBLAS_UINT, double,
+                                  double, flash_ptr<double>, double*, double*,
+                                  FBLAS_UINT, FBLAS_UINT);
+  template FBLAS_INT gemv<fp16_t>(CHAR, CHAR, FBLAS_UINT, FBLAS_UINT, float,
+                                  float, flash_ptr<fp16_t>, float*, float*,
+                                  FBLAS_UINT, FBLAS_UINT);
+  template FBLAS_INT gemv<bf16_t>(CHAR, CHAR, FBLAS_UINT, FBLAS_UINT, float,
+                                  float, flash_ptr<bf16_t>, float*, float*,
+                                  FBLAS_UINT, FBLAS_UINT);
+  template FBLAS_INT gemv<float>(CHAR, CHAR, FBLAS_UINT, FBLAS_UINT, float,
+                                 float, flash_ptr<float>, flash_ptr<float>,
+                                 flash_ptr<float>, FBLAS_UINT, FBLAS_UINT);
+  template FBLAS_INT gemv<double>(CHAR, CHAR, FBLAS_UINT, FBLAS_UINT, double,
+                                  double, flash_ptr<double>, flash_ptr<double>,
+                                  flash_ptr<double>, FBLAS_UINT, FBLAS_UINT);
+  template FBLAS_INT gemv<fp16_t>(CHAR, CHAR, FBLAS_UINT, FBLAS_UINT, float,
+                                  float, flash_ptr<fp16_t>, flash_ptr<float>,
+                                  flash_ptr<float>, FBLAS_UINT, FBLAS_UINT);
+  template FBLAS_INT gemv<bf16_t>(CHAR, CHAR, FBLAS_UINT, FBLAS_UINT, float,
+                                  float, flash_ptr<bf16_t>, flash_ptr<float>,
+                                  flash_ptr<float>, FBLAS_UINT, FBLAS_UINT);
+}  // namespace flash
@@ -24,12 +24,12 @@ using vec3 = vector<vec2<T>>;
 namespace flash {
   extern Scheduler sched;
 
+  template<typename T>
   FBLAS_INT kmeans(CHAR mat_ord, CHAR trans_a, CHAR trans_b, FBLAS_UINT m,
-                   FBLAS_UINT n, FBLAS_UINT k, FPTYPE alpha, FPTYPE beta,
-                   flash_ptr<FPTYPE> a, flash_ptr<FPTYPE> b,
-                   flash_ptr<FPTYPE> c, FBLAS_UINT lda_a, FBLAS_UINT lda_b,
-                   FBLAS_UINT lda_c, FPTYPE *c_l2sq, FPTYPE *p_l2sq,
-                   FPTYPE *ones) {
+                   FBLAS_UINT n, FBLAS_UINT k, scalar_t<T> alpha,
+                   scalar_t<T> beta, flash_ptr<T> a, flash_ptr<T> b,
+                   flash_ptr<T> c, FBLAS_UINT lda_a, FBLAS_UINT lda_b,
+                   FBLAS_UINT lda_c, T *c_l2sq, T *p_l2sq, T *ones) {
     GLOG_DEBUG("parameters: mat_ord=", mat_ord, ", trans_a=", trans_a,
                ", trans_b=", trans_b, ", m=", m, ", n=", n, ", k=", k,
                ", alpha=", alpha, ", beta=", beta);
@@ -70,7 +70,7 @@ namespace flash {
 
     for (int i = 0; i < 3; i++) {
       FBLAS_UINT div = (MKN[i] / MKN_B[i]);
-      if (MKN[i] - div * MKN_B[i] < SECTOR_LEN / sizeof(FPTYPE))
+      if (MKN[i] - div * MKN_B[i] < SECTOR_LEN / sizeof(T))
         NUM_B[i] = div;
       else
         NUM_B[i] = div + 1;
@@ -79,8 +79,9 @@ namespace flash {
     GLOG_DEBUG("blocking info: a_nrow_blks=", NUM_B[0],
                ", a_ncol_blks=", NUM_B[1], ", b_ncol_blks=", NUM_B[2]);
 
-    vec3<KMeansTask *> tasks(
-        NUM_B[1], vec2<KMeansTask *>(NUM_B[0], vector<KMeansTask *>(NUM_B[2])));
+    vec3<KMeansTask<T> *> tasks(
+        NUM_B[1],
+        vec2<KMeansTask<T> *>(NUM_B[0], vector<KMeansTask<T> *>(NUM_B[2])));
 
     for (FBLAS_UINT l = 0; l < NUM_B[1]; l++) {
       for (FBLAS_UINT i = 0; i < NUM_B[0]; i++) {
@@ -89,7 +90,7 @@ namespace flash {
           FBLAS_UINT indices[3] = {i, l, j};
           FBLAS_UINT ptr_offset[3], IKJ_NUM[3];
 
-          FPTYPE *cts, *pts;
+          T *cts, *pts;
 
           for (int d = 0; d < 3; d++) {
             if (indices[d] == NUM_B[d] - 1)
@@ -109,8 +110,8 @@ namespace flash {
             FBLAS_UINT n_num = IKJ_NUM[COL[mat]];
 
             stride_info[mat].n_strides = m_num;
-            stride_info[mat].len_per_stride = n_num * sizeof(FPTYPE);
-            stride_info[mat].stride = LDA[mat] * sizeof(FPTYPE);
+            stride_info[mat].len_per_stride = n_num * sizeof(T);
+            stride_info[mat].stride = LDA[mat] * sizeof(T);
 
             ptr_offset[mat] = m_b * LDA[mat] + n_b;
 
@@ -123,7 +124,7 @@ namespace flash {
           if (l > 0)
             beta = 1.0;
 
-          tasks[l][i][j] = new KMeansTask(
+          tasks[l][i][j] = new KMeansTask<T>(
               a, b, c, IKJ_NUM[0], IKJ_NUM[1], IKJ_NUM[2], ptr_offset,
               IKJ_NUM[COL[0]], IKJ_NUM[COL[1]], IKJ_NUM[COL[2]], stride_info,
               alpha, beta, trans_a, trans_b, mat_ord, cts, pts, ones);
@@ -196,4 +197,15 @@ namespace flash {
 
     return 0;
   }
+
+  template FBLAS_INT kmeans<float>(CHAR, CHAR, CHAR, FBLAS_UINT, FBLAS_UINT,
+                                   FBLAS_UINT, float, float, flash_ptr<float>,
+                                   flash_ptr<float>, flash_ptr<float>,
+                                   FBLAS_UINT, FBLAS_UINT, FBLAS_UINT, float *,
+                                   float *, float *);
+  template FBLAS_INT kmeans<double>(CHAR, CHAR, CHAR, FBLAS_UINT, FBLAS_UINT,
+                                    FBLAS_UINT, double, double,
+                                    flash_ptr<double>, flash_ptr<double>,
+                                    flash_ptr<double>, FBLAS_UINT, FBLAS_UINT,
+                                    FBLAS_UINT, double *, double *, double *);
 }  // namespace flash
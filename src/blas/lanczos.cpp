@@ -0,0 +1,156 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include "blas_utils.h"
+#include "bof_types.h"
+#include "bof_utils.h"
+#include "flash_blas.h"
+#include "mkl_traits.h"
+#include "scheduler/scheduler.h"
+
+namespace flash {
+  extern Scheduler sched;
+}  // namespace flash
+
+namespace flash {
+  template<typename T>
+  FBLAS_INT lanczos(FBLAS_UINT n, flash_ptr<T> a, flash_ptr<MKL_INT> ia,
+                    flash_ptr<MKL_INT> ja, FBLAS_UINT k, FBLAS_UINT blk_size,
+                    FBLAS_UINT max_iters, scalar_t<T> tol, T* evals, T* evecs) {
+    GLOG_DEBUG("parameters: n=", n, ", k=", k, ", blk_size=", blk_size,
+               ", max_iters=", max_iters, ", tol=", tol);
+    GLOG_ASSERT(k > 0 && k <= n, "k=", k, " must be in [1, n]");
+    GLOG_ASSERT(blk_size > 0, "blk_size must be > 0");
+    FBLAS_UINT b = std::min(blk_size, n);
+    // the basis holds at most `n` vectors
+    FBLAS_UINT max_blks = std::min(max_iters, n / b);
+    FBLAS_UINT max_dim = max_blks * b;
+    GLOG_ASSERT(max_dim >= k, "basis of ", max_dim,
+                " vectors cannot hold k=", k, " eigenvectors");
+
+    // Krylov basis V = [V_0 .. V_j], with room for V_{j+1}
+    T* basis = new T[n * (max_dim + b)];
+    // block tridiagonal T = V^T * A * V, column-major with ld `max_dim`
+    T* t = new T[max_dim * max_dim];
+    T* h = new T[max_dim * b];
+    T* r = new T[b * b];
+    T* y = new T[max_dim * max_dim];
+    T* theta = new T[max_dim];
+    T* res = new T[b];
+    std::fill(t, t + max_dim * max_dim, (T) 0.0);
+
+    // fixed seed => reproducible eigenvectors
+    std::mt19937_64 gen(0x5eed);
+    fill_gaussian(basis, n * b, gen);
+    orthonormalize(basis, n, b);
+
+    FBLAS_UINT dim = 0;
+    FBLAS_UINT n_conv = 0;
+    for (FBLAS_UINT j = 0; j < max_blks && n_conv < k; j++) {
+      FBLAS_UINT start = j * b;
+      T*         v_j = basis + start * n;
+      T*         w = basis + (start + b) * n;
+      dim = start + b;
+
+      // W = A * V_j; each step issues the same row blocks of A in the same
+      // order, so A streams sequentially (or hits the Cache) every step
+      csrmm('N', n, n, b, 1.0, 0.0, a, ia, ja, 'C', v_j, w);
+
+      // full reorthogonalization against V_0 .. V_j, twice for stability;
+      // the projections onto V_j accumulate T_jj = V_j^T * A * V_j
+      for (FBLAS_UINT pass = 0; pass < 2; pass++) {
+        MklTraits<T>::gemm(CblasColMajor, CblasTrans, CblasNoTrans, dim, b, n,
+                           1.0, basis, n, w, n, 0.0, h, dim);
+        MklTraits<T>::gemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, b,
+                           dim, -1.0, basis, n, h, dim, 1.0, w, n);
+        for (FBLAS_UINT c = 0; c < b; c++) {
+          for (FBLAS_UINT i = 0; i < b; i++) {
+            t[(start + c) * max_dim + start + i] += h[c * dim + start + i];
+          }
+        }
+      }
+      for (FBLAS_UINT c = 0; c < b; c++) {
+        for (FBLAS_UINT i = c + 1; i < b; i++) {
+          T avg = (t[(start + c) * max_dim + start + i] +
+                   t[(start + i) * max_dim + start + c]) /
+                       2;
+          t[(start + c) * max_dim + start + i] = avg;
+          t[(start + i) * max_dim + start + c] = avg;
+        }
+      }
+
+      // W = V_{j+1} * B_j; T_{j+1,j} = B_j
+      orthonormalize(w, n, b, r);
+      if (dim < max_dim) {
+        for (FBLAS_UINT c = 0; c < b; c++) {
+          for (FBLAS_UINT i = 0; i < b; i++) {
+            t[(start + c) * max_dim + dim + i] = r[c * b + i];
+            t[(dim + i) * max_dim + start + c] = r[c * b + i];
+          }
+        }
+      }
+
+      // Rayleigh-Ritz on T; eigenvalues in ascending order
+      for (FBLAS_UINT c = 0; c < dim; c++) {
+        std::copy(t + c * max_dim, t + c * max_dim + dim, y + c * dim);
+      }
+      MKL_INT ret =
+          MklTraits<T>::syev(LAPACK_COL_MAJOR, 'V', 'U', dim, y, dim, theta);
+      if (ret != 0) {
+        GLOG_FATAL("syev failed with ret=", ret);
+      }
+
+      // residual of Ritz pair (theta, V*y) is |B_j * y[start:dim]|
+      T scale = std::max(std::abs(theta[0]), std::abs(theta[dim - 1]));
+      n_conv = 0;
+      for (FBLAS_UINT c = 0; c < std::min(k, dim); c++) {
+        T* y_c = y + (dim - 1 - c) * dim;
+        MklTraits<T>::gemv(CblasColMajor, CblasNoTrans, b, b, 1.0, r, b,
+                           y_c + start, 1, 0.0, res, 1);
+        T nrm = 0;
+        for (FBLAS_UINT i = 0; i < b; i++) {
+          nrm += res[i] * res[i];
+        }
+        if (std::sqrt(nrm) <= tol * scale) {
+          n_conv++;
+        }
+      }
+      GLOG_DEBUG("step=", j, ", basis=", dim, ", converged=", n_conv);
+    }
+
+    // top-`k` Ritz pairs, largest first
+    for (FBLAS_UINT c = 0; c < k; c++) {
+      evals[c] = theta[dim - 1 - c];
+    }
+    MklTraits<T>::gemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, k, dim,
+                       1.0, basis, n, y + (dim - k) * dim, dim, 0.0, evecs, n);
+    for (FBLAS_UINT c = 0; c < k / 2; c++) {
+      std::swap_ranges(evecs + c * n, evecs + (c + 1) * n,
+                       evecs + (k - 1 - c) * n);
+    }
+
+    delete[] basis;
+    delete[] t;
+    delete[] h;
+    delete[] r;
+    delete[] y;
+    delete[] theta;
+    delete[] res;
+
+    // flush cache
+    sched.flush_cache();
+    return (FBLAS_INT)(k - n_conv);
+  }
+
+  template FBLAS_INT lanczos<float>(FBLAS_UINT, flash_ptr<float>,
+                                    flash_ptr<MKL_INT>, flash_ptr<MKL_INT>,
+                                    FBLAS_UINT, FBLAS_UINT, FBLAS_UINT, float,
+                                    float*, float*);
+  template FBLAS_INT lanczos<double>(FBLAS_UINT, flash_ptr<double>,
+                                     flash_ptr<MKL_INT>, flash_ptr<MKL_INT>,
+                                     FBLAS_UINT, FBLAS_UINT, FBLAS_UINT, double,
+                                     double*, double*);
+}  // namespace flash
@@ -0,0 +1,176 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include "blas_utils.h"
+#include "bof_types.h"
+#include "bof_utils.h"
+#include "flash_blas.h"
+#include "scheduler/scheduler.h"
+#include "tasks/gemm_task.h"
+#include "tasks/potrf_task.h"
+#include "tasks/syrk_task.h"
+
+namespace flash {
+  extern Scheduler sched;
+}  // namespace flash
+
+namespace {
+  using namespace flash;
+
+  // square tiling of a row-major `n x n` matrix
+  template<typename T>
+  struct Tiling {
+    FBLAS_UINT n, blk, lda;
+
+    FBLAS_UINT dim(FBLAS_UINT i) {
+      return std::min(this->blk, this->n - i * this->blk);
+    }
+
+    StrideInfo sinfo(FBLAS_UINT i, FBLAS_UINT j, FBLAS_UINT& offset) {
+      return block_sinfo<T>(i * this->blk, j * this->blk, this->dim(i),
+                            this->dim(j), this->lda, offset);
+    }
+  };
+}  // namespace
+
+namespace flash {
+  template<typename T>
+  FBLAS_INT potrf(CHAR mat_ord, CHAR uplo, FBLAS_UINT n, flash_ptr<T> a,
+                  FBLAS_UINT lda_a) {
+    GLOG_DEBUG("parameters: mat_ord=", mat_ord, ", uplo=", uplo, ", n=", n);
+    GLOG_ASSERT(mat_ord == 'R' || mat_ord == 'C', "mat_ord must be 'C' or 'R'");
+    GLOG_ASSERT(uplo == 'L' || uplo == 'U', "uplo must be 'L' or 'U'");
+    if (n == 0) {
+      return 0;
+    }
+    // column-major lower is row-major upper
+    if (mat_ord == 'C') {
+      uplo = (uplo == 'L' ? 'U' : 'L');
+    }
+    if (lda_a == 0) {
+      lda_a = n;
+    }
+    GLOG_ASSERT(lda_a >= n, "lda specified too small");
+
+    Tiling<T>  tl = {n, std::min((FBLAS_UINT) POTRF_BLK_SIZE, n), lda_a};
+    FBLAS_UINT nb = ROUND_UP(n, tl.blk) / tl.blk;
+    bool       lower = (uplo == 'L');
+    GLOG_DEBUG("blocking info: n_blks=", nb);
+
+    // tiles of the factor; (i, j) with i >= j is stored at (j, i) if upper
+    auto fac = [&](FBLAS_UINT i, FBLAS_UINT j) {
+      return (lower ? i * nb + j : j * nb + i);
+    };
+    auto fac_sinfo = [&](FBLAS_UINT i, FBLAS_UINT j, FBLAS_UINT& offset) {
+      return (lower ? tl.sinfo(i, j, offset) : tl.sinfo(j, i, offset));
+    };
+    // last task writing each tile
+    std::vector<BaseTask*> last(nb * nb, nullptr);
+    std::vector<BaseTask*> tasks;
+    auto                   depend = [&](BaseTask* tsk, FBLAS_UINT t) {
+      if (last[t] != nullptr) {
+        tsk->add_parent(last[t]->get_id());
+      }
+    };
+
+    // right-looking : after a panel is factored, it updates the whole
+    // trailing matrix, so each of its tiles is used while still cached
+    std::atomic<FBLAS_INT> info(0);
+    for (FBLAS_UINT k = 0; k < nb; k++) {
+      FBLAS_UINT dk = tl.dim(k);
+      FBLAS_UINT kk = k * nb + k;
+      StrideInfo sinfo[4];
+      FBLAS_UINT off[4];
+
+      sinfo[0] = tl.sinfo(k, k, off[0]);
+      auto* ptsk = new PotrfTask<T>(a + off[0], sinfo[0], dk, uplo,
+                                    k * tl.blk, info);
+      depend(ptsk, kk);
+      last[kk] = ptsk;
+      tasks.push_back(ptsk);
+
+      // L_ik = A_ik * L_kk^-T, or U_ki = U_kk^-T * A_ki
+      for (FBLAS_UINT i = k + 1; i < nb; i++) {
+        FBLAS_UINT di = tl.dim(i);
+        FBLAS_UINT ik = fac(i, k);
+        sinfo[0] = tl.sinfo(k, k, off[0]);
+        sinfo[1] = fac_sinfo(i, k, off[1]);
+        auto* ttsk = new TrsmTask<T>(a + off[0], a + off[1], sinfo,
+                                     (lower ? di : dk), (lower ? dk : di), 1.0,
+                                     (lower ? 'R' : 'L'), uplo, 'T', 'N');
+        depend(ttsk, kk);
+        depend(ttsk, ik);
+        last[ik] = ttsk;
+        tasks.push_back(ttsk);
+      }
+
+      for (FBLAS_UINT i = k + 1; i < nb; i++) {
+        FBLAS_UINT di = tl.dim(i);
+        FBLAS_UINT ik = fac(i, k);
+
+        // A_ii -= L_ik * L_ik^T, or A_ii -= U_ki^T * U_ki
+        sinfo[0] = fac_sinfo(i, k, off[0]);
+        sinfo[1] = sinfo[0];
+        sinfo[2] = tl.sinfo(i, i, off[2]);
+        sinfo[3] = sinfo[2];
+        auto* stsk = new SyrkTask<T>(a + off[0], a + off[0], a + off[2],
+                                     a + off[2], di, di, dk, sinfo, -1.0, 1.0,
+                                     uplo, (lower ? 'N' : 'T'), true, false);
+        depend(stsk, ik);
+        depend(stsk, i * nb + i);
+        last[i * nb + i] = stsk;
+        tasks.push_back(stsk);
+
+        // A_ij -= L_ik * L_jk^T, or A_ji -= U_kj^T * U_ki
+        for (FBLAS_UINT j = k + 1; j < i; j++) {
+          FBLAS_UINT dj = tl.dim(j);
+          FBLAS_UINT jk = fac(j, k);
+          FBLAS_UINT ij = fac(i, j);
+          StrideInfo gsinfo[3];
+          FBLAS_UINT goff[3];
+          if (lower) {
+            gsinfo[0] = fac_sinfo(i, k, goff[0]);
+            gsinfo[1] = fac_sinfo(j, k, goff[1]);
+          } else {
+            gsinfo[0] = fac_sinfo(j, k, goff[0]);
+            gsinfo[1] = fac_sinfo(i, k, goff[1]);
+          }
+          gsinfo[2] = fac_sinfo(i, j, goff[2]);
+          auto* gtsk =
+              (lower ? new GemmTask<T>(a, a, a, di, dk, dj, goff, dk, dk, dj,
+                                       gsinfo, -1.0, 1.0, 'N', 'T', 'R')
+                     : new GemmTask<T>(a, a, a, dj, dk, di, goff, dj, di, di,
+                                       gsinfo, -1.0, 1.0, 'T', 'N', 'R'));
+          depend(gtsk, ik);
+          depend(gtsk, jk);
+          depend(gtsk, ij);
+          last[ij] = gtsk;
+          tasks.push_back(gtsk);
+        }
+      }
+    }
+
+    for (auto tsk : tasks) {
+      sched.add_task(tsk);
+    }
+    for (auto tsk : tasks) {
+      while (tsk->get_status() != Complete) {
+        ::usleep(100);
+      }
+      delete tsk;
+    }
+
+    // flush cache
+    sched.flush_cache();
+    return info.load();
+  }
+
+  template FBLAS_INT potrf<float>(CHAR, CHAR, FBLAS_UINT, flash_ptr<float>,
+                                  FBLAS_UINT);
+  template FBLAS_INT potrf<double>(CHAR, CHAR, FBLAS_UINT, flash_ptr<double>,
+                                   FBLAS_UINT);
+}  // namespace flash
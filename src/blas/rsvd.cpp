@@ -0,0 +1,205 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <random>
+#include "blas_utils.h"
+#include "bof_types.h"
+#include "bof_utils.h"
+#include "flash_blas.h"
+#include "lib_funcs.h"
+#include "mkl_traits.h"
+#include "scheduler/scheduler.h"
+
+namespace flash {
+  extern Scheduler sched;
+}  // namespace flash
+
+namespace {
+  using namespace flash;
+
+  // out = op(A) * in, for `n_rhs` column-major right-hand sides in memory
+  template<typename T>
+  using MultFn = std::function<void(T*, T*, FBLAS_UINT)>;
+
+  // out -= out_w * (in^T * in_w)^T; the rank-1 correction turning a product
+  // with A into one with A - 1*mean^T, without forming the centered copy
+  template<typename T>
+  void uncenter(T* in, T* out, FBLAS_UINT in_rows, FBLAS_UINT out_rows,
+                FBLAS_UINT n_rhs, T* in_w, T* out_w) {
+    T* dots = new T[n_rhs];
+    MklTraits<T>::gemv(CblasColMajor, CblasTrans, in_rows, n_rhs, 1.0, in,
+                       in_rows, in_w, 1, 0.0, dots, 1);
+    MklTraits<T>::gemm(CblasColMajor, CblasNoTrans, CblasTrans, out_rows,
+                       n_rhs, 1, -1.0, out_w, out_rows, dots, n_rhs, 1.0, out,
+                       out_rows);
+    delete[] dots;
+  }
+
+  template<typename T>
+  FBLAS_INT rsvd_impl(FBLAS_UINT m, FBLAS_UINT n, FBLAS_UINT k,
+                      FBLAS_UINT oversample, FBLAS_UINT power_iters,
+                      MultFn<T> mult, MultFn<T> mult_t, T* s, T* u, T* v,
+                      T* mean) {
+    GLOG_ASSERT(k > 0 && k <= std::min(m, n), "rank k=", k,
+                " must be in [1, min(m, n)]");
+    FBLAS_UINT l = std::min(k + oversample, std::min(m, n));
+    bool       center = (mean != nullptr);
+    GLOG_DEBUG("samples=", l, ", power_iters=", power_iters,
+               ", center=", center);
+
+    // fixed seed => reproducible factors
+    std::mt19937_64 gen(0x5eed);
+    // row-space sample (n x l) & range sample (m x l)
+    T* x = new T[n * l];
+    T* y = new T[m * l];
+    T* ones_m = nullptr;
+    if (center) {
+      ones_m = new T[m];
+      std::fill(ones_m, ones_m + m, (T) 1.0);
+
+      // start from the row space : A^T * [G, 1] yields the first sample &
+      // the column sums in the same pass over A
+      T* g = new T[m * (l + 1)];
+      T* z = new T[n * (l + 1)];
+      fill_gaussian(g, m * l, gen);
+      std::fill(g + m * l, g + m * (l + 1), (T) 1.0);
+      mult_t(g, z, l + 1);
+      for (FBLAS_UINT i = 0; i < n; i++) {
+        mean[i] = z[n * l + i] / m;
+      }
+      memcpy(x, z, n * l * sizeof(T));
+      uncenter(g, x, m, n, l, ones_m, mean);
+      delete[] g;
+      delete[] z;
+    } else {
+      fill_gaussian(x, n * l, gen);
+    }
+
+    // each call streams A once for all `l` samples
+    auto apply = [&](T* in, T* out) {
+      mult(in, out, l);
+      if (center) {
+        uncenter(in, out, n, m, l, mean, ones_m);
+      }
+    };
+    auto apply_t = [&](T* in, T* out) {
+      mult_t(in, out, l);
+      if (center) {
+        uncenter(in, out, m, n, l, ones_m, mean);
+      }
+    };
+
+    // Q = orth(A * X), with `power_iters` subspace iterations
+    apply(x, y);
+    orthonormalize(y, m, l);
+    for (FBLAS_UINT it = 0; it < power_iters; it++) {
+      apply_t(y, x);
+      orthonormalize(x, n, l);
+      apply(x, y);
+      orthonormalize(y, m, l);
+    }
+
+    // B^T = A^T * Q = U_b * S_b * V_b^T => A ~= (Q * V_b) * S_b * U_b^T
+    apply_t(y, x);
+    T*      s_b = new T[l];
+    T*      vt_b = new T[l * l];
+    T*      superb = new T[l];
+    MKL_INT ret = MklTraits<T>::gesvd(LAPACK_COL_MAJOR, 'O', 'A', n, l, x, n,
+                                      s_b, nullptr, 1, vt_b, l, superb);
+    if (ret != 0) {
+      GLOG_FATAL("gesvd failed with ret=", ret);
+    }
+    memcpy(s, s_b, k * sizeof(T));
+    if (v != nullptr) {
+      memcpy(v, x, n * k * sizeof(T));
+    }
+    if (u != nullptr) {
+      MklTraits<T>::gemm(CblasColMajor, CblasNoTrans, CblasTrans, m, k, l, 1.0,
+                         y, m, vt_b, l, 0.0, u, m);
+    }
+
+    delete[] s_b;
+    delete[] vt_b;
+    delete[] superb;
+    delete[] x;
+    delete[] y;
+    delete[] ones_m;
+
+    // flush cache
+    sched.flush_cache();
+    return 0;
+  }
+}  // namespace
+
+namespace flash {
+  template<typename T>
+  FBLAS_INT rsvd(CHAR mat_ord, FBLAS_UINT m, FBLAS_UINT n, flash_ptr<T> a,
+                 FBLAS_UINT k, FBLAS_UINT oversample, FBLAS_UINT power_iters,
+                 T* s, scalar_t<T>* u, scalar_t<T>* v, scalar_t<T>* mean,
+                 FBLAS_UINT lda_a) {
+    GLOG_DEBUG("parameters: mat_ord=", mat_ord, ", m=", m, ", n=", n,
+               ", k=", k);
+    GLOG_ASSERT(mat_ord == 'R' || mat_ord == 'C', "mat_ord must be 'C' or 'R'");
+    MultFn<T> mult = [&](T* in, T* out, FBLAS_UINT n_rhs) {
+      gemv(mat_ord, 'N', m, n, 1.0, 0.0, a, in, out, n_rhs, lda_a);
+    };
+    MultFn<T> mult_t = [&](T* in, T* out, FBLAS_UINT n_rhs) {
+      gemv(mat_ord, 'T', m, n, 1.0, 0.0, a, in, out, n_rhs, lda_a);
+    };
+    return rsvd_impl(m, n, k, oversample, power_iters, mult, mult_t, s, u, v,
+                     mean);
+  }
+
+  template<typename T>
+  FBLAS_INT rsvd(FBLAS_UINT m, FBLAS_UINT n, flash_ptr<T> a,
+                 flash_ptr<MKL_INT> ia, flash_ptr<MKL_INT> ja, FBLAS_UINT k,
+                 FBLAS_UINT oversample, FBLAS_UINT power_iters, T* s,
+                 scalar_t<T>* u, scalar_t<T>* v, scalar_t<T>* mean) {
+    GLOG_DEBUG("parameters: m=", m, ", n=", n, ", k=", k);
+    MKL_INT* ia_ptr = new MKL_INT[m + 1];
+    flash::read_sync(ia_ptr, ia, m + 1);
+    FBLAS_UINT nnzs = ia_ptr[m] - ia_ptr[0];
+    delete[] ia_ptr;
+
+    // A^T * Y passes stream A^T, transposed once to flash
+    flash_ptr<MKL_INT> ia_tr =
+        flash_malloc<MKL_INT>((n + 1) * sizeof(MKL_INT), "rsvd_ia_tr");
+    flash_ptr<MKL_INT> ja_tr =
+        flash_malloc<MKL_INT>(nnzs * sizeof(MKL_INT), "rsvd_ja_tr");
+    flash_ptr<T> a_tr = flash_malloc<T>(nnzs * sizeof(T), "rsvd_a_tr");
+    csrcsc(m, n, ia, ja, a, ia_tr, ja_tr, a_tr);
+
+    MultFn<T> mult = [&](T* in, T* out, FBLAS_UINT n_rhs) {
+      csrmm('N', m, n, n_rhs, 1.0, 0.0, a, ia, ja, 'C', in, out);
+    };
+    MultFn<T> mult_t = [&](T* in, T* out, FBLAS_UINT n_rhs) {
+      csrmm('N', n, m, n_rhs, 1.0, 0.0, a_tr, ia_tr, ja_tr, 'C', in, out);
+    };
+    FBLAS_INT ret = rsvd_impl(m, n, k, oversample, power_iters, mult, mult_t,
+                              s, u, v, mean);
+
+    flash_free(ia_tr);
+    flash_free(ja_tr);
+    flash_free(a_tr);
+    return ret;
+  }
+
+  template FBLAS_INT rsvd<float>(CHAR, FBLAS_UINT, FBLAS_UINT, flash_ptr<float>,
+                                 FBLAS_UINT, FBLAS_UINT, FBLAS_UINT, float*,
+                                 float*, float*, float*, FBLAS_UINT);
+  template FBLAS_INT rsvd<double>(CHAR, FBLAS_UINT, FBLAS_UINT,
+                                  flash_ptr<double>, FBLAS_UINT, FBLAS_UINT,
+                                  FBLAS_UINT, double*, double*, double*,
+                                  double*, FBLAS_UINT);
+  template FBLAS_INT rsvd<float>(FBLAS_UINT, FBLAS_UINT, flash_ptr<float>,
+                                 flash_ptr<MKL_INT>, flash_ptr<MKL_INT>,
+                                 FBLAS_UINT, FBLAS_UINT, FBLAS_UINT, float*,
+                                 float*, float*, float*);
+  template FBLAS_INT rsvd<double>(FBLAS_UINT, FBLAS_UINT, flash_ptr<double>,
+                                  flash_ptr<MKL_INT>, flash_ptr<MKL_INT>,
+                                  FBLAS_UINT, FBLAS_UINT, FBLAS_UINT, double*,
+                                  double*, double*, double*);
+}  // namespace flash
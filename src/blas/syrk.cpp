@@ -0,0 +1,129 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+#include "blas_utils.h"
+#include "bof_types.h"
+#include "bof_utils.h"
+#include "flash_blas.h"
+#include "scheduler/scheduler.h"
+#include "tasks/syrk_task.h"
+
+namespace flash {
+  extern Scheduler sched;
+}  // namespace flash
+
+namespace flash {
+  template<typename T>
+  FBLAS_INT syrk(CHAR mat_ord, CHAR uplo, CHAR trans, FBLAS_UINT n,
+                 FBLAS_UINT k, scalar_t<T> alpha, scalar_t<T> beta,
+                 flash_ptr<T> a, flash_ptr<T> c, FBLAS_UINT lda_a,
+                 FBLAS_UINT lda_c, bool mirror) {
+    GLOG_DEBUG("parameters: mat_ord=", mat_ord, ", uplo=", uplo,
+               ", trans=", trans, ", n=", n, ", k=", k, ", alpha=", alpha,
+               ", beta=", beta, ", mirror=", mirror);
+    GLOG_ASSERT(mat_ord == 'R' || mat_ord == 'C', "mat_ord must be 'C' or 'R'");
+    GLOG_ASSERT(uplo == 'L' || uplo == 'U', "uplo must be 'L' or 'U'");
+    GLOG_ASSERT(trans == 'N' || trans == 'T', "trans must be 'T' or 'N'");
+    GLOG_ASSERT(k > 0, "k must be positive");
+    if (n == 0) {
+      return 0;
+    }
+
+    // column-major A is row-major A^T; C is symmetric, so only the stored
+    // triangle flips
+    if (mat_ord == 'C') {
+      trans = (trans == 'N' ? 'T' : 'N');
+      uplo = (uplo == 'L' ? 'U' : 'L');
+    }
+    bool tr = (trans == 'T');
+    if (lda_a == 0) {
+      lda_a = (tr ? n : k);
+    }
+    if (lda_c == 0) {
+      lda_c = n;
+    }
+    GLOG_ASSERT(lda_a >= (tr ? n : k), "lda_a specified too small");
+    GLOG_ASSERT(lda_c >= n, "lda_c specified too small");
+
+    FBLAS_UINT n_blk = std::min((FBLAS_UINT) GEMM_BLK_SIZE, n);
+    FBLAS_UINT k_blk = std::min((FBLAS_UINT) GEMM_BLK_SIZE, k);
+    FBLAS_UINT n_nblks = ROUND_UP(n, n_blk) / n_blk;
+    FBLAS_UINT n_kblks = ROUND_UP(k, k_blk) / k_blk;
+    GLOG_DEBUG("blocking info: n_blks=", n_nblks, ", k_blks=", n_kblks);
+
+    // tiles of the `uplo` triangle, i.e. (i, j) with j <= i for 'L'
+    std::vector<std::pair<FBLAS_UINT, FBLAS_UINT>> tiles;
+    for (FBLAS_UINT i = 0; i < n_nblks; i++) {
+      for (FBLAS_UINT j = 0; j < n_nblks; j++) {
+        if (uplo == 'L' ? j <= i : j >= i) {
+          tiles.push_back(std::make_pair(i, j));
+        }
+      }
+    }
+
+    // k-blocks outermost, so all tiles sharing a panel of A run close
+    // together & hit it in the cache
+    std::vector<std::vector<SyrkTask<T>*>> tasks(
+        n_kblks, std::vector<SyrkTask<T>*>(tiles.size()));
+    for (FBLAS_UINT l = 0; l < n_kblks; l++) {
+      FBLAS_UINT k0 = l * k_blk;
+      FBLAS_UINT kc = std::min(k_blk, k - k0);
+      for (FBLAS_UINT t = 0; t < tiles.size(); t++) {
+        FBLAS_UINT i = tiles[t].first, j = tiles[t].second;
+        FBLAS_UINT r0_i = i * n_blk, r0_j = j * n_blk;
+        FBLAS_UINT ri = std::min(n_blk, n - r0_i);
+        FBLAS_UINT rj = std::min(n_blk, n - r0_j);
+
+        StrideInfo sinfo[4];
+        FBLAS_UINT off[4];
+        if (tr) {
+          sinfo[0] = block_sinfo<T>(k0, r0_i, kc, ri, lda_a, off[0]);
+          sinfo[1] = block_sinfo<T>(k0, r0_j, kc, rj, lda_a, off[1]);
+        } else {
+          sinfo[0] = block_sinfo<T>(r0_i, k0, ri, kc, lda_a, off[0]);
+          sinfo[1] = block_sinfo<T>(r0_j, k0, rj, kc, lda_a, off[1]);
+        }
+        sinfo[2] = block_sinfo<T>(r0_i, r0_j, ri, rj, lda_c, off[2]);
+        sinfo[3] = block_sinfo<T>(r0_j, r0_i, rj, ri, lda_c, off[3]);
+
+        tasks[l][t] = new SyrkTask<T>(
+            a + off[0], a + off[1], c + off[2], c + off[3], ri, rj, kc, sinfo,
+            alpha, (l > 0 ? (T) 1.0 : beta), uplo, trans, (i == j),
+            mirror && (l == n_kblks - 1));
+        if (l > 0) {
+          tasks[l][t]->add_parent(tasks[l - 1][t]->get_id());
+        }
+      }
+    }
+
+    for (FBLAS_UINT l = 0; l < n_kblks; l++) {
+      for (auto tsk : tasks[l]) {
+        sched.add_task(tsk);
+      }
+    }
+    for (FBLAS_UINT l = 0; l < n_kblks; l++) {
+      for (auto tsk : tasks[l]) {
+        while (tsk->get_status() != Complete) {
+          ::usleep(100);
+        }
+        delete tsk;
+      }
+    }
+
+    // flush cache
+    sched.flush_cache();
+    return 0;
+  }
+
+  template FBLAS_INT syrk<float>(CHAR, CHAR, CHAR, FBLAS_UINT, FBLAS_UINT,
+                                 float, float, flash_ptr<float>,
+                                 flash_ptr<float>, FBLAS_UINT, FBLAS_UINT,
+                                 bool);
+  template FBLAS_INT syrk<double>(CHAR, CHAR, CHAR, FBLAS_UINT, FBLAS_UINT,
+                                  double, double, flash_ptr<double>,
+                                  flash_ptr<double>, FBLAS_UINT, FBLAS_UINT,
+                                  bool);
+}  // namespace flash
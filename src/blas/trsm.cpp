@@ -0,0 +1,165 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+#include "blas_utils.h"
+#include "bof_types.h"
+#include "bof_utils.h"
+#include "flash_blas.h"
+#include "scheduler/scheduler.h"
+#include "tasks/gemm_task.h"
+#include "tasks/potrf_task.h"
+
+namespace flash {
+  extern Scheduler sched;
+}  // namespace flash
+
+namespace flash {
+  template<typename T>
+  FBLAS_INT trsm(CHAR mat_ord, CHAR side, CHAR uplo, CHAR trans_a, CHAR diag,
+                 FBLAS_UINT m, FBLAS_UINT n, scalar_t<T> alpha, flash_ptr<T> a,
+                 flash_ptr<T> b, FBLAS_UINT lda_a, FBLAS_UINT lda_b) {
+    GLOG_DEBUG("parameters: mat_ord=", mat_ord, ", side=", side,
+               ", uplo=", uplo, ", trans_a=", trans_a, ", diag=", diag,
+               ", m=", m, ", n=", n, ", alpha=", alpha);
+    GLOG_ASSERT(mat_ord == 'R' || mat_ord == 'C', "mat_ord must be 'C' or 'R'");
+    GLOG_ASSERT(side == 'L' || side == 'R', "side must be 'L' or 'R'");
+    GLOG_ASSERT(uplo == 'L' || uplo == 'U', "uplo must be 'L' or 'U'");
+    GLOG_ASSERT(trans_a == 'N' || trans_a == 'T', "trans_a must be 'T' or 'N'");
+    GLOG_ASSERT(diag == 'N' || diag == 'U', "diag must be 'N' or 'U'");
+    if (m == 0 || n == 0) {
+      return 0;
+    }
+
+    // column-major B is row-major B^T, solved from the other side
+    if (mat_ord == 'C') {
+      std::swap(m, n);
+      side = (side == 'L' ? 'R' : 'L');
+      uplo = (uplo == 'L' ? 'U' : 'L');
+    }
+    bool       left = (side == 'L');
+    bool       tr = (trans_a == 'T');
+    FBLAS_UINT a_dim = (left ? m : n);
+    if (lda_a == 0) {
+      lda_a = a_dim;
+    }
+    if (lda_b == 0) {
+      lda_b = n;
+    }
+    GLOG_ASSERT(lda_a >= a_dim, "lda_a specified too small");
+    GLOG_ASSERT(lda_b >= n, "lda_b specified too small");
+
+    FBLAS_UINT blk = std::min((FBLAS_UINT) POTRF_BLK_SIZE, a_dim);
+    FBLAS_UINT other = (left ? n : m);
+    FBLAS_UINT o_blk = std::min((FBLAS_UINT) POTRF_BLK_SIZE, other);
+    FBLAS_UINT nb = ROUND_UP(a_dim, blk) / blk;
+    FBLAS_UINT n_oblks = ROUND_UP(other, o_blk) / o_blk;
+    GLOG_DEBUG("blocking info: a_blks=", nb, ", other_blks=", n_oblks);
+    auto dim = [&](FBLAS_UINT i) { return std::min(blk, a_dim - i * blk); };
+    auto o_dim = [&](FBLAS_UINT i) {
+      return std::min(o_blk, other - i * o_blk);
+    };
+
+    // tiles of B indexed (solved dim, other dim)
+    auto b_sinfo = [&](FBLAS_UINT s, FBLAS_UINT o, FBLAS_UINT& offset) {
+      return (left ? block_sinfo<T>(s * blk, o * o_blk, dim(s), o_dim(o),
+                                    lda_b, offset)
+                   : block_sinfo<T>(o * o_blk, s * blk, o_dim(o), dim(s),
+                                    lda_b, offset));
+    };
+    auto a_sinfo = [&](FBLAS_UINT i, FBLAS_UINT j, FBLAS_UINT& offset) {
+      return block_sinfo<T>(i * blk, j * blk, dim(i), dim(j), lda_a, offset);
+    };
+
+    // op(A) lower => solve the first block first if left, last if right
+    bool forward = ((uplo == 'L') != tr) == left;
+
+    // last task writing each tile of B, & whether it was scaled by `alpha`
+    std::vector<BaseTask*> last(nb * n_oblks, nullptr);
+    std::vector<bool>      scaled(nb * n_oblks, false);
+    std::vector<BaseTask*> tasks;
+
+    // right-looking : once a block of X is solved, it updates all blocks
+    // that depend on it, reusing the block & a column of A while cached
+    for (FBLAS_UINT step = 0; step < nb; step++) {
+      FBLAS_UINT k = (forward ? step : nb - 1 - step);
+      FBLAS_UINT dk = dim(k);
+      for (FBLAS_UINT o = 0; o < n_oblks; o++) {
+        FBLAS_UINT t = k * n_oblks + o;
+        StrideInfo sinfo[2];
+        FBLAS_UINT off[2];
+        sinfo[0] = a_sinfo(k, k, off[0]);
+        sinfo[1] = b_sinfo(k, o, off[1]);
+        auto* ttsk = new TrsmTask<T>(
+            a + off[0], b + off[1], sinfo, (left ? dk : o_dim(o)),
+            (left ? o_dim(o) : dk), (scaled[t] ? 1.0 : alpha), side, uplo,
+            trans_a, diag);
+        if (last[t] != nullptr) {
+          ttsk->add_parent(last[t]->get_id());
+        }
+        last[t] = ttsk;
+        scaled[t] = true;
+        tasks.push_back(ttsk);
+      }
+
+      // B_io -= op(A)_ik * X_ko (left), or B_oi -= X_ok * op(A)_ki (right)
+      for (FBLAS_UINT s = step + 1; s < nb; s++) {
+        FBLAS_UINT i = (forward ? s : nb - 1 - s);
+        FBLAS_UINT di = dim(i);
+        for (FBLAS_UINT o = 0; o < n_oblks; o++) {
+          FBLAS_UINT   t = i * n_oblks + o;
+          FBLAS_UINT   d_o = o_dim(o);
+          StrideInfo   sinfo[3];
+          FBLAS_UINT   off[3];
+          GemmTask<T>* gtsk;
+          T            beta = (scaled[t] ? 1.0 : alpha);
+          if (left) {
+            sinfo[0] = (tr ? a_sinfo(k, i, off[0]) : a_sinfo(i, k, off[0]));
+            sinfo[1] = b_sinfo(k, o, off[1]);
+            sinfo[2] = b_sinfo(i, o, off[2]);
+            gtsk = new GemmTask<T>(a, b, b, di, dk, d_o, off, (tr ? di : dk),
+                                   d_o, d_o, sinfo, -1.0, beta, trans_a, 'N',
+                                   'R');
+          } else {
+            sinfo[0] = b_sinfo(k, o, off[0]);
+            sinfo[1] = (tr ? a_sinfo(i, k, off[1]) : a_sinfo(k, i, off[1]));
+            sinfo[2] = b_sinfo(i, o, off[2]);
+            gtsk = new GemmTask<T>(b, a, b, d_o, dk, di, off, dk,
+                                   (tr ? dk : di), di, sinfo, -1.0, beta, 'N',
+                                   trans_a, 'R');
+          }
+          gtsk->add_parent(last[k * n_oblks + o]->get_id());
+          if (last[t] != nullptr) {
+            gtsk->add_parent(last[t]->get_id());
+          }
+          last[t] = gtsk;
+          scaled[t] = true;
+          tasks.push_back(gtsk);
+        }
+      }
+    }
+
+    for (auto tsk : tasks) {
+      sched.add_task(tsk);
+    }
+    for (auto tsk : tasks) {
+      while (tsk->get_status() != Complete) {
+        ::usleep(100);
+      }
+      delete tsk;
+    }
+
+    // flush cache
+    sched.flush_cache();
+    return 0;
+  }
+
+  template FBLAS_INT trsm<float>(CHAR, CHAR, CHAR, CHAR, CHAR, FBLAS_UINT,
+                                 FBLAS_UINT, float, flash_ptr<float>,
+                                 flash_ptr<float>, FBLAS_UINT, FBLAS_UINT);
+  template FBLAS_INT trsm<double>(CHAR, CHAR, CHAR, CHAR, CHAR, FBLAS_UINT,
+                                  FBLAS_UINT, double, flash_ptr<double>,
+                                  flash_ptr<double>, FBLAS_UINT, FBLAS_UINT);
+}  // namespace flash
@@ -0,0 +1,195 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "blas_utils.h"
+#include "bof_types.h"
+#include "bof_utils.h"
+#include "flash_blas.h"
+#include "scheduler/scheduler.h"
+#include "tasks/tsqr_task.h"
+
+namespace flash {
+  extern Scheduler sched;
+}  // namespace flash
+
+namespace {
+  using namespace flash;
+
+  // a node of the reduction tree; leaves are row panels
+  template<typename T>
+  struct TsqrNode {
+    T*        r = nullptr;
+    // explicit Q of the stacked children's R; `nullptr` if the node was
+    // carried up unchanged, or Q is not wanted
+    T*        q = nullptr;
+    BaseTask* tsk = nullptr;
+  };
+
+  void wait_and_delete(std::vector<BaseTask*>& tasks) {
+    for (auto tsk : tasks) {
+      while (tsk->get_status() != Complete) {
+        ::usleep(100);
+      }
+      delete tsk;
+    }
+    tasks.clear();
+  }
+}  // namespace
+
+namespace flash {
+  template<typename T>
+  FBLAS_INT tsqr(CHAR mat_ord, FBLAS_UINT m, FBLAS_UINT n, flash_ptr<T> a, T* r,
+                 flash_ptr<T> q, FBLAS_UINT lda_a, FBLAS_UINT lda_q) {
+    GLOG_DEBUG("parameters: mat_ord=", mat_ord, ", m=", m, ", n=", n,
+               ", write_q=", (q.fop != nullptr));
+    GLOG_ASSERT(mat_ord == 'R' || mat_ord == 'C', "mat_ord must be 'C' or 'R'");
+    GLOG_ASSERT(m >= n, "tsqr expects m >= n, found m=", m, ", n=", n);
+    if (n == 0) {
+      return 0;
+    }
+    bool       col_major = (mat_ord == 'C');
+    bool       write_q = (q.fop != nullptr);
+    FBLAS_UINT min_ld = (col_major ? m : n);
+    if (lda_a == 0) {
+      lda_a = min_ld;
+    }
+    if (lda_q == 0) {
+      lda_q = min_ld;
+    }
+    GLOG_ASSERT(lda_a >= min_ld, "lda_a specified too small");
+    GLOG_ASSERT(lda_q >= min_ld, "lda_q specified too small");
+
+    // atleast `n` rows per panel; the last panel takes the remainder
+    FBLAS_UINT blk_rows = std::max((FBLAS_UINT) TSQR_BLK_SIZE / n, n);
+    FBLAS_UINT n_panels = std::max(m / blk_rows, (FBLAS_UINT) 1);
+    GLOG_DEBUG("blk_rows=", blk_rows, ", n_panels=", n_panels);
+    auto panel_sinfo = [&](FBLAS_UINT p, FBLAS_UINT lda, FBLAS_UINT& offset) {
+      FBLAS_UINT start = p * blk_rows;
+      FBLAS_UINT rows = (p == n_panels - 1 ? m - start : blk_rows);
+      return (col_major ? block_sinfo<T>(0, start, n, rows, lda, offset)
+                        : block_sinfo<T>(start, 0, rows, n, lda, offset));
+    };
+    auto panel_rows = [&](FBLAS_UINT p) {
+      return (p == n_panels - 1 ? m - p * blk_rows : blk_rows);
+    };
+
+    // level 0 : independent QR of each row panel; A is read once
+    std::vector<std::vector<TsqrNode<T>>> levels(1);
+    std::vector<BaseTask*>                tasks;
+    for (FBLAS_UINT p = 0; p < n_panels; p++) {
+      StrideInfo sinfo[2];
+      FBLAS_UINT off[2];
+      sinfo[0] = panel_sinfo(p, lda_a, off[0]);
+      sinfo[1] = panel_sinfo(p, lda_q, off[1]);
+      TsqrNode<T> node;
+      node.r = new T[n * n];
+      node.tsk =
+          new TsqrPanelTask<T>(a + off[0], (write_q ? q + off[1] : q), sinfo,
+                               panel_rows(p), n, col_major, node.r);
+      levels[0].push_back(node);
+      tasks.push_back(node.tsk);
+    }
+
+    // binary reduction tree of R factors, in memory
+    while (levels.back().size() > 1) {
+      std::vector<TsqrNode<T>>& below = levels.back();
+      std::vector<TsqrNode<T>>  level;
+      for (FBLAS_UINT c = 0; c < below.size(); c += 2) {
+        if (c + 1 == below.size()) {
+          // odd one out; carried up unchanged
+          TsqrNode<T> node = below[c];
+          node.q = nullptr;
+          level.push_back(node);
+          continue;
+        }
+        TsqrNode<T> node;
+        node.r = new T[n * n];
+        node.q = (write_q ? new T[2 * n * n] : nullptr);
+        node.tsk = new TsqrTreeTask<T>({below[c].r, below[c + 1].r}, n, node.r,
+                                       node.q);
+        node.tsk->add_parent(below[c].tsk->get_id());
+        node.tsk->add_parent(below[c + 1].tsk->get_id());
+        level.push_back(node);
+        tasks.push_back(node.tsk);
+      }
+      levels.push_back(level);
+    }
+    GLOG_DEBUG("tree depth=", levels.size() - 1);
+
+    for (auto tsk : tasks) {
+      sched.add_task(tsk);
+    }
+    wait_and_delete(tasks);
+
+    // R of the root, in `mat_ord`
+    T* root_r = levels.back()[0].r;
+    for (FBLAS_UINT i = 0; i < n; i++) {
+      for (FBLAS_UINT j = 0; j < n; j++) {
+        r[col_major ? j * n + i : i * n + j] = root_r[i * n + j];
+      }
+    }
+    delete[] root_r;
+
+    if (!write_q || n_panels == 1) {
+      if (write_q) {
+        sched.flush_cache();
+      }
+      return 0;
+    }
+
+    // W of each node, top-down : W_child = (child's block of parent's Q) *
+    // W_parent; W_root = I
+    std::vector<T*> w(1, new T[n * n]);
+    memset(w[0], 0, n * n * sizeof(T));
+    for (FBLAS_UINT i = 0; i < n; i++) {
+      w[0][i * n + i] = 1.0;
+    }
+    for (FBLAS_UINT l = levels.size() - 1; l > 0; l--) {
+      std::vector<T*> w_below(levels[l - 1].size(), nullptr);
+      for (FBLAS_UINT i = 0; i < levels[l].size(); i++) {
+        TsqrNode<T>& node = levels[l][i];
+        if (node.q == nullptr) {
+          w_below[2 * i] = w[i];
+          continue;
+        }
+        for (FBLAS_UINT c = 0; c < 2; c++) {
+          w_below[2 * i + c] = new T[n * n];
+          MklTraits<T>::gemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, n, n,
+                             n, 1.0, node.q + c * n * n, n, w[i], n, 0.0,
+                             w_below[2 * i + c], n);
+        }
+        delete[] node.q;
+        delete[] w[i];
+      }
+      w.swap(w_below);
+    }
+
+    // second pass over Q : fold the tree into each panel
+    for (FBLAS_UINT p = 0; p < n_panels; p++) {
+      FBLAS_UINT off;
+      StrideInfo sinfo = panel_sinfo(p, lda_q, off);
+      tasks.push_back(new TsqrApplyTask<T>(q + off, sinfo, panel_rows(p), n,
+                                           col_major, w[p]));
+      sched.add_task(tasks.back());
+    }
+    wait_and_delete(tasks);
+    for (auto wp : w) {
+      delete[] wp;
+    }
+
+    // flush cache
+    sched.flush_cache();
+    return 0;
+  }
+
+  template FBLAS_INT tsqr<float>(CHAR, FBLAS_UINT, FBLAS_UINT, flash_ptr<float>,
+                                 float*, flash_ptr<float>, FBLAS_UINT,
+                                 FBLAS_UINT);
+  template FBLAS_INT tsqr<double>(CHAR, FBLAS_UINT, FBLAS_UINT,
+                                  flash_ptr<double>, double*, flash_ptr<double>,
+                                  FBLAS_UINT, FBLAS_UINT);
+}  // namespace flash
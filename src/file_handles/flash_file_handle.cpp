@@ -4,8 +4,10 @@
 #include "file_handles/flash_file_handle.h"
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <malloc.h>
 #include <sys/mman.h>
+#include <sys/uio.h>
 #include <unistd.h>
 // #include <xfs/xfs.h>
 #include <algorithm>
@@ -19,10 +21,8 @@
 #include "bof_types.h"
 #include "bof_utils.h"
 
-// max chunk size to fetch/put from/to disk in one request
-// NOTE : Some devices might have higher throughput with more requests of
-// smaller sizes (IOPS heavy)
-#define MAX_CHUNK_SIZE ((FBLAS_UINT) 1 << 25)
+// max # of iovecs in one vectored request
+#define MAX_IOVS ((FBLAS_UINT) IOV_MAX)
 
 namespace {
   void submit_and_reap(io_context_t ctx, struct iocb* cb, FBLAS_UINT n_requests,
@@ -101,6 +101,33 @@ namespace {
     delete[] cb;
   }
 
+  // same as `execute_io`, but each request is a vectored write
+  void execute_iov(io_context_t ctx, int fd, std::vector<FBLAS_UINT>& offsets,
+                   std::vector<std::vector<struct iovec>>& iovs,
+                   FBLAS_UINT max_ops = MAX_SIMUL_REQS) {
+    FBLAS_UINT   n_ops = offsets.size();
+    struct iocb* cb = new struct iocb[max_ops];
+    FBLAS_UINT   n_iters = ROUND_UP(n_ops, max_ops) / max_ops;
+
+    // submit and reap atmost `max_ops` in each iter
+    for (FBLAS_UINT i = 0; i < n_iters; i++) {
+      FBLAS_UINT start_idx = (max_ops * i);
+      FBLAS_UINT cur_nops = std::min(n_ops - start_idx, max_ops);
+
+      for (FBLAS_UINT j = 0; j < cur_nops; j++) {
+        std::vector<struct iovec>& iov = iovs[start_idx + j];
+        io_prep_pwritev(cb + j, fd, iov.data(), (int) iov.size(),
+                        offsets[start_idx + j]);
+      }
+
+      submit_and_reap(ctx, cb, cur_nops);
+
+      memset(cb, 0, max_ops * sizeof(struct iocb));
+    }
+
+    delete[] cb;
+  }
+
   // return `buf` offset by `offset`
   template<typename T>
   T* offset_buf(T* buf, FBLAS_UINT offset) {
@@ -136,6 +163,7 @@ namespace flash {
   // defining because C++ complains otherwise
   std::unordered_map<std::thread::id, io_context_t> FlashFileHandle::ctx_map;
   std::mutex FlashFileHandle::ctx_mut;
+  std::atomic<FBLAS_UINT> FlashFileHandle::chunk_size(DEFAULT_CHUNK_SIZE);
 
   io_context_t FlashFileHandle::get_ctx() {
 #ifdef DEBUG
@@ -263,6 +291,8 @@ namespace flash {
     bool       alloc = false;
     FBLAS_UINT start_offset = ROUND_DOWN(offset, SECTOR_LEN);
     FBLAS_UINT read_len = ROUND_UP(offset + len, SECTOR_LEN) - start_offset;
+    // fixed for this request even if changed concurrently
+    const FBLAS_UINT        chunk = FlashFileHandle::chunk_size.load();
     std::vector<FBLAS_UINT> offsets;
     std::vector<FBLAS_UINT> sizes;
     std::vector<void*>      bufs;
@@ -276,23 +306,22 @@ namespace flash {
       read_buf = buf;
     }
     // if only one request
-    if (read_len <= MAX_CHUNK_SIZE) {
+    if (read_len <= chunk) {
       // push params
       offsets.push_back(start_offset);
       sizes.push_back(read_len);
       bufs.push_back(read_buf);
     } else {
       // break down request into multiple requests
-      FBLAS_UINT n_requests =
-          ROUND_UP(read_len, MAX_CHUNK_SIZE) / MAX_CHUNK_SIZE;
+      FBLAS_UINT n_requests = ROUND_UP(read_len, chunk) / chunk;
       offsets.resize(n_requests);
       sizes.resize(n_requests);
       bufs.resize(n_requests);
       for (FBLAS_UINT i = 0; i < n_requests; i++) {
         // calculate parameters for this read
-        bufs[i] = offset_buf(read_buf, i * MAX_CHUNK_SIZE);
-        offsets[i] = start_offset + i * MAX_CHUNK_SIZE;
-        sizes[i] = std::min(MAX_CHUNK_SIZE, read_len - (i * MAX_CHUNK_SIZE));
+        bufs[i] = offset_buf(read_buf, i * chunk);
+        offsets[i] = start_offset + i * chunk;
+        sizes[i] = std::min(chunk, read_len - (i * chunk));
       }
     }
 
@@ -329,8 +358,9 @@ namespace flash {
     FBLAS_UINT start_offset = ROUND_DOWN(offset, SECTOR_LEN);
     FBLAS_UINT end_offset = ROUND_UP(offset + len, SECTOR_LEN);
     FBLAS_UINT write_len = end_offset - start_offset;
-    FBLAS_UINT n_requests =
-        ROUND_UP(write_len, MAX_CHUNK_SIZE) / MAX_CHUNK_SIZE;
+    // fixed for this request even if changed concurrently
+    const FBLAS_UINT chunk = FlashFileHandle::chunk_size.load();
+    FBLAS_UINT       n_requests = ROUND_UP(write_len, chunk) / chunk;
     bool alloc = false;
 
     std::vector<FBLAS_UINT> offsets;
@@ -379,9 +409,9 @@ namespace flash {
     bufs.resize(n_requests);
     for (FBLAS_UINT i = 0; i < n_requests; i++) {
       // calculate parameters for this read
-      bufs[i] = offset_buf(write_buf, i * MAX_CHUNK_SIZE);
-      offsets[i] = start_offset + i * MAX_CHUNK_SIZE;
-      sizes[i] = std::min(MAX_CHUNK_SIZE, write_len - (i * MAX_CHUNK_SIZE));
+      bufs[i] = offset_buf(write_buf, i * chunk);
+      offsets[i] = start_offset + i * chunk;
+      sizes[i] = std::min(chunk, write_len - (i * chunk));
     }
 
     // execute io
@@ -715,6 +745,108 @@ namespace flash {
     return 0;
   }
 
+  FBLAS_INT FlashFileHandle::gwrite(FBLAS_UINT offset, StrideInfo sinfo,
+                                    const GatherList&                gbufs,
+                                    const std::function<void(void)>& callback) {
+    GLOG_ASSERT(!gbufs.empty(), "empty gather list");
+    GLOG_ASSERT(sinfo.n_strides != 0, "n_strides = 0; update to n_strides = 1");
+    const FBLAS_UINT lps = sinfo.len_per_stride;
+    const FBLAS_UINT n_strides = sinfo.n_strides;
+    if (lps == 0) {
+      GLOG_WARN("0 len gwrite");
+      return 0;
+    }
+
+    // segments can be used in-place only if each of them is aligned, and (for
+    // strided writes) no stride straddles two segments
+    FBLAS_UINT total_len = 0;
+    bool       in_place = IS_ALIGNED(offset) && IS_ALIGNED(lps) &&
+                    (n_strides == 1 || IS_ALIGNED(sinfo.stride));
+    for (auto& buf_len : gbufs) {
+      total_len += buf_len.second;
+      in_place = in_place && IS_ALIGNED(buf_len.first) &&
+                 IS_ALIGNED(buf_len.second) &&
+                 (n_strides == 1 || buf_len.second % lps == 0);
+    }
+    GLOG_ASSERT_EQ(total_len, n_strides * lps);
+
+    // stage into one buffer; unaligned edges are then read-modified-written
+    // once for the whole gather list instead of once per segment
+    if (!in_place) {
+      void* stage_buf = nullptr;
+      alloc_aligned(&stage_buf, ROUND_UP(total_len, SECTOR_LEN), SECTOR_LEN);
+      FBLAS_UINT stage_off = 0;
+      for (auto& buf_len : gbufs) {
+        memcpy(offset_buf(stage_buf, stage_off), buf_len.first,
+               buf_len.second);
+        stage_off += buf_len.second;
+      }
+      if (n_strides == 1) {
+        this->write(offset, lps, stage_buf);
+      } else {
+        this->swrite(offset, sinfo, stage_buf);
+      }
+      free(stage_buf);
+
+      // execute callback
+      callback();
+
+      return 0;
+    }
+
+    io_context_t ctx = FlashFileHandle::get_ctx();
+    if (n_strides == 1) {
+      // pack segments into vectored requests of atmost `chunk_size` bytes
+      const FBLAS_UINT chunk = FlashFileHandle::chunk_size.load();
+
+      std::vector<FBLAS_UINT>                offsets(1, offset);
+      std::vector<std::vector<struct iovec>> iovs(1);
+      FBLAS_UINT                             cur_len = 0;
+      for (auto& buf_len : gbufs) {
+        FBLAS_UINT seg_off = 0;
+        while (seg_off < buf_len.second) {
+          if (cur_len == chunk || iovs.back().size() == MAX_IOVS) {
+            offsets.push_back(offsets.back() + cur_len);
+            iovs.emplace_back();
+            cur_len = 0;
+          }
+          FBLAS_UINT piece_len =
+              std::min(buf_len.second - seg_off, chunk - cur_len);
+          struct iovec iov;
+          iov.iov_base = offset_buf(buf_len.first, seg_off);
+          iov.iov_len = piece_len;
+          iovs.back().push_back(iov);
+          seg_off += piece_len;
+          cur_len += piece_len;
+        }
+      }
+
+      // execute writes
+      execute_iov(ctx, this->file_desc, offsets, iovs);
+    } else {
+      // each stride lies entirely in one segment; write directly from it
+      std::vector<FBLAS_UINT> starts(n_strides, 0);
+      std::vector<FBLAS_UINT> sizes(n_strides, lps);
+      std::vector<void*>      bufs(n_strides, nullptr);
+      FBLAS_UINT              idx = 0;
+      for (auto& buf_len : gbufs) {
+        for (FBLAS_UINT seg_off = 0; seg_off < buf_len.second;
+             seg_off += lps, idx++) {
+          starts[idx] = offset + (sinfo.stride * idx);
+          bufs[idx] = offset_buf(buf_len.first, seg_off);
+        }
+      }
+
+      // execute writes
+      execute_io(ctx, this->file_desc, starts, sizes, bufs, true);
+    }
+
+    // execute callback
+    callback();
+
+    return 0;
+  }
+
   FBLAS_INT FlashFileHandle::scopy(FBLAS_UINT self_offset, BaseFileHandle& dest,
                                    FBLAS_UINT dest_offset, StrideInfo sinfo,
                                    const std::function<void(void)>& callback) {
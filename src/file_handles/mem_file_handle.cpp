@@ -122,6 +122,32 @@ FBLAS_INT flash::MemFileHandle::swrite(
   return 0;
 }
 
+FBLAS_INT flash::MemFileHandle::gwrite(
+    FBLAS_UINT offset, StrideInfo sinfo, const GatherList& gbufs,
+    const std::function<void(void)>& callback) {
+  assert(sinfo.len_per_stride != 0);
+  assert(this->file_ptr != nullptr);
+
+  // gather segments into one contiguous buffer
+  char*      buf = new char[sinfo.n_strides * sinfo.len_per_stride];
+  FBLAS_UINT buf_off = 0;
+  for (auto& buf_len : gbufs) {
+    memcpy(buf + buf_off, buf_len.first, buf_len.second);
+    buf_off += buf_len.second;
+  }
+
+  // issue strided write
+  this->swrite(offset, sinfo, buf);
+
+  // free mem
+  delete[] buf;
+
+  callback();
+
+  // return success
+  return 0;
+}
+
 FBLAS_INT flash::MemFileHandle::scopy(
     FBLAS_UINT self_offset, BaseFileHandle& dest, FBLAS_UINT dest_offset,
     StrideInfo sinfo, const std::function<void(void)>& callback) {
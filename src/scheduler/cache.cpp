@@ -2,7 +2,11 @@
 // Licensed under the MIT license.
 
 #include "scheduler/cache.h"
+#include <algorithm>
 #include "bof_timer.h"
+#include "scheduler/numa.h"
+#include "scheduler/stats.h"
+#include "scheduler/tracer.h"
 
 namespace {
   void print_keys_if_not_empty(
@@ -16,6 +20,51 @@ namespace {
     print_keys_if_not_empty(map);
     GLOG_ASSERT(map.empty(), "map not empty");
   }
+
+  // # of bytes on disk written back for `k`
+  FBLAS_UINT disk_size(const flash::Key &k) {
+    return k.sinfo.n_strides * k.sinfo.len_per_stride;
+  }
+
+  // [start, end) byte range on disk spanned by `k`
+  std::pair<FBLAS_UINT, FBLAS_UINT> disk_extent(const flash::Key &k) {
+    FBLAS_UINT start = k.fptr.foffset;
+    FBLAS_UINT end = start + (k.sinfo.n_strides - 1) * k.sinfo.stride +
+                     k.sinfo.len_per_stride;
+    return std::make_pair(start, end);
+  }
+
+  // returns `true` if extents of `k1` and `k2` overlap in the same file
+  bool extents_overlap(const flash::Key &k1, const flash::Key &k2) {
+    if (k1.fptr.fop != k2.fptr.fop) {
+      return false;
+    }
+    auto e1 = disk_extent(k1);
+    auto e2 = disk_extent(k2);
+    return !((e1.second <= e2.first) || (e2.second <= e1.first));
+  }
+
+  // orders keys by file, access shape and then file offset so that keys
+  // adjacent on disk end up next to each other
+  bool disk_order(const flash::Key &left, const flash::Key &right) {
+    if (left.fptr.fop != right.fptr.fop) {
+      return left.fptr.fop < right.fptr.fop;
+    }
+    bool l_contig = (left.sinfo.n_strides == 1);
+    bool r_contig = (right.sinfo.n_strides == 1);
+    if (l_contig != r_contig) {
+      return l_contig;
+    }
+    if (!l_contig) {
+      if (left.sinfo.stride != right.sinfo.stride) {
+        return left.sinfo.stride < right.sinfo.stride;
+      }
+      if (left.sinfo.len_per_stride != right.sinfo.len_per_stride) {
+        return left.sinfo.len_per_stride < right.sinfo.len_per_stride;
+      }
+    }
+    return left.fptr.foffset < right.fptr.foffset;
+  }
 }  // namespace
 
 namespace flash {
@@ -23,7 +72,22 @@ namespace flash {
       : io_exec(io_exec), max_size(max_size) {
     this->real_size = 0;
     this->commit_size = 0;
+    this->n_hits = 0;
+    this->n_misses = 0;
+    this->n_evictions = 0;
+    this->n_write_backs = 0;
+    this->peak_real_size = 0;
+    this->peak_commit_size = 0;
     this->single_use_discard = false;
+    this->coalesce_window = ((FBLAS_UINT) 1 << 26);
+    this->persistent = false;
+    this->retain_size = max_size / 2;
+    this->background_flush = false;
+    this->dirty_high_ratio = 0.5f;
+    this->dirty_low_ratio = 0.25f;
+    this->flush_batch = ((FBLAS_UINT) 1 << 28);
+    this->numa = false;
+    this->next_node = 0;
   }
 
   Cache::~Cache() {
@@ -46,18 +110,29 @@ namespace flash {
     GLOG_DEBUG("checking if active_map is empty");
     assert_and_print(this->active_map);
     GLOG_DEBUG("checking if zero_ref_map is empty");
-    if (!this->zero_ref_map.empty()) {
-      std::unordered_set<Key> evict_keys;
-      for (auto &k_v : this->zero_ref_map) {
-        evict_keys.insert(k_v.first);
+    // background write-backs may return buffers to `zero_ref_map` while
+    // waiting on `io_map`; repeat until both are drained
+    mutex_locker lk(this->cache_mut);
+    while (!this->zero_ref_map.empty() || !this->io_map.empty()) {
+      if (!this->zero_ref_map.empty()) {
+        std::unordered_set<Key> evict_keys;
+        for (auto &k_v : this->zero_ref_map) {
+          evict_keys.insert(k_v.first);
+        }
+        this->evict(evict_keys, false);
       }
-      this->evict(evict_keys);
-    }
-    while (!this->io_map.empty()) {
-      GLOG_DEBUG("waiting for cache to flush to disk");
-      service_backlog();
-      usleep(100 * 1000);  // 100ms
+      lk.unlock();
+      while (!this->io_map.empty()) {
+        GLOG_DEBUG("waiting for cache to flush to disk");
+        service_backlog();
+        usleep(100 * 1000);  // 100ms
+      }
+      lk.lock();
     }
+    lk.unlock();
+    this->ctier.clear();
+    this->ftier.clear();
+    this->log_tier_stats();
 
     assert_and_print(this->zero_ref_map);
     GLOG_DEBUG("checking if io_map is empty");
@@ -69,7 +144,199 @@ namespace flash {
     GLOG_PASS("cache flushed to disk");
   }
 
-  void Cache::evict(const std::unordered_set<Key> &keys) {
+  void Cache::flush_retain() {
+    GLOG_DEBUG("checking if active_map is empty");
+    assert_and_print(this->active_map);
+
+    mutex_locker lk(this->cache_mut);
+    // buffers being written back in the background return to `zero_ref_map`
+    // as clean; wait for them so they count against `retain_size`
+    std::unordered_set<Key> cleaned_keys;
+    while (true) {
+      bool cleaning = false;
+      for (auto &k_v : this->io_map) {
+        if (k_v.second.cleaning) {
+          cleaned_keys.insert(k_v.first);
+          cleaning = true;
+        }
+      }
+      if (!cleaning) {
+        break;
+      }
+      lk.unlock();
+      service_backlog();
+      usleep(10 * 1000);  // 10ms
+      lk.lock();
+    }
+
+    std::vector<Key> dirty_keys;
+    std::vector<Key> clean_keys;
+    for (auto &k_v : this->zero_ref_map) {
+      // pins don't outlive the call that set them
+      k_v.second.pinned = false;
+      if (k_v.second.write_back) {
+        dirty_keys.push_back(k_v.first);
+      } else {
+        clean_keys.push_back(k_v.first);
+      }
+    }
+    // `k` overlaps a buf written to disk by this call, other than itself
+    auto is_stale = [&dirty_keys, &cleaned_keys](const Key &k) {
+      for (auto &dirty_k : dirty_keys) {
+        if (extents_overlap(k, dirty_k)) {
+          return true;
+        }
+      }
+      for (auto &cleaned_k : cleaned_keys) {
+        if (!(cleaned_k == k) && extents_overlap(k, cleaned_k)) {
+          return true;
+        }
+      }
+      return false;
+    };
+
+    // evict dirty keys, stale clean keys, and clean keys beyond `retain_size`
+    std::unordered_set<Key> evict_keys;
+    std::unordered_set<Key> stale_keys;
+    for (auto &k : dirty_keys) {
+      if (is_zero_ref(k)) {
+        stale_keys.insert(k);
+      }
+    }
+    FBLAS_UINT retained_size = 0;
+    for (auto &k : clean_keys) {
+      if (is_stale(k)) {
+        stale_keys.insert(k);
+      } else if (retained_size + buf_size(k.sinfo) > this->retain_size) {
+        evict_keys.insert(k);
+      } else {
+        retained_size += buf_size(k.sinfo);
+      }
+    }
+    this->evict(stale_keys, false);
+    this->evict(evict_keys);
+    lk.unlock();
+
+    while (!this->io_map.empty()) {
+      GLOG_DEBUG("waiting for cache to flush to disk");
+      service_backlog();
+      usleep(100 * 1000);  // 100ms
+    }
+
+    // victims are added to tiers asynchronously; drop stale ones once all
+    // are in
+    this->ctier.erase_if(is_stale);
+    this->ftier.erase_if(is_stale);
+
+    GLOG_PASS("cache flushed to disk, retained ", retained_size, " bytes");
+  }
+
+  void Cache::evict_file(const BaseFileHandle *fop) {
+    mutex_locker lk(this->cache_mut);
+    for (auto &k_v : this->active_map) {
+      if (k_v.first.fptr.fop == fop) {
+        GLOG_WARN("not evicting active buf:", std::string(k_v.first));
+      }
+    }
+
+    // background write-backs may return buffers to `zero_ref_map` while
+    // waiting on `io_map`; repeat until no buffer of `fop` is left
+    while (true) {
+      std::unordered_set<Key> evict_keys;
+      for (auto &k_v : this->zero_ref_map) {
+        if (k_v.first.fptr.fop == fop) {
+          evict_keys.insert(k_v.first);
+        }
+      }
+      this->evict(evict_keys, false);
+
+      bool in_io = false;
+      for (auto &k_v : this->io_map) {
+        if (k_v.first.fptr.fop == fop) {
+          in_io = true;
+          break;
+        }
+      }
+      if (!in_io && evict_keys.empty()) {
+        break;
+      }
+
+      lk.unlock();
+      service_backlog();
+      usleep(10 * 1000);  // 10ms
+      lk.lock();
+    }
+    lk.unlock();
+    auto of_file = [fop](const Key &k) { return k.fptr.fop == fop; };
+    this->ctier.erase_if(of_file);
+    this->ftier.erase_if(of_file);
+  }
+
+  void Cache::flush_dirty(bool io_idle) {
+    mutex_locker lk(this->cache_mut);
+    if (!this->background_flush) {
+      return;
+    }
+
+    // dirty footprint, and zero-ref dirty candidates for write-back
+    FBLAS_UINT       dirty_size = 0;
+    std::vector<Key> dirty_keys;
+    for (auto &k_v : this->active_map) {
+      if (k_v.second.write_back) {
+        dirty_size += buf_size(k_v.first.sinfo);
+      }
+    }
+    for (auto &k_v : this->zero_ref_map) {
+      if (k_v.second.write_back) {
+        dirty_size += buf_size(k_v.first.sinfo);
+        // pinned bufs are written again by the next task
+        if (!k_v.second.pinned) {
+          dirty_keys.push_back(k_v.first);
+        }
+      }
+    }
+    if (dirty_keys.empty()) {
+      return;
+    }
+
+    FBLAS_UINT high_size = (FBLAS_UINT)(this->dirty_high_ratio * this->max_size);
+    FBLAS_UINT low_size = (FBLAS_UINT)(this->dirty_low_ratio * this->max_size);
+    FBLAS_UINT clean_size = 0;
+    if (dirty_size > high_size) {
+      clean_size = dirty_size - low_size;
+    } else if (io_idle) {
+      clean_size = this->flush_batch;
+    } else {
+      return;
+    }
+
+    // pick keys in disk order so that picked keys coalesce
+    std::sort(dirty_keys.begin(), dirty_keys.end(), disk_order);
+    std::vector<Key> clean_keys;
+    FBLAS_UINT       picked_size = 0;
+    for (auto &k : dirty_keys) {
+      if (picked_size >= clean_size) {
+        break;
+      }
+      picked_size += buf_size(k.sinfo);
+
+      // move to `io_map` until write-back completes
+      Value v = this->zero_ref_map[k];
+      this->zero_ref_map.erase(k);
+      v.write_back = false;
+      v.cleaning = true;
+      this->add_to_io(k, v, false);
+      clean_keys.push_back(k);
+    }
+
+    GLOG_DEBUG("FLUSH:dirty_size=", dirty_size, ", cleaning=", picked_size,
+               ", io_idle=", io_idle);
+    this->issue_write_backs(clean_keys, false);
+  }
+
+  void Cache::evict(const std::unordered_set<Key> &keys, bool keep_victims) {
+    std::vector<Key> write_keys;
+    flash_ptr<void>  tier_fptr;
     for (auto &k : keys) {
       GLOG_ASSERT(is_zero_ref(k), "attempted to evict non-zero-ref buf");
       Value v = this->zero_ref_map[k];
@@ -79,37 +346,202 @@ namespace flash {
       this->zero_ref_map.erase(k);
       auto sub_size = buf_size(k.sinfo);
       this->commit_size -= sub_size;
+      this->n_evictions++;
       GLOG_DEBUG("EVICT:", sub_size, ", commit_size=", this->commit_size);
+      trace::instant("cache", v.write_back ? "evict-dirty" : "evict", "bytes",
+                     sub_size);
       // check if `write_back`
       if (v.write_back) {
         v.evicted = true;
 
-        // NOTE :: v.complete will be freed when completion is reaped
-        v.complete = new std::atomic<bool>(false);
-        auto completion = v.complete;
-        auto buf = v.buf;
-        auto real_size_ptr = &(this->real_size);
-        auto callback = [completion, buf, real_size_ptr, sub_size]() {
-          completion->store(true);
-          free(buf);
-          real_size_ptr->fetch_sub(sub_size);
-          GLOG_DEBUG("DEALLOC:", sub_size,
-                     ", real_size=", real_size_ptr->load());
-        };
-
-        // add entry to map
-        this->io_map[k] = v;
-
-        // construct and issue write
-        this->io_exec.add_write(k.fptr, k.sinfo, v.buf, callback);
+        // add entry to map; write issued below
+        this->add_to_io(k, v, false);
+        write_keys.push_back(k);
+      } else if (keep_victims && this->ctier.enabled()) {
+        // R-only buf; compressed (or copied to flash tier) on an IO thread,
+        // freed once kept
+        v.evicted = true;
+        auto   entry = this->add_to_io(k, v, false);
+        Cache *cache = this;
+        this->io_exec.add_work(
+            [cache, entry, sub_size]() { cache->keep_victim(entry, sub_size); },
+            IoPriority::WriteBack);
+      } else if (keep_victims &&
+                 this->ftier.reserve(k, ROUND_UP(sub_size, SECTOR_LEN),
+                                     tier_fptr)) {
+        // R-only buf; copy to flash tier, free once written
+        v.evicted = true;
+        this->spill(this->add_to_io(k, v, false), sub_size, tier_fptr);
       } else {
-        // R-only buf
+        // R-only buf; freed
         free(v.buf);
         this->real_size.fetch_sub(sub_size);
         GLOG_DEBUG("DEALLOC:", sub_size,
                    ", real_size=", this->real_size.load());
       }
     }
+
+    this->issue_write_backs(write_keys, true);
+  }
+
+  void Cache::keep_victim(std::pair<const Key, Value> *entry,
+                          FBLAS_UINT                   len) {
+    flash_ptr<void> tier_fptr;
+    if (!this->ctier.put(entry->first, entry->second.buf, len) &&
+        this->ftier.reserve(entry->first, ROUND_UP(len, SECTOR_LEN),
+                            tier_fptr)) {
+      this->spill(entry, len, tier_fptr);
+      return;
+    }
+    free(entry->second.buf);
+    this->real_size.fetch_sub(len);
+    GLOG_DEBUG("DEALLOC:", len, ", real_size=", this->real_size.load());
+    // `entry` may be reaped from here on
+    entry->second.complete.store(true);
+  }
+
+  void Cache::spill(std::pair<const Key, Value> *entry, FBLAS_UINT len,
+                    flash_ptr<void> tier_fptr) {
+    FBLAS_UINT tier_len = ROUND_UP(len, SECTOR_LEN);
+    auto       ftier = &(this->ftier);
+    auto       real_size_ptr = &(this->real_size);
+    auto callback = [entry, ftier, tier_fptr, real_size_ptr, len]() {
+      ftier->commit(entry->first, tier_fptr, ROUND_UP(len, SECTOR_LEN));
+      free(entry->second.buf);
+      real_size_ptr->fetch_sub(len);
+      // `entry` may be reaped from here on
+      entry->second.complete.store(true);
+    };
+    this->io_exec.add_write(tier_fptr, {tier_len, 1, tier_len},
+                            entry->second.buf, callback);
+  }
+
+  void Cache::log_tier_stats() {
+    if (this->ctier.enabled()) {
+      GLOG_INFO("compressed tier:", std::string(this->ctier.stats));
+    }
+    if (this->ftier.enabled()) {
+      GLOG_INFO("flash tier:", std::string(this->ftier.stats));
+    }
+    if (this->ctier.enabled() || this->ftier.enabled()) {
+      GLOG_INFO("disk:", std::string(this->disk_stats));
+    }
+  }
+
+  void Cache::issue_write_backs(std::vector<Key> &keys, bool evict) {
+    if (keys.empty()) {
+      return;
+    }
+
+    // split write-backs into runs of keys adjacent on disk
+    std::sort(keys.begin(), keys.end(), disk_order);
+    std::vector<Key> run;
+    for (auto &k : keys) {
+      if (!run.empty() && !is_adjacent(run, k)) {
+        this->write_back(run, evict);
+        run.clear();
+      }
+      run.push_back(k);
+    }
+    this->write_back(run, evict);
+  }
+
+  bool Cache::is_adjacent(const std::vector<Key> &run, const Key &next) const {
+    const Key &last = run.back();
+    if (last.fptr.fop != next.fptr.fop) {
+      return false;
+    }
+
+    // respect coalescing window
+    FBLAS_UINT run_size = disk_size(next);
+    for (auto &k : run) {
+      run_size += disk_size(k);
+    }
+    if (run_size > this->coalesce_window) {
+      return false;
+    }
+
+    const StrideInfo &l_sinfo = last.sinfo;
+    const StrideInfo &n_sinfo = next.sinfo;
+    if (l_sinfo.n_strides == 1 && n_sinfo.n_strides == 1) {
+      // contiguous : `next` starts where `last` ends
+      return (last.fptr.foffset + l_sinfo.len_per_stride == next.fptr.foffset);
+    } else if (l_sinfo.n_strides > 1 && n_sinfo.n_strides > 1) {
+      // strided : same columns, `next` starts at the row after `last` ends
+      return (l_sinfo.stride == n_sinfo.stride) &&
+             (l_sinfo.len_per_stride == n_sinfo.len_per_stride) &&
+             (last.fptr.foffset + l_sinfo.n_strides * l_sinfo.stride ==
+              next.fptr.foffset);
+    } else {
+      return false;
+    }
+  }
+
+  void Cache::write_back(const std::vector<Key> &run, bool evict) {
+    GLOG_ASSERT(!run.empty(), "empty write-back run");
+    this->n_write_backs += run.size();
+    // chain entries of the run through `next_in_run`
+    std::pair<const Key, Value> *head = nullptr;
+    std::pair<const Key, Value> *tail = nullptr;
+    for (auto &k : run) {
+      GLOG_ASSERT(is_in_io(k), "write-back key not in io_map");
+      auto entry = &(*this->io_map.find(k));
+      entry->second.next_in_run = nullptr;
+      if (tail == nullptr) {
+        head = entry;
+      } else {
+        tail->second.next_in_run = entry;
+      }
+      tail = entry;
+    }
+
+    auto real_size_ptr = &(this->real_size);
+    auto callback = [head, real_size_ptr, evict]() {
+      auto entry = head;
+      while (entry != nullptr) {
+        // `entry` may be reaped once complete; read it first
+        auto       next = entry->second.next_in_run;
+        void *     buf = entry->second.buf;
+        FBLAS_UINT size = buf_size(entry->first.sinfo);
+        entry->second.complete.store(true);
+        entry = next;
+        if (!evict) {
+          continue;
+        }
+        free(buf);
+        real_size_ptr->fetch_sub(size);
+        GLOG_DEBUG("DEALLOC:", size, ", real_size=", real_size_ptr->load());
+      }
+    };
+
+    // construct and issue write
+    const Key &first = run.front();
+    if (run.size() == 1) {
+      this->io_exec.add_write(first.fptr, first.sinfo, head->second.buf,
+                              callback);
+      return;
+    }
+
+    GatherList gbufs;
+    for (auto entry = head; entry != nullptr;
+         entry = entry->second.next_in_run) {
+      gbufs.push_back(
+          std::make_pair(entry->second.buf, disk_size(entry->first)));
+    }
+    StrideInfo sinfo = first.sinfo;
+    if (sinfo.n_strides == 1) {
+      sinfo.len_per_stride = 0;
+      for (auto &k : run) {
+        sinfo.len_per_stride += k.sinfo.len_per_stride;
+      }
+    } else {
+      sinfo.n_strides = 0;
+      for (auto &k : run) {
+        sinfo.n_strides += k.sinfo.n_strides;
+      }
+    }
+    GLOG_DEBUG("COALESCE:n_keys=", run.size(), ", sinfo=", std::string(sinfo));
+    this->io_exec.add_write(first.fptr, sinfo, std::move(gbufs), callback);
   }
 
   bool Cache::try_evict(const std::unordered_set<Key> &exclude_keys,
@@ -120,16 +552,20 @@ namespace flash {
     }
 
     // check if operation is possible
+    // unpinned keys first, then pinned keys
     FBLAS_UINT              evicted_size = 0;
     std::unordered_set<Key> evict_keys;
-    for (const auto &k_v : zero_ref_map) {
-      const Key &key = k_v.first;
-      // `key` not asked to be excluded
-      if (exclude_keys.find(key) == exclude_keys.end()) {
-        evicted_size += buf_size(key.sinfo);
-        evict_keys.insert(key);
-        if (evicted_size >= evict_size) {
-          break;
+    for (int pass = 0; pass < 2 && evicted_size < evict_size; pass++) {
+      for (const auto &k_v : zero_ref_map) {
+        const Key &key = k_v.first;
+        // `key` not asked to be excluded
+        if (k_v.second.pinned == (pass == 1) &&
+            exclude_keys.find(key) == exclude_keys.end()) {
+          evicted_size += buf_size(key.sinfo);
+          evict_keys.insert(key);
+          if (evicted_size >= evict_size) {
+            break;
+          }
         }
       }
     }
@@ -157,7 +593,7 @@ namespace flash {
       found = true;
       this->active_map[k].n_refs++;
     } else if (is_in_io(k) && !this->io_map[k].evicted &&
-               this->io_map[k].complete->load()) {
+               this->io_map[k].complete.load()) {
       reap_io_completion(k);
       move_io_to_active(k);
       found = true;
@@ -177,8 +613,41 @@ namespace flash {
     return result;
   }
 
-  void Cache::add_backlog(const Key &k, bool alloc_only, bool write_back) {
+  FBLAS_UINT Cache::pick_node(const std::unordered_set<Key> &keys) {
+    std::vector<FBLAS_UINT> node_bytes(numa::n_nodes(), 0);
+    bool                    found = false;
+    for (auto &key : keys) {
+      Value *v = nullptr;
+      if (is_active(key)) {
+        v = &this->active_map[key];
+      } else if (is_zero_ref(key)) {
+        v = &this->zero_ref_map[key];
+      } else if (is_in_io(key) && !this->io_map[key].evicted) {
+        v = &this->io_map[key];
+      }
+      if (v != nullptr && v->node < node_bytes.size()) {
+        node_bytes[v->node] += buf_size(key.sinfo);
+        found = true;
+      }
+    }
+    if (!found) {
+      this->next_node = (this->next_node + 1) % node_bytes.size();
+      return this->next_node;
+    }
+    return std::max_element(node_bytes.begin(), node_bytes.end()) -
+           node_bytes.begin();
+  }
+
+  void Cache::add_backlog(const Key &k, bool alloc_only, bool write_back,
+                          bool prefetch, FBLAS_UINT node) {
     if (is_queued(k)) {
+      if (!prefetch) {
+        for (auto &k_v : this->alloc_backlog) {
+          if (k_v.first == k) {
+            k_v.second.prefetch = false;
+          }
+        }
+      }
       return;
     }
 
@@ -186,6 +655,7 @@ namespace flash {
     this->commit_size += buf_size(k.sinfo);
     GLOG_ASSERT(this->commit_size <= this->max_size,
                 "got commit_size=", commit_size, ", max_mem=", max_size);
+    update_peak(this->peak_commit_size, this->commit_size);
     GLOG_DEBUG("COMMIT:", buf_size(k.sinfo),
                ", commit_size=", this->commit_size);
 
@@ -193,6 +663,8 @@ namespace flash {
     Value v;
     v.alloc_only = alloc_only;
     v.write_back = write_back;
+    v.prefetch = prefetch;
+    v.node = node;
     // add to backlog
     // this->alloc_backlog.[k] = v;
     this->alloc_backlog.push_back(std::make_pair(k, v));
@@ -200,14 +672,20 @@ namespace flash {
 
   void Cache::reap_io_completion(const Key &k) {
     GLOG_ASSERT(is_in_io(k), "bad reap issue");
-    Value &v = this->io_map[k];
-    GLOG_ASSERT(v.complete->load(), "tried to reap incomplete I/O");
+    GLOG_ASSERT(this->io_map.find(k)->second.complete.load(),
+                "tried to reap incomplete I/O");
+  }
 
-    delete v.complete;
-    v.complete = nullptr;
+  std::pair<const Key, Value> *Cache::add_to_io(const Key &k, const Value &v,
+                                                bool complete) {
+    GLOG_ASSERT(!is_in_io(k), "I/O already in progress");
+    auto it = this->io_map.insert(std::make_pair(k, v)).first;
+    it->second.complete.store(complete);
+    it->second.next_in_run = nullptr;
+    return &(*it);
   }
 
-  void Cache::alloc_bufs(BaseTask *tsk) {
+  void Cache::alloc_bufs(BaseTask *tsk, bool prefetch) {
     std::unordered_set<Key> read_keys;
     std::unordered_set<Key> write_keys;
 
@@ -227,10 +705,20 @@ namespace flash {
     GLOG_ASSERT(union_size <= (read_keys.size() + write_keys.size()),
                 "bad intersection | difference");
 
+    // steer `tsk` to the node holding most of its buffers
+    FBLAS_UINT node = 0;
+    if (this->numa) {
+      std::unordered_set<Key> all_keys(read_keys);
+      all_keys.insert(write_keys.begin(), write_keys.end());
+      node = this->pick_node(all_keys);
+    }
+    tsk->numa_node = node;
+
     // (R \ W) set (R-only)
     for (auto &key : read_only_keys) {
       if (is_active(key)) {
         GLOG_DEBUG("HIT:", std::string(key), ":ACTIVE_MAP");
+        this->n_hits++;
         // FOUND in active
         Value &v = this->active_map[key];
         v.n_refs++;
@@ -240,25 +728,32 @@ namespace flash {
         Value &v = this->io_map[key];
         if (v.evicted) {
           GLOG_DEBUG("MISS:", std::string(key), ":EVICTED");
-          add_backlog(key, false, false);
+          this->n_misses++;
+          add_backlog(key, false, false, prefetch, node);
         } else {
-          if (v.complete->load()) {
+          if (v.complete.load()) {
             GLOG_DEBUG("HIT:", std::string(key), ":IO_MAP");
+            this->n_hits++;
             reap_io_completion(key);
             move_io_to_active(key);
             Value &v2 = this->active_map[key];
             v2.n_refs = 1;
             tsk->in_mem_ptrs[key.fptr] = v2.buf;
+          } else if (v.cleaning) {
+            // keep buf cached when write-back completes
+            v.n_refs++;
           }
         }
       } else if (is_zero_ref(key)) {
         GLOG_DEBUG("HIT:", std::string(key), ":ZERO_MAP");
+        this->n_hits++;
         // FOUND in zero-ref
         move_zero_to_active(key);
         tsk->in_mem_ptrs[key.fptr] = this->active_map[key].buf;
       } else {
         GLOG_DEBUG("MISS:", std::string(key), ":QUEUEING");
-        add_backlog(key, false, false);
+        this->n_misses++;
+        add_backlog(key, false, false, prefetch, node);
       }
     }
 
@@ -272,7 +767,7 @@ namespace flash {
         GLOG_ERROR("write-only-buf in zero-ref-map");
       } else {
         GLOG_DEBUG("MISS:", std::string(key), ":QUEUEING");
-        add_backlog(key, true, true);
+        add_backlog(key, true, true, prefetch, node);
       }
     }
 
@@ -281,6 +776,7 @@ namespace flash {
       // skip already already processed keys
       if (is_active(key)) {
         GLOG_DEBUG("HIT:", std::string(key), ":ACTIVE_MAP");
+        this->n_hits++;
         // FOUND in active
         Value &v = this->active_map[key];
         v.n_refs++;
@@ -291,8 +787,9 @@ namespace flash {
         Value &v = this->io_map[key];
         if (v.evicted) {
           GLOG_DEBUG("MISS:", std::string(key), ":EVICTED");
+          this->n_misses++;
           if (!is_queued(key)) {
-            add_backlog(key, false, true);
+            add_backlog(key, false, true, prefetch, node);
           } else {
             /*
             // make buffer write-back if already queued
@@ -301,23 +798,29 @@ namespace flash {
             */
             // wait for read to complete and then mark it as write-back
           }
-        } else if (v.complete->load()) {
+        } else if (v.complete.load()) {
           GLOG_DEBUG("HIT:", std::string(key), ":IO_MAP");
+          this->n_hits++;
           reap_io_completion(key);
           move_io_to_active(key);
           Value &v2 = this->active_map[key];
           v2.n_refs = 1;
           tsk->in_mem_ptrs[key.fptr] = v2.buf;
+        } else if (v.cleaning) {
+          // keep buf cached when write-back completes
+          v.n_refs++;
         }
       } else if (is_zero_ref(key)) {
         GLOG_DEBUG("HIT:", std::string(key), ":ZERO_MAP");
+        this->n_hits++;
         // FOUND in zero-ref
         move_zero_to_active(key);
         tsk->in_mem_ptrs[key.fptr] = this->active_map[key].buf;
         this->active_map[key].write_back = true;
       } else {
         GLOG_DEBUG("MISS:", std::string(key), ":QUEUEING");
-        add_backlog(key, false, true);
+        this->n_misses++;
+        add_backlog(key, false, true, prefetch, node);
       }
     }
   }
@@ -338,12 +841,13 @@ namespace flash {
 
   void Cache::move_io_to_active(const Key &k) {
     Value v = this->io_map[k];
+    v.cleaning = false;
     this->io_map.erase(k);
     this->active_map[k] = v;
     this->active_map[k].n_refs = 1;
   }
 
-  bool Cache::allocate(BaseTask *tsk) {
+  bool Cache::allocate(BaseTask *tsk, bool prefetch) {
     std::unordered_set<Key> ask_keys;
     for (auto &fptr_sinfo : tsk->read_list) {
       ask_keys.insert({fptr_sinfo.first, fptr_sinfo.second});
@@ -374,11 +878,11 @@ namespace flash {
     // NOTE :: C++ standard mandates short-circuit of `||` operator
     if (has_spare_mem_for(ask_size)) {
       GLOG_DEBUG("alloc-because has spare_mem");
-      alloc_bufs(tsk);
+      alloc_bufs(tsk, prefetch);
       alloc = true;
     } else if (try_evict(ask_keys, ask_size)) {
       GLOG_DEBUG("alloc-because evicted");
-      alloc_bufs(tsk);
+      alloc_bufs(tsk, prefetch);
       alloc = true;
     }
 
@@ -399,6 +903,11 @@ namespace flash {
       ret_keys.insert({fptr_sinfo.first, fptr_sinfo.second});
     }
 
+    std::unordered_set<Key> pin_keys;
+    for (auto &fptr_sinfo : tsk->pin_list) {
+      pin_keys.insert({fptr_sinfo.first, fptr_sinfo.second});
+    }
+
     mutex_locker lk(this->cache_mut);
 
     for (auto &key : ret_keys) {
@@ -408,14 +917,16 @@ namespace flash {
         GLOG_DEBUG("write-back:n_refs=", v.n_refs);
       }
       v.n_refs--;
+      v.pinned = (pin_keys.find(key) != pin_keys.end());
 
       // deprecate from active -> zero-ref
       if (v.n_refs == 0) {
-        if (this->single_use_discard) {
+        if (this->single_use_discard && !v.pinned) {
           void *buf = v.buf;
           this->active_map.erase(key);
           FBLAS_UINT bsize = buf_size(key.sinfo);
           this->commit_size -= bsize;
+          this->n_evictions++;
           GLOG_DEBUG("EVICT:", bsize, ", commit_size=", this->commit_size);
           this->real_size.fetch_sub(bsize);
           free(buf);
@@ -435,11 +946,18 @@ namespace flash {
     // cleanup io_map
     // move `k` from `io_map` to `zero_ref_map` if `NOT v.evicted`
     for (auto it = this->io_map.begin(); it != this->io_map.end();) {
-      if (it->second.complete->load()) {
+      if (it->second.complete.load()) {
         reap_io_completion(it->first);
         const Key &k = it->first;
         Value &    v = it->second;
-        if (!v.evicted) {
+        if (v.cleaning && v.n_refs == 0) {
+          // written back, but still cached : clean zero-ref buf
+          v.cleaning = false;
+          GLOG_ASSERT(!is_zero_ref(k), "trying to replace zero-ref buf");
+          this->zero_ref_map[k] = v;
+        } else if (!v.evicted) {
+          // NOTE :: promised while cleaning => same as a completed read
+          v.cleaning = false;
           v.n_refs = 0;
           // buf goes into active AND NOT zero-ref to avoid being evicted again,
           // even though it's already promised to some tasks
@@ -506,29 +1024,72 @@ namespace flash {
       v.write_back |= v.alloc_only;
 
       // alloc buf & update size tracker
-      this->real_size.fetch_add(bsize);
+      update_peak(this->peak_real_size,
+                  this->real_size.fetch_add(bsize) + bsize);
       // v.buf = malloc(bsize);
       alloc_aligned(&v.buf, ROUND_UP(bsize, SECTOR_LEN));
+      if (this->numa) {
+        numa::prefer_node(v.buf, ROUND_UP(bsize, SECTOR_LEN), v.node);
+      }
       GLOG_DEBUG("ALLOC:", ROUND_UP(bsize, SECTOR_LEN),
                  ", real_size=", this->real_size.load());
 
-      if (!v.alloc_only) {
-        v.complete = new std::atomic<bool>(false);
-        auto completion = v.complete;
-        auto callback = [completion]() { completion->store(true); };
+      flash_ptr<void>      tier_fptr;
+      CompressedTier::Blob blob;
+      IoPriority           prio =
+          v.prefetch ? IoPriority::Prefetch : IoPriority::Demand;
+      if (!v.alloc_only && this->ctier.take(k, blob)) {
+        // decompressed on an IO thread, like a read
+        auto  entry = this->add_to_io(k, v, false);
+        auto  completion = &(entry->second.complete);
+        auto  ctier = &(this->ctier);
+        void *buf = v.buf;
+        auto  start = std::chrono::steady_clock::now();
+        auto  callback = [ctier, blob, buf, completion, start]() mutable {
+          ctier->restore(blob, buf);
+          ctier->stats.record(blob.raw_size, start);
+          completion->store(true);
+        };
+        this->io_exec.add_work(callback, prio);
+      } else if (!v.alloc_only && this->ftier.take(k, tier_fptr)) {
+        // add to I/O set
+        auto       entry = this->add_to_io(k, v, false);
+        FBLAS_UINT tier_len = ROUND_UP(bsize, SECTOR_LEN);
+        auto       completion = &(entry->second.complete);
+        auto       ftier = &(this->ftier);
+        auto       start = std::chrono::steady_clock::now();
+        auto       callback = [completion, ftier, tier_fptr, tier_len,
+                         start]() {
+          ftier->release(tier_fptr, tier_len);
+          ftier->stats.record(tier_len, start);
+          completion->store(true);
+        };
 
+        // read from flash tier
+        this->io_exec.add_read(tier_fptr, {tier_len, 1, tier_len}, v.buf,
+                               callback, prio);
+      } else if (!v.alloc_only) {
         // add to I/O set
-        this->io_map[k] = v;
+        auto entry = this->add_to_io(k, v, false);
+        auto completion = &(entry->second.complete);
+        auto disk_stats = &(this->disk_stats);
+        auto start = std::chrono::steady_clock::now();
+        auto callback = [completion, disk_stats, bsize, start]() {
+          disk_stats->record(bsize, start);
+          completion->store(true);
+        };
 
         // read from disk
-        this->io_exec.add_read(k.fptr, k.sinfo, v.buf, callback);
+        this->io_exec.add_read(k.fptr, k.sinfo, v.buf, callback, prio);
       } else {
+        // buf will be overwritten; drop stale copies in victim tiers
+        this->ctier.erase(k);
+        this->ftier.erase(k);
         // memset(v.buf, 0, bsize); -> PERFORMANCE HIT
         // HACK to not get added buffer evicted
-        v.complete = new std::atomic<bool>(true);
         v.evicted = false;
         // this->zero_ref_map[k] = v;
-        this->io_map[k] = v;
+        this->add_to_io(k, v, true);
       }
       alloc_time += timer.elapsed();
 
@@ -546,6 +1107,21 @@ namespace flash {
     lk.unlock();
   }
 
+  void Cache::fill_stats(Stats &stats) {
+    stats.cache_hits = this->n_hits.load();
+    stats.cache_misses = this->n_misses.load();
+    stats.cache_evictions = this->n_evictions.load();
+    stats.cache_write_backs = this->n_write_backs.load();
+    stats.real_size = this->real_size.load();
+    stats.peak_real_size = this->peak_real_size.load();
+    stats.peak_commit_size = this->peak_commit_size.load();
+    stats.compressed_tier_hits = this->ctier.stats.n_reads.load();
+    stats.flash_tier_hits = this->ftier.stats.n_reads.load();
+
+    mutex_locker lk(this->cache_mut);
+    stats.commit_size = this->commit_size;
+  }
+
   void Cache::drop_if_in_cache(std::unordered_set<Key> &keys) {
     mutex_locker lk(this->cache_mut);
     auto         it = keys.begin();
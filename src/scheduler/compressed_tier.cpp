@@ -0,0 +1,351 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "scheduler/cache.h"
+
+namespace {
+  // element width (in bytes) used to group bytes before compression
+  // 8 => exponent bytes of floats & high bytes of 64-bit indices line up
+  const FBLAS_UINT SHUFFLE_WIDTH = 8;
+
+  // LZ77 parameters
+  const FBLAS_UINT MIN_MATCH = 4;
+  const FBLAS_UINT HASH_BITS = 16;
+  const FBLAS_UINT MAX_OFFSET = 65535;
+  // last bytes of input are always emitted as literals
+  const FBLAS_UINT END_LITERALS = 12;
+
+  // per-thread scratch space, grown on demand & re-used across calls
+  thread_local std::vector<char>       shuffle_buf;
+  thread_local std::vector<char>       comp_buf;
+  thread_local std::vector<FBLAS_UINT> hash_table;
+
+  // groups the i-th byte of every `SHUFFLE_WIDTH`-byte element together
+  void shuffle(const char *in, char *out, FBLAS_UINT len) {
+    FBLAS_UINT n_elems = len / SHUFFLE_WIDTH;
+    for (FBLAS_UINT b = 0; b < SHUFFLE_WIDTH; b++) {
+      char *out_b = out + b * n_elems;
+      for (FBLAS_UINT e = 0; e < n_elems; e++) {
+        out_b[e] = in[e * SHUFFLE_WIDTH + b];
+      }
+    }
+    FBLAS_UINT tail = n_elems * SHUFFLE_WIDTH;
+    memcpy(out + tail, in + tail, len - tail);
+  }
+
+  // inverse of `shuffle`
+  void unshuffle(const char *in, char *out, FBLAS_UINT len) {
+    FBLAS_UINT n_elems = len / SHUFFLE_WIDTH;
+    for (FBLAS_UINT b = 0; b < SHUFFLE_WIDTH; b++) {
+      const char *in_b = in + b * n_elems;
+      for (FBLAS_UINT e = 0; e < n_elems; e++) {
+        out[e * SHUFFLE_WIDTH + b] = in_b[e];
+      }
+    }
+    FBLAS_UINT tail = n_elems * SHUFFLE_WIDTH;
+    memcpy(out + tail, in + tail, len - tail);
+  }
+
+  inline uint32_t read32(const char *p) {
+    uint32_t val;
+    memcpy(&val, p, sizeof(uint32_t));
+    return val;
+  }
+
+  inline uint64_t read64(const char *p) {
+    uint64_t val;
+    memcpy(&val, p, sizeof(uint64_t));
+    return val;
+  }
+
+  inline uint32_t hash32(uint32_t val) {
+    return (val * 2654435761u) >> (32 - HASH_BITS);
+  }
+
+  // writes LZ4-style length extension bytes for `len`
+  inline uint8_t *put_len(uint8_t *op, FBLAS_UINT len) {
+    while (len >= 255) {
+      *op++ = 255;
+      len -= 255;
+    }
+    *op++ = (uint8_t) len;
+    return op;
+  }
+
+  // reads LZ4-style length extension bytes
+  inline FBLAS_UINT get_len(const uint8_t *&ip) {
+    FBLAS_UINT len = 0;
+    uint8_t    b;
+    do {
+      b = *ip++;
+      len += b;
+    } while (b == 255);
+    return len;
+  }
+
+  // # of bytes needed to encode a sequence
+  inline FBLAS_UINT seq_size(FBLAS_UINT lit_len, FBLAS_UINT match_len) {
+    return 1 + (lit_len / 255 + 1) + lit_len + 2 + (match_len / 255 + 1);
+  }
+
+  // LZ77 with LZ4-like sequences :
+  // [token][lit-len ext][literals][offset:2][match-len ext]
+  // last sequence has no offset & match
+  // returns compressed size, `0` if output doesn't fit in `max_out` bytes
+  FBLAS_UINT lz_compress(const char *in, FBLAS_UINT len, char *out,
+                         FBLAS_UINT max_out) {
+    std::vector<FBLAS_UINT> &table = hash_table;
+    table.assign((FBLAS_UINT) 1 << HASH_BITS, 0);
+    const char *ip = in;
+    const char *anchor = in;
+    const char *end = in + len;
+    const char *match_limit = (len > END_LITERALS) ? end - END_LITERALS : in;
+    uint8_t *   op = (uint8_t *) out;
+    uint8_t *   oend = (uint8_t *) out + max_out;
+
+    while (ip < match_limit) {
+      uint32_t    seq = read32(ip);
+      uint32_t    h = hash32(seq);
+      const char *ref = in + table[h];
+      table[h] = (FBLAS_UINT)(ip - in);
+      if (ref >= ip || (FBLAS_UINT)(ip - ref) > MAX_OFFSET ||
+          read32(ref) != seq) {
+        // skip faster over incompressible regions
+        ip += 1 + ((ip - anchor) >> 6);
+        continue;
+      }
+
+      // extend match
+      const char *mp = ip + MIN_MATCH;
+      const char *rp = ref + MIN_MATCH;
+      bool        mismatch = false;
+      while (!mismatch && mp + sizeof(uint64_t) <= end) {
+        uint64_t diff = read64(mp) ^ read64(rp);
+        if (diff) {
+          mp += (__builtin_ctzll(diff) >> 3);
+          mismatch = true;
+        } else {
+          mp += sizeof(uint64_t);
+          rp += sizeof(uint64_t);
+        }
+      }
+      // last < 8 bytes
+      while (!mismatch && mp < end && *mp == *rp) {
+        mp++;
+        rp++;
+      }
+
+      FBLAS_UINT lit_len = (FBLAS_UINT)(ip - anchor);
+      FBLAS_UINT match_len = (FBLAS_UINT)(mp - ip) - MIN_MATCH;
+      if (op + seq_size(lit_len, match_len) > oend) {
+        return 0;
+      }
+
+      uint8_t *token = op++;
+      *token = (uint8_t)((std::min(lit_len, (FBLAS_UINT) 15) << 4) |
+                         std::min(match_len, (FBLAS_UINT) 15));
+      if (lit_len >= 15) {
+        op = put_len(op, lit_len - 15);
+      }
+      memcpy(op, anchor, lit_len);
+      op += lit_len;
+      FBLAS_UINT offset = (FBLAS_UINT)(ip - ref);
+      *op++ = (uint8_t)(offset & 0xff);
+      *op++ = (uint8_t)(offset >> 8);
+      if (match_len >= 15) {
+        op = put_len(op, match_len - 15);
+      }
+
+      ip = mp;
+      anchor = ip;
+    }
+
+    // trailing literals
+    FBLAS_UINT lit_len = (FBLAS_UINT)(end - anchor);
+    if (op + seq_size(lit_len, 0) > oend) {
+      return 0;
+    }
+    *op++ = (uint8_t)(std::min(lit_len, (FBLAS_UINT) 15) << 4);
+    if (lit_len >= 15) {
+      op = put_len(op, lit_len - 15);
+    }
+    memcpy(op, anchor, lit_len);
+    op += lit_len;
+
+    return (FBLAS_UINT)(op - (uint8_t *) out);
+  }
+
+  // inverse of `lz_compress`; `out` must hold exactly `out_len` bytes
+  void lz_decompress(const char *in, FBLAS_UINT in_len, char *out,
+                     FBLAS_UINT out_len) {
+    const uint8_t *ip = (const uint8_t *) in;
+    const uint8_t *iend = ip + in_len;
+    char *         op = out;
+
+    while (ip < iend) {
+      uint8_t    token = *ip++;
+      FBLAS_UINT lit_len = (token >> 4);
+      if (lit_len == 15) {
+        lit_len += get_len(ip);
+      }
+      memcpy(op, ip, lit_len);
+      op += lit_len;
+      ip += lit_len;
+      if (ip >= iend) {
+        // last sequence
+        break;
+      }
+
+      FBLAS_UINT offset = (FBLAS_UINT) ip[0] | ((FBLAS_UINT) ip[1] << 8);
+      ip += 2;
+      FBLAS_UINT match_len = (token & 15);
+      if (match_len == 15) {
+        match_len += get_len(ip);
+      }
+      match_len += MIN_MATCH;
+
+      // byte-wise copy; `ref` may overlap `op`
+      const char *ref = op - offset;
+      for (FBLAS_UINT i = 0; i < match_len; i++) {
+        op[i] = ref[i];
+      }
+      op += match_len;
+    }
+
+    GLOG_ASSERT(op == out + out_len, "corrupt compressed buffer, got ",
+                (FBLAS_UINT)(op - out), " bytes, expected ", out_len);
+  }
+}  // namespace
+
+namespace flash {
+  CompressedTier::CompressedTier() {
+    this->size = 0;
+    this->max_size = 0;
+    this->max_ratio = 0.75f;
+    this->n_hits = 0;
+    this->n_inserts = 0;
+    this->n_rejects = 0;
+  }
+
+  CompressedTier::~CompressedTier() {
+    if (this->n_inserts.load() > 0) {
+      GLOG_DEBUG("compressed tier:n_inserts=", this->n_inserts.load(),
+                 ", n_rejects=", this->n_rejects.load(),
+                 ", n_hits=", this->n_hits.load());
+    }
+    this->clear();
+  }
+
+  void CompressedTier::remove(std::unordered_map<Key, Entry>::iterator it) {
+    Entry &e = it->second;
+    this->size -= e.comp_size;
+    this->lru.erase(e.lru_it);
+    delete[] e.data;
+    this->entries.erase(it);
+  }
+
+  bool CompressedTier::put(const Key &k, const void *buf, FBLAS_UINT len) {
+    if (!this->enabled()) {
+      return false;
+    }
+
+    // compress outside lock
+    FBLAS_UINT max_out = (FBLAS_UINT)(this->max_ratio * len);
+    shuffle_buf.resize(std::max(shuffle_buf.size(), (size_t) len));
+    comp_buf.resize(std::max(comp_buf.size(), (size_t) max_out + 1));
+    shuffle((const char *) buf, shuffle_buf.data(), len);
+    FBLAS_UINT comp_size =
+        lz_compress(shuffle_buf.data(), len, comp_buf.data(), max_out);
+    if (comp_size == 0 || comp_size > this->max_size) {
+      GLOG_DEBUG("CTIER-REJECT:", std::string(k));
+      this->n_rejects++;
+      return false;
+    }
+
+    Entry e;
+    e.data = new char[comp_size];
+    e.comp_size = comp_size;
+    e.raw_size = len;
+    memcpy(e.data, comp_buf.data(), comp_size);
+
+    mutex_locker lk(this->mut);
+    auto         it = this->entries.find(k);
+    if (it != this->entries.end()) {
+      this->remove(it);
+    }
+    // make space by dropping least recently inserted entries
+    while (this->size + comp_size > this->max_size) {
+      this->remove(this->entries.find(this->lru.back()));
+    }
+    this->lru.push_front(k);
+    e.lru_it = this->lru.begin();
+    this->entries.insert(std::make_pair(k, e));
+    this->size += comp_size;
+    lk.unlock();
+
+    GLOG_DEBUG("CTIER-PUT:", std::string(k), ", raw=", len,
+               ", comp=", comp_size);
+    this->n_inserts++;
+    return true;
+  }
+
+  bool CompressedTier::take(const Key &k, Blob &blob) {
+    if (!this->enabled()) {
+      return false;
+    }
+
+    mutex_locker lk(this->mut);
+    auto         it = this->entries.find(k);
+    if (it == this->entries.end()) {
+      return false;
+    }
+    GLOG_DEBUG("CTIER-HIT:", std::string(k));
+    // take ownership of data; decompressed by `restore()` outside lock
+    blob = it->second;
+    it->second.data = nullptr;
+    this->remove(it);
+    return true;
+  }
+
+  void CompressedTier::restore(Blob &blob, void *buf) {
+    shuffle_buf.resize(std::max(shuffle_buf.size(), (size_t) blob.raw_size));
+    lz_decompress(blob.data, blob.comp_size, shuffle_buf.data(),
+                  blob.raw_size);
+    unshuffle(shuffle_buf.data(), (char *) buf, blob.raw_size);
+    delete[] blob.data;
+    blob.data = nullptr;
+    this->n_hits++;
+  }
+
+  void CompressedTier::erase(const Key &k) {
+    mutex_locker lk(this->mut);
+    auto         it = this->entries.find(k);
+    if (it != this->entries.end()) {
+      this->remove(it);
+    }
+  }
+
+  void CompressedTier::erase_if(std::function<bool(const Key &)> pred) {
+    mutex_locker lk(this->mut);
+    for (auto it = this->entries.begin(); it != this->entries.end();) {
+      auto next = std::next(it);
+      if (pred(it->first)) {
+        this->remove(it);
+      }
+      it = next;
+    }
+  }
+
+  void CompressedTier::clear() {
+    mutex_locker lk(this->mut);
+    for (auto &k_e : this->entries) {
+      delete[] k_e.second.data;
+    }
+    this->entries.clear();
+    this->lru.clear();
+    this->size = 0;
+  }
+}  // namespace flash
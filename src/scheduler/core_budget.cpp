@@ -0,0 +1,136 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "scheduler/core_budget.h"
+#include <omp.h>
+#include <sched.h>
+#include <algorithm>
+#include "bof_logger.h"
+#include "scheduler/numa.h"
+
+namespace {
+  // set the calling thread was last pinned to; empty if unpinned
+  thread_local flash::CoreSet pinned;
+  thread_local bool           pinned_spread = true;
+
+}  // namespace
+
+namespace flash {
+  CoreBudget::CoreBudget() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+      for (FBLAS_UINT core = 0; core < CPU_SETSIZE; core++) {
+        if (CPU_ISSET(core, &set)) {
+          this->all_cores.push_back(core);
+        }
+      }
+    }
+    if (this->all_cores.empty()) {
+      GLOG_WARN("sched_getaffinity failed; assuming 1 core");
+      this->all_cores.push_back(0);
+    }
+    this->n_free = 0;
+    this->enabled = false;
+    this->pin = true;
+    this->setup(0);
+  }
+
+  void CoreBudget::setup(FBLAS_UINT n_cores) {
+    mutex_locker lk(this->mut);
+    if (this->n_free != this->cores.size() && !this->cores.empty()) {
+      GLOG_WARN("cores in use; budget not changed");
+      return;
+    }
+    if (n_cores == 0 || n_cores > this->all_cores.size()) {
+      n_cores = this->all_cores.size();
+    }
+    this->cores.assign(this->all_cores.begin(),
+                       this->all_cores.begin() + n_cores);
+    this->n_users.assign(n_cores, 0);
+    this->n_free = n_cores;
+  }
+
+  FBLAS_UINT CoreBudget::size() {
+    mutex_locker lk(this->mut);
+    return this->cores.size();
+  }
+
+  CoreSet CoreBudget::acquire(FBLAS_UINT n_expected, FBLAS_UINT max_cores,
+                              const CoreSet &prefer) {
+    mutex_locker lk(this->mut);
+    FBLAS_UINT   n_cores = this->cores.size();
+    FBLAS_UINT   share =
+        std::max(n_cores / std::max(n_expected, (FBLAS_UINT) 1),
+                 (FBLAS_UINT) 1);
+    FBLAS_UINT   n_take = std::min(std::min(share, max_cores), this->n_free);
+
+    // first fit, `prefer`-ed cores first; neighbouring ids tend to share
+    // caches
+    CoreSet taken;
+    for (FBLAS_UINT pass = 0; pass < 2; pass++) {
+      for (FBLAS_UINT i = 0; i < n_cores && taken.size() < n_take; i++) {
+        bool preferred = (std::find(prefer.begin(), prefer.end(),
+                                    this->cores[i]) != prefer.end());
+        if (this->n_users[i] == 0 && (pass == 1 || preferred)) {
+          this->n_users[i]++;
+          taken.push_back(this->cores[i]);
+        }
+      }
+    }
+    this->n_free -= taken.size();
+    if (!taken.empty() || n_cores == 0) {
+      return taken;
+    }
+
+    // all cores held; share the least-loaded one, `prefer`-ed on ties
+    FBLAS_UINT best = 0;
+    bool       best_pref = false;
+    for (FBLAS_UINT i = 0; i < n_cores; i++) {
+      bool preferred = (std::find(prefer.begin(), prefer.end(),
+                                  this->cores[i]) != prefer.end());
+      if (i == 0 || this->n_users[i] < this->n_users[best] ||
+          (this->n_users[i] == this->n_users[best] && preferred &&
+           !best_pref)) {
+        best = i, best_pref = preferred;
+      }
+    }
+    this->n_users[best]++;
+    taken.push_back(this->cores[best]);
+    return taken;
+  }
+
+  void CoreBudget::release(const CoreSet &cores) {
+    mutex_locker lk(this->mut);
+    for (auto core : cores) {
+      auto it = std::find(this->cores.begin(), this->cores.end(), core);
+      GLOG_ASSERT(it != this->cores.end(), "core ", core, " not in budget");
+      FBLAS_UINT idx = it - this->cores.begin();
+      GLOG_ASSERT(this->n_users[idx] > 0, "core ", core, " released twice");
+      if (--this->n_users[idx] == 0) {
+        this->n_free++;
+      }
+    }
+  }
+
+  void CoreBudget::pin_threads(const CoreSet &cores, bool spread) {
+    if (cores == pinned && spread == pinned_spread) {
+      return;
+    }
+    pinned = cores;
+    pinned_spread = spread;
+    const CoreSet &set = (cores.empty() ? this->all_cores : cores);
+    numa::pin_thread(set);
+    if (cores.empty() || !spread) {
+#pragma omp parallel
+      { numa::pin_thread(set); }
+      return;
+    }
+    if (cores.size() == 1) {
+      return;
+    }
+    // OpenMP teams are re-used; pin each member of this thread's team
+#pragma omp parallel num_threads(cores.size())
+    { numa::pin_thread({cores[omp_get_thread_num() % cores.size()]}); }
+  }
+}  // namespace flash
@@ -0,0 +1,224 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include "file_handles/flash_file_handle.h"
+#include "scheduler/cache.h"
+
+namespace flash {
+  FlashTier::FlashTier() {
+    this->fop = nullptr;
+    this->max_size = 0;
+  }
+
+  FlashTier::~FlashTier() {
+    this->teardown();
+  }
+
+  void FlashTier::teardown() {
+    this->clear();
+    if (this->fop != nullptr) {
+      GLOG_DEBUG("flash tier:", std::string(this->stats));
+      this->fop->close();
+      delete this->fop;
+      this->fop = nullptr;
+    }
+    this->free_map.clear();
+    this->max_size = 0;
+  }
+
+  void FlashTier::setup(const std::string &dir, FBLAS_UINT size) {
+    size = ROUND_DOWN(size, SECTOR_LEN);
+    std::string new_fname =
+        dir + "/bof_victim_tier_" + std::to_string(::getpid()) + ".bin";
+    if (this->enabled() && size == this->max_size &&
+        new_fname == this->fname) {
+      return;
+    }
+    this->teardown();
+    if (size == 0 || dir.empty()) {
+      return;
+    }
+
+    // create backing file; the tier stays disabled if it can't be sized
+    this->fname = new_fname;
+    int fd = ::open(this->fname.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd == -1) {
+      GLOG_WARN("failed to create ", this->fname, ", errno=", errno, ":",
+                ::strerror(errno), "; flash tier disabled");
+      return;
+    }
+    if (::ftruncate(fd, size) != 0) {
+      GLOG_WARN("failed to resize ", this->fname, " to ", size, ", errno=",
+                errno, ":", ::strerror(errno), "; flash tier disabled");
+      ::close(fd);
+      ::unlink(this->fname.c_str());
+      return;
+    }
+    ::close(fd);
+
+    this->fop = new FlashFileHandle();
+    this->fop->open(this->fname, Mode::READWRITE);
+    // file is released when `fop` is closed
+    ::unlink(this->fname.c_str());
+
+    this->max_size = size;
+    this->free_map[0] = size;
+    GLOG_INFO("flash tier:", this->fname, ", size=", size);
+  }
+
+  bool FlashTier::alloc_extent(FBLAS_UINT len, FBLAS_UINT &offset) {
+    for (auto it = this->free_map.begin(); it != this->free_map.end(); it++) {
+      if (it->second >= len) {
+        offset = it->first;
+        FBLAS_UINT rem = it->second - len;
+        this->free_map.erase(it);
+        if (rem > 0) {
+          this->free_map[offset + len] = rem;
+        }
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void FlashTier::free_extent(FBLAS_UINT offset, FBLAS_UINT len) {
+    auto next = this->free_map.lower_bound(offset);
+    // merge with next extent
+    if (next != this->free_map.end() && offset + len == next->first) {
+      len += next->second;
+      next = this->free_map.erase(next);
+    }
+    // merge with previous extent
+    if (next != this->free_map.begin()) {
+      auto prev = std::prev(next);
+      if (prev->first + prev->second == offset) {
+        prev->second += len;
+        return;
+      }
+    }
+    this->free_map[offset] = len;
+  }
+
+  void FlashTier::remove(std::unordered_map<Key, Entry>::iterator it) {
+    Entry &e = it->second;
+    if (!e.busy) {
+      this->free_extent(e.offset, e.len);
+    }
+    this->lru.erase(e.lru_it);
+    this->entries.erase(it);
+  }
+
+  bool FlashTier::reserve(const Key &k, FBLAS_UINT len, flash_ptr<void> &fptr) {
+    if (!this->enabled() || len > this->max_size) {
+      return false;
+    }
+
+    mutex_locker lk(this->mut);
+    auto         it = this->entries.find(k);
+    if (it != this->entries.end()) {
+      this->remove(it);
+    }
+
+    // make space by dropping least recently inserted entries
+    FBLAS_UINT offset = 0;
+    while (!this->alloc_extent(len, offset)) {
+      // skip entries being written
+      auto victim = this->lru.end();
+      bool found = false;
+      while (victim != this->lru.begin()) {
+        victim--;
+        if (!this->entries.find(*victim)->second.busy) {
+          found = true;
+          break;
+        }
+      }
+      if (!found) {
+        GLOG_DEBUG("FTIER-REJECT:", std::string(k));
+        return false;
+      }
+      this->remove(this->entries.find(*victim));
+    }
+
+    Entry e;
+    e.offset = offset;
+    e.len = len;
+    e.busy = true;
+    this->lru.push_front(k);
+    e.lru_it = this->lru.begin();
+    this->entries.insert(std::make_pair(k, e));
+    lk.unlock();
+
+    fptr = flash_ptr<void>(nullptr, offset, this->fop);
+    GLOG_DEBUG("FTIER-PUT:", std::string(k), ", offset=", offset);
+    return true;
+  }
+
+  void FlashTier::commit(const Key &k, flash_ptr<void> fptr, FBLAS_UINT len) {
+    mutex_locker lk(this->mut);
+    auto         it = this->entries.find(k);
+    if (it != this->entries.end() && it->second.busy &&
+        it->second.offset == fptr.foffset) {
+      it->second.busy = false;
+    } else {
+      // dropped while being written
+      this->free_extent(fptr.foffset, len);
+    }
+  }
+
+  bool FlashTier::take(const Key &k, flash_ptr<void> &fptr) {
+    if (!this->enabled()) {
+      return false;
+    }
+
+    mutex_locker lk(this->mut);
+    auto         it = this->entries.find(k);
+    if (it == this->entries.end()) {
+      return false;
+    }
+    GLOG_ASSERT(!it->second.busy, "read from flash tier before write");
+    fptr = flash_ptr<void>(nullptr, it->second.offset, this->fop);
+    // space returned in `release()`
+    it->second.busy = true;
+    this->remove(it);
+    lk.unlock();
+
+    GLOG_DEBUG("FTIER-HIT:", std::string(k));
+    return true;
+  }
+
+  void FlashTier::release(flash_ptr<void> fptr, FBLAS_UINT len) {
+    mutex_locker lk(this->mut);
+    this->free_extent(fptr.foffset, len);
+  }
+
+  void FlashTier::erase(const Key &k) {
+    mutex_locker lk(this->mut);
+    auto         it = this->entries.find(k);
+    if (it != this->entries.end()) {
+      this->remove(it);
+    }
+  }
+
+  void FlashTier::erase_if(std::function<bool(const Key &)> pred) {
+    mutex_locker lk(this->mut);
+    for (auto it = this->entries.begin(); it != this->entries.end();) {
+      auto next = std::next(it);
+      if (pred(it->first)) {
+        this->remove(it);
+      }
+      it = next;
+    }
+  }
+
+  void FlashTier::clear() {
+    mutex_locker lk(this->mut);
+    for (auto it = this->entries.begin(); it != this->entries.end();) {
+      auto next = std::next(it);
+      this->remove(it);
+      it = next;
+    }
+  }
+}  // namespace flash
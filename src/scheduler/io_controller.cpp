@@ -0,0 +1,178 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "scheduler/io_controller.h"
+#include <algorithm>
+#include "bof_utils.h"
+#include "file_handles/flash_file_handle.h"
+
+namespace flash {
+  // defining because `std::min/max` bind references to them
+  const FBLAS_UINT IoController::CHUNK_MIN;
+  const FBLAS_UINT IoController::CHUNK_MAX;
+
+  LatencyHistogram::LatencyHistogram() {
+    for (FBLAS_UINT i = 0; i < N_LATENCY_BUCKETS; i++) {
+      this->buckets[i] = 0;
+    }
+  }
+
+  void LatencyHistogram::record(FBLAS_UINT us) {
+    FBLAS_UINT idx = 0;
+    while (us > 1 && idx < N_LATENCY_BUCKETS - 1) {
+      us >>= 1;
+      idx++;
+    }
+    this->buckets[idx].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void LatencyHistogram::snapshot(FBLAS_UINT *out) const {
+    for (FBLAS_UINT i = 0; i < N_LATENCY_BUCKETS; i++) {
+      out[i] = this->buckets[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  IoController::IoController(FBLAS_UINT max_depth) {
+    this->max_depth = std::max(max_depth, (FBLAS_UINT) 1);
+    // start half-way & probe upwards
+    this->depth = std::max(this->max_depth / 2, (FBLAS_UINT) 1);
+    this->limit = this->max_depth;
+    this->enabled = false;
+    this->n_tasks = 0;
+    this->n_bytes = 0;
+    this->last_tput = 0.0f;
+    this->last_latency = 0.0f;
+    this->base_latency = 0.0f;
+    this->chunk_tput = 0.0f;
+    this->chunk_up = false;
+    this->n_windows = 0;
+    this->reset_window();
+  }
+
+  void IoController::reset_window() {
+    this->win_start = std::chrono::steady_clock::now();
+    this->win_tasks = 0;
+    this->win_backlogged = 0;
+    this->win_bytes = 0;
+    this->win_us = 0;
+  }
+
+  void IoController::set_enabled(bool enable) {
+    mutex_locker lk(this->mut);
+    if (enable == this->enabled.load()) {
+      return;
+    }
+    this->enabled = enable;
+    this->base_latency = 0.0f;
+    this->chunk_tput = 0.0f;
+    this->n_windows = 0;
+    this->reset_window();
+    if (!enable) {
+      FlashFileHandle::chunk_size = DEFAULT_CHUNK_SIZE;
+    }
+  }
+
+  void IoController::set_limit(FBLAS_UINT limit) {
+    if (limit == 0) {
+      limit = this->max_depth;
+    }
+    this->limit = std::min(std::max(limit, (FBLAS_UINT) 1), this->max_depth);
+  }
+
+  void IoController::record(FBLAS_UINT bytes, FBLAS_UINT us, bool backlogged) {
+    this->n_tasks++;
+    this->n_bytes += bytes;
+    if (!this->enabled.load()) {
+      return;
+    }
+
+    mutex_locker lk(this->mut);
+    this->win_tasks++;
+    this->win_backlogged += (backlogged ? 1 : 0);
+    this->win_bytes += bytes;
+    this->win_us += us;
+    FBLAS_UINT elapsed_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - this->win_start)
+            .count();
+    // need a few completions per in-flight task for a stable estimate
+    if (elapsed_us < WINDOW_US || this->win_tasks < 2 * this->depth.load() ||
+        this->win_bytes == 0) {
+      return;
+    }
+
+    float mbytes = (float) this->win_bytes / (float) (1 << 20);
+    float tput = mbytes / ((float) elapsed_us / 1e6f);
+    float latency = (float) this->win_us / mbytes;
+    // depth doesn't matter if tasks don't wait for an I/O thread
+    bool saturated = (2 * this->win_backlogged >= this->win_tasks);
+    this->update(tput, latency, saturated);
+    this->last_tput = tput;
+    this->last_latency = latency;
+    this->reset_window();
+  }
+
+  void IoController::update(float tput, float latency, bool backlogged) {
+    if (!backlogged) {
+      return;
+    }
+
+    this->n_windows++;
+    if (this->base_latency == 0.0f || latency < this->base_latency) {
+      this->base_latency = latency;
+    } else {
+      this->base_latency *= LAT_DRIFT;
+    }
+
+    // depth : latency per byte grows without throughput once the device is
+    // saturated => back off multiplicatively, else probe additively
+    FBLAS_UINT cur_depth = this->depth.load();
+    FBLAS_UINT new_depth = cur_depth;
+    if (latency > LAT_TOLERANCE * this->base_latency) {
+      new_depth = cur_depth - std::max(cur_depth / 4, (FBLAS_UINT) 1);
+      new_depth = std::max(new_depth, (FBLAS_UINT) 1);
+    } else if (cur_depth < this->max_depth) {
+      new_depth = cur_depth + 1;
+    }
+    if (new_depth != cur_depth) {
+      GLOG_DEBUG("IO-CTL:depth=", cur_depth, "->", new_depth,
+                 ", tput=", tput, "MB/s, latency=", latency,
+                 "us/MB, base=", this->base_latency, "us/MB");
+      this->depth = new_depth;
+    }
+
+    // chunk size : keep moving in the same direction while throughput
+    // improves, else turn around
+    if (this->n_windows % CHUNK_PERIOD != 0) {
+      return;
+    }
+    if (tput < this->chunk_tput) {
+      this->chunk_up = !this->chunk_up;
+    }
+    this->chunk_tput = tput;
+    FBLAS_UINT cur_chunk = FlashFileHandle::chunk_size.load();
+    FBLAS_UINT new_chunk = (this->chunk_up ? cur_chunk * 2 : cur_chunk / 2);
+    new_chunk = std::min(std::max(new_chunk, CHUNK_MIN), CHUNK_MAX);
+    if (new_chunk == cur_chunk) {
+      // hit a bound; come back next time
+      this->chunk_up = !this->chunk_up;
+      return;
+    }
+    GLOG_DEBUG("IO-CTL:chunk_size=", cur_chunk, "->", new_chunk,
+               ", tput=", tput, "MB/s");
+    FlashFileHandle::chunk_size = new_chunk;
+  }
+
+  IoStats IoController::get_stats() const {
+    IoStats stats;
+    stats.depth = this->get_depth();
+    stats.max_depth = this->max_depth;
+    stats.chunk_size = FlashFileHandle::chunk_size.load();
+    stats.n_tasks = this->n_tasks.load();
+    stats.n_bytes = this->n_bytes.load();
+    stats.throughput = this->last_tput.load();
+    stats.latency = this->last_latency.load();
+    stats.adaptive = this->enabled.load();
+    return stats;
+  }
+}  // namespace flash
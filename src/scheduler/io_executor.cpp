@@ -3,156 +3,29 @@
 
 #include "scheduler/io_executor.h"
 #include <malloc.h>
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
 #include "bof_timer.h"
 #include "file_handles/flash_file_handle.h"
+#include "scheduler/numa.h"
+#include "scheduler/stats.h"
+#include "scheduler/tracer.h"
 
 namespace {
-  bool strip_overlap(FBLAS_UINT start1, FBLAS_UINT end1, FBLAS_UINT start2,
-                     FBLAS_UINT end2) {
-    start1 = ROUND_DOWN(start1, SECTOR_LEN);
-    start2 = ROUND_DOWN(start2, SECTOR_LEN);
-    end1 = ROUND_UP(end1, SECTOR_LEN);
-    end2 = ROUND_UP(end2, SECTOR_LEN);
-    return !((end2 <= start1) || (end1 <= start2));
-  }
   std::string to_string(const flash::IoTask& tsk) {
     return std::to_string((FBLAS_UINT) tsk.fptr.fop) + ":" +
            std::to_string(tsk.fptr.foffset) + "+" + std::string(tsk.sinfo);
   }
-  void print_conflict(const flash::IoTask& tsk1, const flash::IoTask& tsk2) {
-    std::string first = to_string(tsk1);
-    std::string second = to_string(tsk2);
-    GLOG_WARN("CONFLICT:[", first, "] <--> [", second, "]");
-  }
-
-  bool same_stride_overlap(FBLAS_UINT o1, FBLAS_UINT l1, FBLAS_UINT n1,
-                           FBLAS_UINT o2, FBLAS_UINT l2, FBLAS_UINT n2,
-                           FBLAS_UINT s) {
-    // if all params are aligned, then no overlap
-    if (IS_ALIGNED(o1) && IS_ALIGNED(o2) && IS_ALIGNED(l1) && IS_ALIGNED(l2) &&
-        IS_ALIGNED(s)) {
-      return false;
-    }
-
-    GLOG_ASSERT(o1 <= o2, "bad offset ordering");
-    // ---1|2--- overlap
-    if (strip_overlap(o1, o1 + l1, o2, o2 + l2)) {
-      return true;
-    }
-
-    // ---2|1--- overlap
-    if (strip_overlap(o1 + s, o1 + s + l1, o2, o2 + l2)) {
-      return true;
-    }
-
-    // # bytes between end of first strip and start of second strip
-    FBLAS_UINT delta = (o2 - (o1 + l1));
-    if (delta < SECTOR_LEN) {
-      if (IS_ALIGNED(o1) && IS_ALIGNED(o2) && IS_ALIGNED(s)) {
-        return false;
-      } else {
-        return true;
-      }
-    } else {
-      // no overlap
-      return false;
-    }
-  }
-  bool is_overlap(const flash::IoTask& tsk1, const flash::IoTask& tsk2) {
-    /*
-    GLOG_DEBUG("in_ptrs=", std::to_string((FBLAS_UINT) tsk1.fptr.fop), ", ",
-               std::to_string((FBLAS_UINT) tsk2.fptr.fop));
-               */
-    // if not even the same file, return false
-    if (tsk1.fptr.fop != tsk2.fptr.fop) {
-      return false;
-    }
-
-    // reads never conflict
-    if (!tsk1.is_write && !tsk2.is_write) {
-      return false;
-    }
 
-    FBLAS_UINT o1 = tsk1.fptr.foffset;
-    FBLAS_UINT n1 = tsk1.sinfo.n_strides;
-    FBLAS_UINT l1 = tsk1.sinfo.len_per_stride;
-    FBLAS_UINT s1 = tsk1.sinfo.stride;
-    FBLAS_UINT o2 = tsk2.fptr.foffset;
-    FBLAS_UINT n2 = tsk2.sinfo.n_strides;
-    FBLAS_UINT l2 = tsk2.sinfo.len_per_stride;
-    FBLAS_UINT s2 = tsk2.sinfo.stride;
-
-    // 3 unique cases
-    if (n1 == 1 && n2 == 1) {
-      if (strip_overlap(o1, o1 + l1, o2, o2 + l2)) {
-        return true;
-      } else {
-        return false;
-      }
-    }
-    // swap to keep first access as strided
-    if (n2 != 1 && n1 == 1) {
-      std::swap(n1, n2);
-      std::swap(l1, l2);
-      std::swap(o1, o2);
-      std::swap(s1, s2);
-    }
-    if (n1 != 1 && n2 == 1) {
-      FBLAS_UINT e2 = o2 + l2;
-      // check if entirely disjoint
-      bool overlap = strip_overlap(o1, o1 + n1 * s1, o2, e2);
-      if (!overlap) {
-        return false;
-      }
-      // if o2 comes first, then there has to be an overlap
-      if (o2 <= o1) {
-        print_conflict(tsk1, tsk2);
-        return true;
-      }
-
-      FBLAS_UINT k_low = (o2 - o1) / s1;  // floor((o2-o1) / s1);
-      // check overlap between `k_low` strip and o2:l2
-      FBLAS_UINT k_start = o1 + k_low * s1;
-      overlap = strip_overlap(k_start, k_start + l1, o2, e2);
-      if (overlap) {
-        print_conflict(tsk1, tsk2);
-        return true;
-      }
-      // check overlap between `k_low + 1` strip and o2:l2
-      // if no overlap, then the two accesses don't overlap
-      k_start += s1;
-      overlap = strip_overlap(k_start, k_start + l1, o2, e2);
-      if (overlap) {
-        print_conflict(tsk1, tsk2);
-        return true;
-      } else {
-        return false;
-      }
-    } else {
-      // both strided accesses
-      // special case when both use same strides (matrix blocking)
-      if (s1 == s2) {
-        if (o2 < o1) {
-          std::swap(n1, n2);
-          std::swap(l1, l2);
-          std::swap(o1, o2);
-          std::swap(s1, s2);
-        }
+  // trace event names, by `IoPriority`
+  const char* trace_names[N_IO_PRIORITIES] = {"demand-read", "prefetch-read",
+                                              "write-back"};
 
-        return same_stride_overlap(o1, l1, n1, o2, l2, n2, s1);
-      } else {
-        // different strides
-        // no idea why this will happen, but I'll support it regardless
-        bool overlap = strip_overlap(o1, o1 + n1 * s1, o2, o2 + n2 * s2);
-        if (!overlap) {
-          return false;
-        }
-        print_conflict(tsk1, tsk2);
-        // TODO :: implement this
-        GLOG_FATAL("non-homogenous overlap operator not implemented");
-        return true;
-      }
-    }
+  FBLAS_UINT elapsed_us(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
   }
 }  // namespace
 
@@ -165,7 +38,6 @@ namespace flash {
     GLOG_ASSERT(fptr.fop != nullptr, "bad fptr");
     StrideInfo                     sinfo = tsk.sinfo;
     void*                          buf = tsk.buf;
-    auto                           callback_fn = tsk.callback;
     static std::atomic<FBLAS_UINT> write_count(1);
     if (tsk.is_write) {
       GLOG_DEBUG("write #", write_count.fetch_add(1),
@@ -180,7 +52,11 @@ GLOG_ASSERT(malloc_usable_size(buf) >= buf_size(sinfo),
     FlashFileHandle* ffh = dynamic_cast<FlashFileHandle*>(fptr.fop);
     GLOG_ASSERT(ffh != nullptr, "bad fop");
 #endif
-    if (sinfo.n_strides == 1) {
+    if (!tsk.gbufs.empty()) {
+      GLOG_DEBUG("gather write:n_bufs=", tsk.gbufs.size(),
+                 ", sinfo=", std::string(sinfo));
+      fptr.fop->gwrite(fptr.foffset, sinfo, tsk.gbufs);
+    } else if (sinfo.n_strides == 1) {
       GLOG_DEBUG("args:offset=", fptr.foffset, ", lps=", sinfo.len_per_stride,
                  ", buf=", buf);
       if (tsk.is_write) {
@@ -197,162 +73,321 @@ GLOG_ASSERT(malloc_usable_size(buf) >= buf_size(sinfo),
       }
     }
 
-    callback_fn();
+    tsk.callback();
     GLOG_DEBUG("I/O:END:", to_string(tsk), ", time taken = ", timer.elapsed(),
                "ms");
   }  // namespace flash
 
-  bool IoExecutor::overlap(FBLAS_UINT t1_idx, FBLAS_UINT t2_idx) {
-    Timer        timer;
-    mutex_locker lk1(thread_muts[t1_idx], std::defer_lock);
-    mutex_locker lk2(thread_muts[t2_idx], std::defer_lock);
+  IoTask* IoExecutor::alloc_task() {
+    IoTask* tsk = this->free_tasks;
+    if (tsk == nullptr) {
+      return new IoTask();
+    }
+    this->free_tasks = tsk->next;
+    tsk->next = nullptr;
+    return tsk;
+  }
+
+  void IoExecutor::free_task(IoTask* tsk) {
+    // release captures now, not when the node is re-used
+    tsk->callback.reset();
+    tsk->gbufs.clear();
+    tsk->next = this->free_tasks;
+    this->free_tasks = tsk;
+  }
+
+  void IoExecutor::push_task(IoTask* tsk, mutex_locker& lk) {
+    this->n_pending++;
+    this->queues[(FBLAS_UINT) tsk->prio].push_back(tsk);
+    lk.unlock();
+    // threads of a different role may be woken up; wake up all
+    this->queue_cv.notify_all();
+  }
 
-    // try locking both using a deadlock-avoidance algorithm
-    std::lock(lk1, lk2);
+  IoTask* IoExecutor::pop_task(ThreadRole role, std::vector<IoTask*>& merged) {
+    mutex_locker lk(this->queue_mut);
+    while (true) {
+      bool all_empty = true;
+      for (FBLAS_UINT p = 0; p < N_IO_PRIORITIES; p++) {
+        all_empty = all_empty && this->queues[p].empty();
+        bool is_write = ((IoPriority) p == IoPriority::WriteBack);
+        if ((role == ThreadRole::Read && is_write) ||
+            (role == ThreadRole::Write && !is_write)) {
+          continue;
+        }
+        if (!this->queues[p].empty() &&
+            this->n_in_flight[p] < this->max_in_flight[p] &&
+            this->n_executing < this->ctl.get_depth()) {
+          IoTask* tsk = this->queues[p].front();
+          this->queues[p].pop_front();
+          this->n_in_flight[p]++;
+          this->n_executing++;
+          if (!tsk->is_write && tsk->fptr.fop != nullptr) {
+            this->collect_merges(p, tsk, merged);
+          }
+          return tsk;
+        }
+      }
 
-    // take care of the case when either of them is a null task
-    if (thread_tsks[t1_idx] == nullptr || thread_tsks[t2_idx] == nullptr) {
-      GLOG_ERROR("shouldn't check for overlap because is_writes=false");
-      return false;
+      // shutdown mechanism
+      if (this->shutdown.load() && all_empty) {
+        return nullptr;
+      }
+      // wait for a push | completion
+      this->queue_cv.wait(lk);
+    }
+  }
+
+  void IoExecutor::collect_merges(FBLAS_UINT prio, IoTask* tsk,
+                                  std::vector<IoTask*>& merged) {
+    if (this->merge_max == 0 || tsk->sinfo.n_strides != 1) {
+      return;
     }
 
-    bool result_f = ::is_overlap(*thread_tsks[t1_idx], *thread_tsks[t2_idx]);
-    bool result_b = ::is_overlap(*thread_tsks[t2_idx], *thread_tsks[t1_idx]);
-    GLOG_ASSERT(result_f == result_b, "bidirectional comparator required");
+    // contiguous reads from the same file, sorted by offset
+    std::deque<IoTask*>& q = this->queues[prio];
+    std::vector<IoTask*> cands;
+    for (auto other : q) {
+      if (other->fptr.fop == tsk->fptr.fop && !other->is_write &&
+          other->sinfo.n_strides == 1) {
+        cands.push_back(other);
+      }
+    }
+    if (cands.empty()) {
+      return;
+    }
+    std::sort(cands.begin(), cands.end(), [](IoTask* left, IoTask* right) {
+      return left->fptr.foffset < right->fptr.foffset;
+    });
+
+    // grow `[start, end)` around `tsk` in both directions
+    FBLAS_UINT start = tsk->fptr.foffset;
+    FBLAS_UINT end = start + tsk->sinfo.len_per_stride;
+    auto       mid = std::lower_bound(
+        cands.begin(), cands.end(), start,
+        [](IoTask* t, FBLAS_UINT off) { return t->fptr.foffset < off; });
+    for (auto it = mid; it != cands.end(); it++) {
+      FBLAS_UINT o = (*it)->fptr.foffset;
+      FBLAS_UINT e = o + (*it)->sinfo.len_per_stride;
+      if (o > end + this->merge_gap ||
+          std::max(end, e) - start > this->merge_max) {
+        break;
+      }
+      end = std::max(end, e);
+      merged.push_back(*it);
+    }
+    for (auto it = mid; it != cands.begin();) {
+      it--;
+      FBLAS_UINT o = (*it)->fptr.foffset;
+      FBLAS_UINT e = o + (*it)->sinfo.len_per_stride;
+      if (e + this->merge_gap < start ||
+          end - std::min(start, o) > this->merge_max) {
+        break;
+      }
+      start = std::min(start, o);
+      merged.push_back(*it);
+    }
 
-    // give up both locks
-    lk1.unlock();
-    lk2.unlock();
-    GLOG_DEBUG("Overlap Check: ", timer.elapsed(), "ms");
+    if (!merged.empty()) {
+      std::unordered_set<IoTask*> merged_set(merged.begin(), merged.end());
+      q.erase(std::remove_if(q.begin(), q.end(),
+                             [&merged_set](IoTask* t) {
+                               return merged_set.find(t) != merged_set.end();
+                             }),
+              q.end());
+      GLOG_DEBUG("MERGE:n_reads=", merged.size() + 1, ", range=", start, "-",
+                 end);
+    }
+  }
 
-    return result_f || result_b;
+  void IoExecutor::execute_merged(IoTask* tsk, std::vector<IoTask*>& merged) {
+    merged.push_back(tsk);
+    FBLAS_UINT start = tsk->fptr.foffset;
+    FBLAS_UINT end = start;
+    for (auto t : merged) {
+      start = std::min(start, t->fptr.foffset);
+      end = std::max(end, t->fptr.foffset + t->sinfo.len_per_stride);
+    }
+    start = ROUND_DOWN(start, SECTOR_LEN);
+    end = ROUND_UP(end, SECTOR_LEN);
+
+    void* mbuf;
+    alloc_aligned(&mbuf, end - start, SECTOR_LEN);
+    tsk->fptr.fop->read(start, end - start, mbuf, dummy_std_func);
+    for (auto t : merged) {
+      memcpy(t->buf, offset_buf(mbuf, t->fptr.foffset - start),
+             t->sinfo.len_per_stride);
+      t->callback();
+    }
+    free(mbuf);
+    merged.pop_back();
   }
 
-  void IoExecutor::set_task(FBLAS_UINT thread_idx, IoTask* tsk) {
-    if (this->overlap_check) {
-      mutex_locker lk(thread_muts[thread_idx]);
-      thread_tsks[thread_idx] = tsk;
-      this->is_writes[thread_idx] = tsk->is_write;
-      lk.unlock();
+  FBLAS_UINT IoExecutor::default_max_in_flight(IoPriority prio) const {
+    FBLAS_UINT n_readers = this->n_threads + this->n_read_threads;
+    FBLAS_UINT n_writers = this->n_threads + this->n_write_threads;
+    switch (prio) {
+      case IoPriority::Demand:
+        return n_readers;
+      case IoPriority::Prefetch:
+        // leave room for demand reads
+        return std::max(n_readers - n_readers / 4, (FBLAS_UINT) 1);
+      case IoPriority::WriteBack:
+        // leave room for reads on shared threads
+        return std::max(this->n_write_threads + this->n_threads / 2,
+                        (FBLAS_UINT) 1);
+      default:
+        return n_writers;
     }
   }
 
-  void IoExecutor::set_null(FBLAS_UINT thread_idx) {
-    if (this->overlap_check) {
-      mutex_locker lk(thread_muts[thread_idx]);
-      thread_tsks[thread_idx] = nullptr;
-      this->is_writes[thread_idx] = false;
-      lk.unlock();
+  void IoExecutor::set_max_in_flight(IoPriority prio, FBLAS_UINT depth) {
+    mutex_locker lk(this->queue_mut);
+    this->max_in_flight[(FBLAS_UINT) prio] =
+        (depth == 0) ? this->default_max_in_flight(prio) : depth;
+    lk.unlock();
+    this->queue_cv.notify_all();
+  }
+
+  void IoExecutor::finish_task(IoTask* tsk, std::vector<IoTask*>& merged,
+                               FBLAS_UINT bytes, FBLAS_UINT us) {
+    FBLAS_UINT n_ops = merged.size() + 1;
+    if (tsk->is_write) {
+      this->n_write_ops += n_ops;
+      this->n_write_bytes += bytes;
+      this->write_latency.record(us);
+    } else {
+      this->n_read_ops += n_ops;
+      this->n_read_bytes += bytes;
+      this->read_latency.record(us);
+    }
+
+    mutex_locker lk(this->queue_mut);
+    this->n_in_flight[(FBLAS_UINT) tsk->prio]--;
+    this->n_executing--;
+    bool backlogged = false;
+    for (FBLAS_UINT p = 0; p < N_IO_PRIORITIES; p++) {
+      backlogged = backlogged || !this->queues[p].empty();
     }
+    for (auto t : merged) {
+      this->free_task(t);
+    }
+    this->free_task(tsk);
+    lk.unlock();
+    this->queue_cv.notify_all();
+
+    this->n_pending -= n_ops;
+    this->ctl.record(bytes, us, backlogged);
+  }
+
+  void IoExecutor::finish_work(IoTask* tsk) {
+    mutex_locker lk(this->queue_mut);
+    this->n_in_flight[(FBLAS_UINT) tsk->prio]--;
+    this->n_executing--;
+    this->free_task(tsk);
+    lk.unlock();
+    this->queue_cv.notify_all();
+    this->n_pending--;
   }
 
-  void IoExecutor::io_thread_fn(FBLAS_UINT thread_idx) {
-    // backlog of overlapping I/Os
-    std::queue<IoTask*> backlog;
+  void IoExecutor::set_depth_limit(FBLAS_UINT limit) {
+    mutex_locker lk(this->queue_mut);
+    this->ctl.set_limit(limit);
+    lk.unlock();
+    this->queue_cv.notify_all();
+  }
+
+  FBLAS_UINT IoExecutor::n_queued_reads() {
+    mutex_locker lk(this->queue_mut);
+    return this->queues[(FBLAS_UINT) IoPriority::Demand].size() +
+           this->queues[(FBLAS_UINT) IoPriority::Prefetch].size();
+  }
 
+  void IoExecutor::fill_stats(Stats& stats) {
+    stats.read_ops = this->n_read_ops.load();
+    stats.read_bytes = this->n_read_bytes.load();
+    stats.write_ops = this->n_write_ops.load();
+    stats.write_bytes = this->n_write_bytes.load();
+    this->read_latency.snapshot(stats.read_latency_us);
+    this->write_latency.snapshot(stats.write_latency_us);
+    stats.io = this->ctl.get_stats();
+
+    mutex_locker lk(this->queue_mut);
+    for (FBLAS_UINT p = 0; p < N_IO_PRIORITIES; p++) {
+      stats.queued[p] = this->queues[p].size();
+      stats.in_flight[p] = this->n_in_flight[p];
+    }
+  }
+
+  void IoExecutor::io_thread_fn(FBLAS_UINT thread_idx, ThreadRole role) {
     // register thread
     FlashFileHandle::register_thread();
+    trace::name_thread(role == ThreadRole::Read
+                           ? "io-read"
+                           : (role == ThreadRole::Write ? "io-write" : "io"));
 
+    std::vector<IoTask*> merged;
+    bool                 pinned = false;
     while (true) {
-      // give higher priority to `backlog` tasks
-      // try to execute each task in `backlog` before giving up
-      IoTask* tsk = nullptr;
-
-      if (this->overlap_check) {
-        FBLAS_UINT n_tries = backlog.size();
-        while (n_tries > 0) {
-          n_tries--;
-
-          // get a `backlog` task
-          tsk = backlog.front();
-          backlog.pop();
-
-          // announce my task
-          set_task(thread_idx, tsk);
-
-          // check if conflict has been resolved
-          bool conflict = false;
-          if (this->overlap_check) {
-            bool thread_writes = this->is_writes[thread_idx].load();
-            for (FBLAS_UINT i = 0; i < this->n_threads; i++) {
-              if (i != thread_idx) {
-                bool other_writes = this->is_writes[i].load();
-                // data race only if both write
-                // (R | W) and (W | R) is a WAR or RAW hazard that should be
-                // taken care of by adding dependencies in the task DAG
-                // (R | R) presents no hazard
-                if (thread_writes && other_writes) {
-                  bool overlap = this->overlap(thread_idx, i);
-                  if (overlap) {
-                    // conflict
-                    GLOG_WARN("conflict");
-                    set_null(thread_idx);
-                    backlog.push(tsk);
-                    conflict = true;
-                    break;
-                  }
-                }
-              }
-            }
-          }
+      if (this->numa.load() != pinned) {
+        pinned = !pinned;
+        numa::pin_thread(pinned ? numa::node_cores(thread_idx %
+                                                   numa::n_nodes())
+                                : CoreSet());
+      }
+      merged.clear();
+      IoTask* tsk = this->pop_task(role, merged);
+      // shutdown mechanism
+      if (tsk == nullptr) {
+        break;
+      }
 
-          // execute if no conflict
-          if (!conflict) {
-            this->execute_task(tsk);
-            set_null(thread_idx);
-            delete tsk;
-          }
-        }
+      if (tsk->fptr.fop == nullptr) {
+        // no I/O; see `add_work()`
+        uint64_t trace_start = trace::now();
+        tsk->callback();
+        trace::span("io", "work", trace_start);
+        this->finish_work(tsk);
+        continue;
       }
 
-      // now service `tsk_queue`
-      tsk = this->tsk_queue.pop();
-      // can be null if taken from `tsk_queue`
-      if (tsk == nullptr) {
-        // shutdown mechanism
-        if (this->shutdown.load() && backlog.empty()) {
-          break;
-        } else {
-          // wait for a push
-          this->tsk_queue.wait_for_push_notify();
-        }
-      } else {
-        // announce my task
-        set_task(thread_idx, tsk);
-
-        // check if conflict exists between `tsk` and other threads
-        bool conflict = false;
-        if (this->overlap_check) {
-          bool thread_writes = this->is_writes[thread_idx].load();
-          for (FBLAS_UINT i = 0; i < this->n_threads; i++) {
-            if (i != thread_idx) {
-              bool other_writes = this->is_writes[i].load();
-              // data race only if both write
-              // (R | W) and (W | R) is a WAR or RAW hazard that should be
-              // taken care of by adding dependencies in the task DAG
-              // (R | R) presents no hazard
-              if (thread_writes && other_writes) {
-                bool overlap = this->overlap(thread_idx, i);
-                if (overlap) {
-                  // conflict
-                  GLOG_WARN("conflict");
-                  set_null(thread_idx);
-                  backlog.push(tsk);
-                  conflict = true;
-                  break;
-                }
-              }
-            }
-          }
+      if (!merged.empty()) {
+        FBLAS_UINT bytes = tsk->sinfo.len_per_stride;
+        for (auto t : merged) {
+          bytes += t->sinfo.len_per_stride;
         }
+        auto     start = std::chrono::steady_clock::now();
+        uint64_t trace_start = trace::now();
+        this->execute_merged(tsk, merged);
+        trace::span("io", "merged-read", trace_start, "bytes", bytes);
+        this->finish_task(tsk, merged, bytes, elapsed_us(start));
+        continue;
+      }
 
-        // execute if no conflict
-        if (!conflict) {
-          this->execute_task(tsk);
-          set_null(thread_idx);
-          delete tsk;
-        }
+      // data race only if both write
+      // (R | W) and (W | R) is a WAR or RAW hazard that should be
+      // taken care of by adding dependencies in the task DAG
+      // (R | R) presents no hazard
+      bool      lock_ranges = this->overlap_check && tsk->is_write;
+      RangeList ranges;
+      if (lock_ranges) {
+        ranges = sector_ranges(tsk->fptr.foffset, tsk->sinfo);
+        this->write_locks.lock(tsk->fptr.fop, ranges);
+      }
+
+      FBLAS_UINT bytes = tsk->sinfo.n_strides * tsk->sinfo.len_per_stride;
+      auto       start = std::chrono::steady_clock::now();
+      uint64_t   trace_start = trace::now();
+      this->execute_task(tsk);
+      FBLAS_UINT us = elapsed_us(start);
+      trace::span("io", trace_names[(FBLAS_UINT) tsk->prio], trace_start,
+                  "bytes", bytes);
+
+      if (lock_ranges) {
+        this->write_locks.unlock(tsk->fptr.fop, ranges);
       }
+
+      this->finish_task(tsk, merged, bytes, us);
     }
 
     FlashFileHandle::deregister_thread();
@@ -360,21 +395,45 @@ GLOG_ASSERT(malloc_usable_size(buf) >= buf_size(sinfo),
     return;
   }
 
-  IoExecutor::IoExecutor(FBLAS_UINT n_threads)
-      : n_threads(n_threads), tsk_queue(nullptr) {
+  IoExecutor::IoExecutor(FBLAS_UINT n_threads, FBLAS_UINT n_read_threads,
+                         FBLAS_UINT n_write_threads)
+      : n_threads(n_threads), n_read_threads(n_read_threads),
+        n_write_threads(n_write_threads),
+        ctl(n_threads + n_read_threads + n_write_threads) {
     GLOG_DEBUG("init IO startup");
+    GLOG_ASSERT(n_threads + n_read_threads > 0 &&
+                    n_threads + n_write_threads > 0,
+                "need at least one IO thread for reads & writes");
     this->shutdown.store(false);
-    this->thread_tsks.resize(n_threads);
-    this->thread_muts = new std::mutex[n_threads];
-    this->is_writes = new std::atomic<bool>[n_threads];
-    for (FBLAS_UINT i = 0; i < n_threads; i++) {
-      set_null(i);
-      this->io_threads.push_back(
-          std::thread(&IoExecutor::io_thread_fn, this, i));
-      this->is_writes[i] = ATOMIC_FLAG_INIT;
+    this->n_pending.store(0);
+    this->overlap_check = true;
+    this->merge_gap = ((FBLAS_UINT) 1 << 16);
+    this->merge_max = ((FBLAS_UINT) 1 << 24);
+    this->n_executing = 0;
+    this->free_tasks = nullptr;
+    this->n_read_ops = 0;
+    this->n_read_bytes = 0;
+    this->n_write_ops = 0;
+    this->n_write_bytes = 0;
+    this->numa = false;
+    for (FBLAS_UINT p = 0; p < N_IO_PRIORITIES; p++) {
+      this->n_in_flight[p] = 0;
+      this->max_in_flight[p] = this->default_max_in_flight((IoPriority) p);
     }
 
-    this->overlap_check = true;
+    FBLAS_UINT thread_idx = 0;
+    for (FBLAS_UINT i = 0; i < n_threads; i++) {
+      this->io_threads.push_back(std::thread(&IoExecutor::io_thread_fn, this,
+                                             thread_idx++, ThreadRole::Any));
+    }
+    for (FBLAS_UINT i = 0; i < n_read_threads; i++) {
+      this->io_threads.push_back(std::thread(&IoExecutor::io_thread_fn, this,
+                                             thread_idx++, ThreadRole::Read));
+    }
+    for (FBLAS_UINT i = 0; i < n_write_threads; i++) {
+      this->io_threads.push_back(std::thread(&IoExecutor::io_thread_fn, this,
+                                             thread_idx++, ThreadRole::Write));
+    }
 
     GLOG_DEBUG("IO startup complete");
   }
@@ -382,30 +441,61 @@ GLOG_ASSERT(malloc_usable_size(buf) >= buf_size(sinfo),
   IoExecutor::~IoExecutor() {
     GLOG_DEBUG("init IO shutdown");
 
+    mutex_locker lk(this->queue_mut);
     this->shutdown.store(true);
-    this->tsk_queue.push_notify_all();
+    lk.unlock();
+    this->queue_cv.notify_all();
     for (auto& thr : this->io_threads) {
       thr.join();
     }
 
-    delete[] this->thread_muts;
-    delete[] this->is_writes;
+    // all tasks are back in the pool
+    while (this->free_tasks != nullptr) {
+      IoTask* next = this->free_tasks->next;
+      delete this->free_tasks;
+      this->free_tasks = next;
+    }
+
     GLOG_DEBUG("IO shutdown complete");
   }
 
   void IoExecutor::add_read(flash_ptr<void> fptr, StrideInfo sinfo, void* buf,
-                            std::function<void(void)> callback) {
+                            IoCallback&& callback, IoPriority prio) {
     GLOG_DEBUG("adding read");
-    IoTask* tsk = new IoTask(fptr, sinfo, buf, false, callback);
-    this->tsk_queue.push(tsk);
-    this->tsk_queue.push_notify_one();
+    GLOG_ASSERT(prio != IoPriority::WriteBack, "bad read priority");
+    mutex_locker lk(this->queue_mut);
+    IoTask*      tsk = this->alloc_task();
+    tsk->init(fptr, sinfo, buf, false, std::move(callback), prio);
+    this->push_task(tsk, lk);
   }
 
   void IoExecutor::add_write(flash_ptr<void> fptr, StrideInfo sinfo, void* buf,
-                             std::function<void(void)> callback) {
+                             IoCallback&& callback) {
     GLOG_DEBUG("adding write");
-    IoTask* tsk = new IoTask(fptr, sinfo, buf, true, callback);
-    this->tsk_queue.push(tsk);
-    this->tsk_queue.push_notify_one();
+    mutex_locker lk(this->queue_mut);
+    IoTask*      tsk = this->alloc_task();
+    tsk->init(fptr, sinfo, buf, true, std::move(callback),
+              IoPriority::WriteBack);
+    this->push_task(tsk, lk);
+  }
+
+  void IoExecutor::add_write(flash_ptr<void> fptr, StrideInfo sinfo,
+                             GatherList&& gbufs, IoCallback&& callback) {
+    GLOG_DEBUG("adding gather write");
+    mutex_locker lk(this->queue_mut);
+    IoTask*      tsk = this->alloc_task();
+    tsk->init(fptr, sinfo, gbufs[0].first, true, std::move(callback),
+              IoPriority::WriteBack);
+    tsk->gbufs = std::move(gbufs);
+    this->push_task(tsk, lk);
+  }
+
+  void IoExecutor::add_work(IoCallback&& work, IoPriority prio) {
+    GLOG_DEBUG("adding work");
+    mutex_locker lk(this->queue_mut);
+    IoTask*      tsk = this->alloc_task();
+    tsk->init(flash_ptr<void>(), {0, 0, 0}, nullptr,
+              prio == IoPriority::WriteBack, std::move(work), prio);
+    this->push_task(tsk, lk);
   }
 }  // namespace flash
@@ -0,0 +1,192 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "scheduler/numa.h"
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "bof_utils.h"
+
+// from <numaif.h>; libnuma is not required
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+
+namespace {
+  const char *NODE_DIR = "/sys/devices/system/node";
+  // max # of node ids passed to `mbind`
+  const FBLAS_UINT MAX_NODE_IDS = 1024;
+  const FBLAS_UINT BITS_PER_WORD = 8 * sizeof(unsigned long);
+
+  struct Node {
+    FBLAS_UINT     id;  // kernel node id
+    flash::CoreSet cores;
+  };
+
+  struct Topology {
+    std::vector<Node>                          nodes;
+    std::unordered_map<FBLAS_UINT, FBLAS_UINT> core_to_node;
+    flash::CoreSet                             all_cores;
+  };
+
+  // parses a cpulist like `0-3,8,10-11`
+  flash::CoreSet parse_cpulist(const std::string &list) {
+    flash::CoreSet     cores;
+    std::istringstream ss(list);
+    std::string        range;
+    while (std::getline(ss, range, ',')) {
+      if (range.empty() || range[0] == '\n') {
+        continue;
+      }
+      size_t     dash = range.find('-');
+      FBLAS_UINT first = std::strtoul(range.c_str(), nullptr, 10);
+      FBLAS_UINT last =
+          (dash == std::string::npos
+               ? first
+               : std::strtoul(range.c_str() + dash + 1, nullptr, 10));
+      for (FBLAS_UINT c = first; c <= last; c++) {
+        cores.push_back(c);
+      }
+    }
+    return cores;
+  }
+
+  Topology load_topology() {
+    Topology topo;
+
+    // cores the process may run on
+    std::unordered_set<FBLAS_UINT> allowed;
+    cpu_set_t                      set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+      for (FBLAS_UINT core = 0; core < CPU_SETSIZE; core++) {
+        if (CPU_ISSET(core, &set)) {
+          allowed.insert(core);
+        }
+      }
+    }
+
+    DIR *dir = opendir(NODE_DIR);
+    if (dir != nullptr) {
+      struct dirent *ent;
+      while ((ent = readdir(dir)) != nullptr) {
+        if (strncmp(ent->d_name, "node", 4) != 0 ||
+            !isdigit(ent->d_name[4])) {
+          continue;
+        }
+        Node node;
+        node.id = std::strtoul(ent->d_name + 4, nullptr, 10);
+        std::ifstream in(std::string(NODE_DIR) + "/" + ent->d_name +
+                         "/cpulist");
+        std::string   list;
+        std::getline(in, list);
+        for (auto core : parse_cpulist(list)) {
+          if (allowed.find(core) != allowed.end()) {
+            node.cores.push_back(core);
+          }
+        }
+        // memory-only nodes & nodes outside the affinity mask
+        if (!node.cores.empty()) {
+          topo.nodes.push_back(node);
+        }
+      }
+      closedir(dir);
+    }
+
+    if (topo.nodes.empty()) {
+      // no NUMA information; one node with all allowed cores
+      Node node;
+      node.id = 0;
+      node.cores.assign(allowed.begin(), allowed.end());
+      if (node.cores.empty()) {
+        node.cores.push_back(0);
+      }
+      std::sort(node.cores.begin(), node.cores.end());
+      topo.nodes.push_back(node);
+    }
+    std::sort(topo.nodes.begin(), topo.nodes.end(),
+              [](const Node &l, const Node &r) { return l.id < r.id; });
+    for (FBLAS_UINT i = 0; i < topo.nodes.size(); i++) {
+      for (auto core : topo.nodes[i].cores) {
+        topo.core_to_node[core] = i;
+        topo.all_cores.push_back(core);
+      }
+    }
+    GLOG_DEBUG("NUMA:n_nodes=", topo.nodes.size());
+    return topo;
+  }
+
+  const Topology &topology() {
+    static Topology topo = load_topology();
+    return topo;
+  }
+}  // namespace
+
+namespace flash {
+  namespace numa {
+    FBLAS_UINT n_nodes() {
+      return topology().nodes.size();
+    }
+
+    const CoreSet &node_cores(FBLAS_UINT node) {
+      GLOG_ASSERT(node < n_nodes(), "bad node=", node);
+      return topology().nodes[node].cores;
+    }
+
+    FBLAS_UINT core_node(FBLAS_UINT core) {
+      const Topology &topo = topology();
+      auto            it = topo.core_to_node.find(core);
+      return (it == topo.core_to_node.end() ? 0 : it->second);
+    }
+
+    void pin_thread(const CoreSet &cores) {
+      const CoreSet &pin_cores = (cores.empty() ? topology().all_cores : cores);
+      cpu_set_t      set;
+      CPU_ZERO(&set);
+      for (auto core : pin_cores) {
+        CPU_SET(core, &set);
+      }
+      int ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+      if (ret != 0) {
+        GLOG_WARN("pthread_setaffinity_np failed with ret=", ret);
+      }
+    }
+
+    bool prefer_node(void *buf, FBLAS_UINT len, FBLAS_UINT node) {
+      FBLAS_UINT id = topology().nodes[node].id;
+      if (id >= MAX_NODE_IDS) {
+        return false;
+      }
+      // `mbind` takes whole pages; skip partial pages at either end
+      FBLAS_UINT page = sysconf(_SC_PAGESIZE);
+      FBLAS_UINT start = ROUND_UP((FBLAS_UINT) buf, page);
+      FBLAS_UINT end = ROUND_DOWN((FBLAS_UINT) buf + len, page);
+      if (end <= start) {
+        return true;
+      }
+
+      unsigned long mask[MAX_NODE_IDS / BITS_PER_WORD] = {};
+      mask[id / BITS_PER_WORD] = (1UL << (id % BITS_PER_WORD));
+      long ret = syscall(SYS_mbind, (void *) start, end - start,
+                         MPOL_PREFERRED, mask, MAX_NODE_IDS + 1, 0);
+      if (ret != 0) {
+        GLOG_DEBUG("mbind failed with errno=", errno);
+        return false;
+      }
+      return true;
+    }
+  }  // namespace numa
+}  // namespace flash
@@ -0,0 +1,77 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "scheduler/range_lock.h"
+#include "bof_utils.h"
+
+namespace flash {
+  RangeList sector_ranges(FBLAS_UINT offset, const StrideInfo &sinfo) {
+    RangeList ranges;
+    for (FBLAS_UINT i = 0; i < sinfo.n_strides; i++) {
+      FBLAS_UINT start = offset + i * sinfo.stride;
+      FBLAS_UINT end = start + sinfo.len_per_stride;
+      start = ROUND_DOWN(start, SECTOR_LEN);
+      end = ROUND_UP(end, SECTOR_LEN);
+      // strides sharing a sector merge into one range
+      if (!ranges.empty() && start <= ranges.back().second) {
+        ranges.back().second = std::max(ranges.back().second, end);
+      } else {
+        ranges.push_back(std::make_pair(start, end));
+      }
+    }
+
+    return ranges;
+  }
+
+  std::map<std::pair<BaseFileHandle *, FBLAS_UINT>, RangeLock::Held>::iterator
+  RangeLock::find_conflict(Shard &shard, BaseFileHandle *fop,
+                           const RangeList &ranges) {
+    for (auto &range : ranges) {
+      // last held range starting before `range` ends; held ranges are
+      // disjoint, so only it can overlap `range`
+      auto it = shard.held.lower_bound(std::make_pair(fop, range.second));
+      if (it == shard.held.begin()) {
+        continue;
+      }
+      it--;
+      if (it->first.first == fop && it->second.end > range.first) {
+        return it;
+      }
+    }
+
+    return shard.held.end();
+  }
+
+  void RangeLock::lock(BaseFileHandle *fop, const RangeList &ranges) {
+    Shard &      shard = this->shard_of(fop);
+    mutex_locker lk(shard.mut);
+    auto         conflict = this->find_conflict(shard, fop, ranges);
+    while (conflict != shard.held.end()) {
+      GLOG_DEBUG("CONFLICT:fop=", (FBLAS_UINT) fop,
+                 ", range=", conflict->first.second, "-", conflict->second.end);
+      // wait on the conflicting range only
+      auto cv = conflict->second.cv;
+      cv->wait(lk);
+      conflict = this->find_conflict(shard, fop, ranges);
+    }
+
+    for (auto &range : ranges) {
+      Held h;
+      h.end = range.second;
+      h.cv = std::make_shared<std::condition_variable>();
+      shard.held.insert(
+          std::make_pair(std::make_pair(fop, range.first), std::move(h)));
+    }
+  }
+
+  void RangeLock::unlock(BaseFileHandle *fop, const RangeList &ranges) {
+    Shard &      shard = this->shard_of(fop);
+    mutex_locker lk(shard.mut);
+    for (auto &range : ranges) {
+      auto it = shard.held.find(std::make_pair(fop, range.first));
+      GLOG_ASSERT(it != shard.held.end(), "unlocking range not held");
+      it->second.cv->notify_all();
+      shard.held.erase(it);
+    }
+  }
+}  // namespace flash
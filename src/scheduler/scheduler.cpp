@@ -3,22 +3,53 @@
 
 #include "scheduler/scheduler.h"
 #include <cassert>
+#include <fstream>
+#include <limits>
 #include "bof_timer.h"
 
+namespace {
+  uint64_t clock_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+}  // namespace
+
 namespace flash {
+  thread_local FBLAS_UINT task_n_threads = 0;
+
   Scheduler::Scheduler(FBLAS_UINT n_io_threads, FBLAS_UINT n_compute_thr,
                        FBLAS_UINT max_mem)
-      : n_compute_thr(0), max_mem(max_mem), io_exec(n_io_threads),
+      : n_compute_thr(0), max_mem(max_mem),
+        io_exec(n_io_threads, N_READ_THR, N_WRITE_THR),
         cache(io_exec, max_mem), prio(cache) {
     this->shutdown.store(false);
+    for (FBLAS_UINT i = 0; i < N_TASK_STATES; i++) {
+      this->state_ns[i] = 0;
+    }
+    this->stats_period_ms = 1000;
+    this->compute_busy_ns = 0;
+    this->compute_limit = std::numeric_limits<FBLAS_UINT>::max();
+    this->task_threads = 0;
+    this->balance = false;
+    this->balance_period_ms = 250;
+    this->last_busy_ns = 0;
+    this->n_executing = 0;
+    this->numa = false;
+    for (FBLAS_UINT i = 0; i < numa::n_nodes(); i++) {
+      this->node_queues.emplace_back(new ConcurrentQueue<BaseTask*>());
+    }
     this->set_num_compute_threads(n_compute_thr);
     this->sched_thread = std::thread(&Scheduler::sched_thread_fn, this);
+    this->housekeeping_thread =
+        std::thread(&Scheduler::housekeeping_thread_fn, this);
   }
 
   Scheduler::~Scheduler() {
     GLOG_DEBUG("Destroying scheduler");
     this->shutdown.store(true);
     this->sched_thread.join();
+    this->housekeeping_thread.join();
 
     for (auto& thr : compute_threads) {
       this->complete_queue.push_notify_all();
@@ -34,12 +65,33 @@ namespace flash {
     GLOG_ASSERT(this->wait_tsks.empty(), "non-empty");
     GLOG_ASSERT(this->prio.empty(), "non-empty");
     GLOG_ASSERT(this->alloced_tsks.empty(), "non-empty");
-    GLOG_ASSERT(this->compute_queue.empty(), "non-empty");
+    GLOG_ASSERT(this->n_compute_queued() == 0, "non-empty");
     GLOG_ASSERT(this->complete_queue.empty(), "non-empty");
   }
 
   void Scheduler::flush_cache() {
-    this->cache.flush();
+    if (this->cache.persistent) {
+      this->cache.flush_retain();
+    } else {
+      this->cache.flush();
+    }
+  }
+
+  void Scheduler::evict(BaseFileHandle* fop) {
+    this->cache.evict_file(fop);
+  }
+
+  void Scheduler::set_status(BaseTask* tsk, TaskStatus st) {
+    TaskStatus old_st = tsk->get_status();
+    trace::task_state(tsk->get_id(), old_st, st);
+    uint64_t now = clock_ns();
+    if (tsk->st_start != 0) {
+      this->state_ns[old_st].fetch_add(now - tsk->st_start,
+                                       std::memory_order_relaxed);
+    }
+    // a completed task may be added again; don't count time since completion
+    tsk->st_start = (st == Complete ? 0 : now);
+    tsk->set_status(st);
   }
 
   // returns `true` if all buffers required by `tsk` are in `cache`
@@ -72,6 +124,7 @@ namespace flash {
 
   void Scheduler::sched_thread_fn() {
     GLOG_DEBUG("Scheduler Thread Up");
+    trace::name_thread("sched");
 
     // max # of tasks in memory completely
     // keep this at least (N_COMPUTE_THR * 3) for optimal pipelining
@@ -97,6 +150,7 @@ namespace flash {
     FBLAS_UINT       update_in = update_every;
     while (true) {
       timer.reset();
+      uint64_t tick_start = trace::now();
       /*
       GLOG_PASS("Scheduler state:complete_size=", complete_queue.size(),
                 ", wait_size=", wait_tsks.size(),
@@ -111,7 +165,7 @@ namespace flash {
                  ", compute_empty=", compute_queue.empty());
       */
       if (shutdown.load() && this->wait_tsks.empty() && this->prio.empty() &&
-          this->alloced_tsks.empty() && this->compute_queue.empty()) {
+          this->alloced_tsks.empty() && this->n_compute_queued() == 0) {
         break;
       }
 
@@ -124,13 +178,13 @@ namespace flash {
         tsks_in_mem--;
         this->c_rec.mark_complete(tsk->get_id());
         this->cache.release(tsk);
-        tsk->set_status(Complete);
+        set_status(tsk, Complete);
         BaseTask* next = tsk->next;
         if (next != nullptr) {
           GLOG_ASSERT(next->get_status() < AllocReady,
                       "bad next status, expected ", Wait, ", got ",
                       next->get_status());
-          next->set_status(Wait);
+          set_status(next, Wait);
           this->wait_tsks.push_back(next);
         }
         tsk = this->complete_queue.pop();
@@ -142,7 +196,7 @@ namespace flash {
       std::vector<BaseTask*> cur_ready_tsks =
           this->wait_tsks.filter(std::ref(wait_keep_fn));
       for (auto& tsk : cur_ready_tsks) {
-        tsk->set_status(AllocReady);
+        set_status(tsk, AllocReady);
         GLOG_DEBUG("READY:tsk_id=", tsk->get_id());
       }
 
@@ -172,10 +226,15 @@ namespace flash {
         BaseTask* tsk = tsk_info.tsk;
         GLOG_ASSERT(tsk != nullptr, "bad while condition");
 
-        if (this->cache.allocate(tsk)) {
+        // reads for tasks beyond those the compute threads will pick up next
+        // are prefetches
+        bool prefetch =
+            (this->alloced_tsks.size() + this->n_compute_queued() >=
+             this->n_compute_thr.load());
+        if (this->cache.allocate(tsk, prefetch)) {
           tsks_in_mem++;
           alloced_tsks.push_back(tsk);
-          tsk->set_status(Alloc);
+          set_status(tsk, Alloc);
           num_ready_tsks--;
         } else {
           this->prio.return_prio(tsk_info);
@@ -190,16 +249,26 @@ namespace flash {
       // if added new compute tasks for compute threads, wake all of them up
       if (!compute_ready_tsks.empty()) {
         for (auto& tsk : compute_ready_tsks) {
-          tsk->set_status(ComputeReady);
+          set_status(tsk, ComputeReady);
+        }
+        if (this->numa.load()) {
+          // to the queue of the node holding the task's buffers
+          for (auto& tsk : compute_ready_tsks) {
+            this->node_queues[tsk->numa_node]->push(tsk);
+          }
+        } else {
+          this->compute_queue.insert(compute_ready_tsks.begin(),
+                                     compute_ready_tsks.end());
         }
-        this->compute_queue.insert(compute_ready_tsks.begin(),
-                                   compute_ready_tsks.end());
         this->compute_queue.push_notify_all();
       }
 
       // service backlogs from all decisions made now
       this->cache.service_backlog();
 
+      trace::span("sched", "tick", tick_start, "n_completions",
+                  n_completions);
+
       // Metrics
       FPTYPE elapsed_ms = timer.elapsed();
       total_sched_time += elapsed_ms;
@@ -218,11 +287,19 @@ namespace flash {
   void Scheduler::compute_thread_fn() {
     FBLAS_UINT cthread_id = this->n_compute_thr.fetch_add(1);
     GLOG_INFO("Compute Thread #", cthread_id, " Up");
+    trace::name_thread("compute");
+    // `cthread_id` is re-used after the thread count shrinks; slots aren't
+    std::unique_lock<std::mutex> stats_lk(this->stats_mut);
+    this->compute_idle_ns.emplace_back(0);
+    std::atomic<uint64_t>& idle_ns = this->compute_idle_ns.back();
+    // home NUMA node; slots are spread over nodes round-robin
+    FBLAS_UINT node = (this->compute_idle_ns.size() - 1) % numa::n_nodes();
+    stats_lk.unlock();
     while (true) {
-      if (cthread_id >= this->n_compute_thr.load()) {
+      if (cthread_id >= this->n_active_compute()) {
         if (this->shutdown.load() && this->wait_tsks.empty() &&
             this->prio.empty() && this->alloced_tsks.empty() &&
-            this->compute_queue.empty()) {
+            this->n_compute_queued() == 0) {
           break;
         } else {
           // if(!wait_tsks.empty()){
@@ -242,22 +319,38 @@ namespace flash {
           //   asked to shutdown");
           // }
           // disable thread
+          uint64_t idle_start = clock_ns();
           ::usleep(100000);  // 100ms
+          idle_ns.fetch_add(clock_ns() - idle_start,
+                            std::memory_order_relaxed);
         }
       } else {
-        BaseTask* tsk = this->compute_queue.pop();
+        BaseTask* tsk = this->pop_compute(node);
         if (tsk == nullptr) {
           if (this->shutdown.load() && this->wait_tsks.empty() &&
               this->prio.empty() && this->alloced_tsks.empty() &&
-              this->compute_queue.empty()) {
+              this->n_compute_queued() == 0) {
             break;
           } else {
+            uint64_t idle_start = clock_ns();
             this->compute_queue.wait_for_push_notify();
+            idle_ns.fetch_add(clock_ns() - idle_start,
+                              std::memory_order_relaxed);
           }
         } else {
           GLOG_DEBUG("executing tsk_id=", tsk->get_id());
-          tsk->set_status(Compute);
+          set_status(tsk, Compute);
+          CoreSet  task_cores = this->start_task(tsk, node);
+          uint64_t start = trace::now();
+          uint64_t busy_start = clock_ns();
           tsk->execute();
+          this->compute_busy_ns.fetch_add(clock_ns() - busy_start,
+                                          std::memory_order_relaxed);
+          trace::span("compute", "execute", start, "tsk_id", tsk->get_id());
+          this->n_executing--;
+          if (!task_cores.empty()) {
+            this->cores.release(task_cores);
+          }
           this->complete_queue.push(tsk);
         }
       }
@@ -266,15 +359,194 @@ namespace flash {
     this->n_compute_thr--;
   }
 
+  CoreSet Scheduler::start_task(BaseTask* tsk, FBLAS_UINT node) {
+    this->n_executing++;
+    FBLAS_UINT hint = this->task_threads.load();
+    bool       numa = this->numa.load();
+    if (!this->cores.enabled.load()) {
+      task_n_threads = hint;
+      // whole team anywhere on the home node
+      this->cores.pin_threads(numa ? numa::node_cores(node) : CoreSet(),
+                              false);
+      return {};
+    }
+
+    // every active compute thread may soon run a task; a momentarily empty
+    // compute queue must not hand one task the whole budget
+    CoreSet task_cores = this->cores.acquire(
+        std::max(this->n_active_compute(), (FBLAS_UINT) 1),
+        (hint != 0 ? hint : std::numeric_limits<FBLAS_UINT>::max()),
+        (numa ? numa::node_cores(node) : CoreSet()));
+    task_n_threads = std::max(task_cores.size(), (size_t) 1);
+    this->cores.pin_threads(this->cores.pin.load() ? task_cores : CoreSet());
+    GLOG_DEBUG("CORES:tsk_id=", tsk->get_id(), ", n_cores=",
+               task_cores.size(), ", n_running=", this->n_executing.load());
+    return task_cores;
+  }
+
+  BaseTask* Scheduler::pop_compute(FBLAS_UINT node) {
+    // own node, then tasks not steered to a node, then other nodes
+    BaseTask* tsk = this->node_queues[node]->pop();
+    if (tsk == nullptr) {
+      tsk = this->compute_queue.pop();
+    }
+    for (FBLAS_UINT i = 1; tsk == nullptr && i < this->node_queues.size();
+         i++) {
+      tsk = this->node_queues[(node + i) % this->node_queues.size()]->pop();
+    }
+    return tsk;
+  }
+
+  FBLAS_UINT Scheduler::n_compute_queued() {
+    FBLAS_UINT n = this->compute_queue.size();
+    for (auto& q : this->node_queues) {
+      n += q->size();
+    }
+    return n;
+  }
+
+  // periodic work off the scheduler thread : background flush, compute
+  // thread balancing & stats dumps
+  void Scheduler::housekeeping_thread_fn() {
+    GLOG_DEBUG("Housekeeping Thread Up");
+    trace::name_thread("housekeeping");
+    const FBLAS_UINT sleep_ms = 50;
+    auto             last_dump = std::chrono::steady_clock::now();
+    while (!this->shutdown.load()) {
+      this->cache.flush_dirty(this->io_exec.is_idle());
+      this->balance_threads();
+      this->dump_stats(last_dump);
+      ::usleep(sleep_ms * 1000);
+    }
+    GLOG_DEBUG("Housekeeping Thread Down");
+  }
+
+  void Scheduler::dump_stats(std::chrono::steady_clock::time_point& last_dump) {
+    auto                         now = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lk(this->stats_mut);
+    if (this->stats_file.empty() ||
+        now - last_dump < std::chrono::milliseconds(this->stats_period_ms)) {
+      return;
+    }
+    std::string path = this->stats_file;
+    lk.unlock();
+    last_dump = now;
+
+    std::ofstream out(path, std::ios::app);
+    if (!out) {
+      GLOG_WARN("failed to open ", path, " for stats");
+      return;
+    }
+    out << this->get_stats().to_json() << "\n";
+  }
+
+  void Scheduler::balance_threads() {
+    auto                         now = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lk(this->balance_mut);
+    uint64_t elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              now - this->last_balance)
+                              .count();
+    if (!this->balance ||
+        elapsed_ns < this->balance_period_ms * (uint64_t) 1000000) {
+      return;
+    }
+    this->last_balance = now;
+
+    uint64_t busy_ns = this->compute_busy_ns.load();
+    float    util = (float) (busy_ns - this->last_busy_ns) /
+                 ((float) elapsed_ns * (float) this->n_active_compute());
+    this->last_busy_ns = busy_ns;
+    if (!this->balancer.update(util, this->n_compute_queued(),
+                               this->io_exec.n_queued_reads())) {
+      return;
+    }
+    this->compute_limit = this->balancer.get_compute_threads();
+    this->task_threads = this->balancer.get_task_threads();
+    this->io_exec.set_depth_limit(this->balancer.get_io_limit());
+  }
+
+  void Scheduler::set_balancing(bool enable, FBLAS_UINT period_ms) {
+    std::unique_lock<std::mutex> lk(this->balance_mut);
+    this->balance_period_ms = period_ms;
+    if (enable == this->balance) {
+      return;
+    }
+    this->balance = enable;
+    if (enable) {
+      this->balancer.reset(std::thread::hardware_concurrency(),
+                           this->n_compute_thr.load(),
+                           this->io_exec.get_stats().max_depth);
+      this->last_balance = std::chrono::steady_clock::now();
+      this->last_busy_ns = this->compute_busy_ns.load();
+    } else {
+      this->compute_limit = std::numeric_limits<FBLAS_UINT>::max();
+      this->task_threads = 0;
+      this->io_exec.set_depth_limit(0);
+    }
+  }
+
+  Stats Scheduler::get_stats() {
+    Stats stats;
+    this->cache.fill_stats(stats);
+    this->io_exec.fill_stats(stats);
+    for (FBLAS_UINT i = 0; i < N_TASK_STATES; i++) {
+      stats.state_ms[i] = (double) this->state_ns[i].load() / 1e6;
+    }
+    stats.compute_threads = this->n_active_compute();
+    stats.task_threads = this->task_threads.load();
+    std::unique_lock<std::mutex> lk(this->stats_mut);
+    for (auto& idle_ns : this->compute_idle_ns) {
+      stats.compute_idle_ms.push_back((double) idle_ns.load() / 1e6);
+    }
+    return stats;
+  }
+
   void Scheduler::add_task(BaseTask* tsk) {
     GLOG_DEBUG("adding tsk_id=", tsk->get_id(), " to wait");
-    tsk->set_status(Wait);
+    set_status(tsk, Wait);
     this->wait_tsks.push_back(tsk);
   }
 
   void Scheduler::set_options(SchedulerOptions& sched_opts) {
     this->io_exec.overlap_check = sched_opts.enable_overlap_check;
+    this->io_exec.merge_gap = sched_opts.io_merge_gap;
+    this->io_exec.merge_max = sched_opts.io_merge_max;
+    this->io_exec.ctl.set_enabled(sched_opts.enable_adaptive_io);
+    std::unique_lock<std::mutex> stats_lk(this->stats_mut);
+    this->stats_file = sched_opts.stats_file;
+    this->stats_period_ms = sched_opts.stats_period_ms;
+    stats_lk.unlock();
+    this->set_balancing(sched_opts.enable_thread_balancing,
+                        sched_opts.balance_period_ms);
+    if (sched_opts.enable_core_budget) {
+      this->cores.setup(sched_opts.core_budget);
+    }
+    this->cores.pin = sched_opts.pin_task_threads;
+    this->cores.enabled = sched_opts.enable_core_budget;
+    this->cache.numa = sched_opts.enable_numa;
+    this->io_exec.numa = sched_opts.enable_numa;
+    this->numa = sched_opts.enable_numa;
     this->cache.single_use_discard = sched_opts.single_use_discard;
+    this->cache.persistent = sched_opts.persistent_cache;
+    this->cache.retain_size = sched_opts.retain_size;
+    this->cache.coalesce_window = sched_opts.write_coalesce_window;
+    this->cache.background_flush = sched_opts.enable_background_flush;
+    this->cache.dirty_high_ratio = sched_opts.dirty_high_ratio;
+    this->cache.dirty_low_ratio = sched_opts.dirty_low_ratio;
+    this->cache.flush_batch = sched_opts.background_flush_batch;
+    this->cache.ctier.max_size = sched_opts.compressed_tier_size;
+    this->cache.ctier.max_ratio = sched_opts.compressed_tier_max_ratio;
+    if (!this->cache.ctier.enabled()) {
+      this->cache.ctier.clear();
+    }
+    this->cache.ftier.setup(sched_opts.flash_tier_dir,
+                            sched_opts.flash_tier_size);
+    this->io_exec.set_max_in_flight(IoPriority::Demand,
+                                    sched_opts.io_demand_depth);
+    this->io_exec.set_max_in_flight(IoPriority::Prefetch,
+                                    sched_opts.io_prefetch_depth);
+    this->io_exec.set_max_in_flight(IoPriority::WriteBack,
+                                    sched_opts.io_write_back_depth);
     if (!this->prio.use_prio && sched_opts.enable_prioritizer) {
       this->prio.use_prio = sched_opts.enable_prioritizer;
       this->prio.update();
@@ -0,0 +1,58 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "scheduler/stats.h"
+#include <sstream>
+
+namespace {
+  template<typename T>
+  void write_array(std::ostringstream &out, const char *name, const T *vals,
+                   FBLAS_UINT n) {
+    out << ",\"" << name << "\":[";
+    for (FBLAS_UINT i = 0; i < n; i++) {
+      out << (i ? "," : "") << vals[i];
+    }
+    out << "]";
+  }
+
+  void write_uint(std::ostringstream &out, const char *name, FBLAS_UINT val) {
+    out << ",\"" << name << "\":" << val;
+  }
+}  // namespace
+
+namespace flash {
+  std::string Stats::to_json() const {
+    std::ostringstream out;
+    out << "{\"cache_hits\":" << this->cache_hits;
+    write_uint(out, "cache_misses", this->cache_misses);
+    write_uint(out, "cache_evictions", this->cache_evictions);
+    write_uint(out, "cache_write_backs", this->cache_write_backs);
+    write_uint(out, "real_size", this->real_size);
+    write_uint(out, "peak_real_size", this->peak_real_size);
+    write_uint(out, "commit_size", this->commit_size);
+    write_uint(out, "peak_commit_size", this->peak_commit_size);
+    write_uint(out, "compressed_tier_hits", this->compressed_tier_hits);
+    write_uint(out, "flash_tier_hits", this->flash_tier_hits);
+
+    write_uint(out, "read_ops", this->read_ops);
+    write_uint(out, "read_bytes", this->read_bytes);
+    write_uint(out, "write_ops", this->write_ops);
+    write_uint(out, "write_bytes", this->write_bytes);
+    write_array(out, "read_latency_us", this->read_latency_us,
+                N_LATENCY_BUCKETS);
+    write_array(out, "write_latency_us", this->write_latency_us,
+                N_LATENCY_BUCKETS);
+    write_array(out, "queued", this->queued, N_IO_PRIORITIES);
+    write_array(out, "in_flight", this->in_flight, N_IO_PRIORITIES);
+    write_uint(out, "io_depth", this->io.depth);
+    write_uint(out, "io_chunk_size", this->io.chunk_size);
+
+    write_array(out, "state_ms", this->state_ms, N_TASK_STATES);
+    write_array(out, "compute_idle_ms", this->compute_idle_ms.data(),
+                this->compute_idle_ms.size());
+    write_uint(out, "compute_threads", this->compute_threads);
+    write_uint(out, "task_threads", this->task_threads);
+    out << "}";
+    return out.str();
+  }
+}  // namespace flash
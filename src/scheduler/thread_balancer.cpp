@@ -0,0 +1,69 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "scheduler/thread_balancer.h"
+#include <algorithm>
+#include "bof_logger.h"
+
+namespace flash {
+  ThreadBalancer::ThreadBalancer() {
+    this->reset(1, 1, 1);
+  }
+
+  void ThreadBalancer::reset(FBLAS_UINT n_cores, FBLAS_UINT max_compute,
+                             FBLAS_UINT max_io) {
+    this->n_cores = std::max(n_cores, (FBLAS_UINT) 1);
+    this->max_compute = std::max(max_compute, (FBLAS_UINT) 1);
+    this->max_io = std::max(max_io, (FBLAS_UINT) 1);
+    // keep some reads flowing in compute-bound phases
+    this->min_io = std::max(this->max_io / 4, (FBLAS_UINT) 1);
+    this->n_compute = this->max_compute;
+    this->io_limit = this->max_io;
+    this->update_task_threads();
+  }
+
+  void ThreadBalancer::update_task_threads() {
+    FBLAS_UINT io_cores = this->io_limit / IO_PER_CORE;
+    FBLAS_UINT compute_cores =
+        (this->n_cores > io_cores ? this->n_cores - io_cores : 1);
+    this->task_threads =
+        std::max(compute_cores / this->n_compute, (FBLAS_UINT) 1);
+  }
+
+  bool ThreadBalancer::update(float util, FBLAS_UINT compute_backlog,
+                              FBLAS_UINT io_backlog) {
+    FBLAS_UINT old_compute = this->n_compute;
+    FBLAS_UINT old_io = this->io_limit;
+    FBLAS_UINT old_task_threads = this->task_threads;
+
+    if (util < LOW_UTIL && io_backlog > 0 && compute_backlog == 0) {
+      // I/O-bound
+      if (this->n_compute > 1) {
+        this->n_compute--;
+      }
+      if (this->io_limit < this->max_io) {
+        this->io_limit++;
+      }
+    } else if (util > HIGH_UTIL && compute_backlog >= this->n_compute) {
+      // compute-bound
+      if (this->n_compute < this->max_compute) {
+        this->n_compute++;
+      }
+      if (this->io_limit > this->min_io) {
+        this->io_limit--;
+      }
+    }
+    this->update_task_threads();
+
+    if (this->n_compute == old_compute && this->io_limit == old_io &&
+        this->task_threads == old_task_threads) {
+      return false;
+    }
+    GLOG_DEBUG("BALANCE:util=", util, ", compute_backlog=", compute_backlog,
+               ", io_backlog=", io_backlog, ", n_compute=", old_compute, "->",
+               this->n_compute, ", io_limit=", old_io, "->", this->io_limit,
+               ", task_threads=", old_task_threads, "->",
+               this->task_threads);
+    return true;
+  }
+}  // namespace flash
@@ -0,0 +1,271 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "scheduler/tracer.h"
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+#include "bof_logger.h"
+
+namespace {
+  // # of events in one chunk of a thread buffer
+  const uint64_t CHUNK_EVENTS = ((uint64_t) 1 << 14);
+  // max # of chunks per thread; later events are dropped
+  const uint64_t MAX_CHUNKS = 256;
+
+  struct Event {
+    uint64_t    ts;   // ns since `start()`
+    uint64_t    dur;  // ns; spans only
+    uint64_t    id;   // task id; async events only
+    uint64_t    arg;
+    const char *cat;
+    const char *name;
+    const char *arg_name;
+    char        phase;  // Chrome trace phase
+  };
+
+  // events of one thread
+  // written only by the owning thread, read by `stop()`
+  struct ThreadBuffer {
+    FBLAS_UINT  tid;
+    const char *name = nullptr;
+    // generation of `start()` the events belong to
+    std::atomic<uint64_t> gen{0};
+    // # of events written; published after the event
+    std::atomic<uint64_t> n_events{0};
+    std::atomic<uint64_t> n_dropped{0};
+    std::atomic<Event *>  chunks[MAX_CHUNKS];
+
+    ThreadBuffer(FBLAS_UINT tid) : tid(tid) {
+      for (uint64_t i = 0; i < MAX_CHUNKS; i++) {
+        this->chunks[i] = nullptr;
+      }
+    }
+  };
+
+  // steady clock time of `start()`, in ns
+  std::atomic<uint64_t> epoch_ns(0);
+  std::atomic<uint64_t> cur_gen(0);
+
+  uint64_t clock_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  // all thread buffers ever created; never shrinks & lives until exit, as
+  // library threads may record until they are joined at exit
+  // NOTE :: function-local so that threads spawned during static init of
+  // other translation units (`flash::sched`) can register
+  std::mutex                   buffers_mut;
+  std::vector<ThreadBuffer *> &all_buffers() {
+    static std::vector<ThreadBuffer *> buffers;
+    return buffers;
+  }
+
+  thread_local ThreadBuffer *local_buffer = nullptr;
+
+  ThreadBuffer *get_buffer() {
+    if (local_buffer == nullptr) {
+      std::unique_lock<std::mutex> lk(buffers_mut);
+      local_buffer = new ThreadBuffer(all_buffers().size());
+      all_buffers().push_back(local_buffer);
+    }
+    return local_buffer;
+  }
+
+  void record(const Event &evt) {
+    ThreadBuffer *buf = get_buffer();
+    uint64_t      gen = cur_gen.load(std::memory_order_acquire);
+    if (buf->gen.load(std::memory_order_relaxed) != gen) {
+      // first event since `start()`; re-use chunks
+      buf->n_events.store(0, std::memory_order_relaxed);
+      buf->n_dropped.store(0, std::memory_order_relaxed);
+      buf->gen.store(gen, std::memory_order_release);
+    }
+
+    uint64_t n = buf->n_events.load(std::memory_order_relaxed);
+    uint64_t chunk_idx = n / CHUNK_EVENTS;
+    if (chunk_idx >= MAX_CHUNKS) {
+      buf->n_dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    Event *chunk = buf->chunks[chunk_idx].load(std::memory_order_relaxed);
+    if (chunk == nullptr) {
+      chunk = new Event[CHUNK_EVENTS];
+      buf->chunks[chunk_idx].store(chunk, std::memory_order_release);
+    }
+    chunk[n % CHUNK_EVENTS] = evt;
+    buf->n_events.store(n + 1, std::memory_order_release);
+  }
+
+  const char *status_name(flash::TaskStatus st) {
+    switch (st) {
+      case flash::Wait:
+        return "Wait";
+      case flash::AllocReady:
+        return "AllocReady";
+      case flash::Alloc:
+        return "Alloc";
+      case flash::ComputeReady:
+        return "ComputeReady";
+      case flash::Compute:
+        return "Compute";
+      case flash::Complete:
+        return "Complete";
+      default:
+        return "Unknown";
+    }
+  }
+
+  void write_event(FILE *f, FBLAS_UINT tid, const Event &evt, bool &first) {
+    fprintf(f, "%s\n{\"ph\":\"%c\",\"cat\":\"%s\",\"name\":\"%s\",",
+            first ? "" : ",", evt.phase, evt.cat, evt.name);
+    first = false;
+    fprintf(f, "\"pid\":1,\"tid\":%lu,\"ts\":%.3f", (unsigned long) tid,
+            (double) evt.ts / 1e3);
+    if (evt.phase == 'X') {
+      fprintf(f, ",\"dur\":%.3f", (double) evt.dur / 1e3);
+    } else if (evt.phase == 'b' || evt.phase == 'e') {
+      fprintf(f, ",\"id\":\"0x%lx\"", (unsigned long) evt.id);
+    } else if (evt.phase == 'i') {
+      fprintf(f, ",\"s\":\"t\"");
+    }
+    if (evt.arg_name != nullptr) {
+      fprintf(f, ",\"args\":{\"%s\":%lu}", evt.arg_name,
+              (unsigned long) evt.arg);
+    }
+    fprintf(f, "}");
+  }
+}  // namespace
+
+namespace flash {
+  namespace trace {
+    std::atomic<bool> enabled(false);
+
+    uint64_t now() {
+      return clock_ns() - epoch_ns.load(std::memory_order_relaxed);
+    }
+
+    void start() {
+      epoch_ns.store(clock_ns());
+      cur_gen.fetch_add(1, std::memory_order_release);
+      enabled.store(true);
+      GLOG_INFO("tracing started");
+    }
+
+    void stop(const std::string &path) {
+      if (!enabled.exchange(false)) {
+        GLOG_WARN("tracing not started");
+        return;
+      }
+
+      FILE *f = fopen(path.c_str(), "w");
+      if (f == nullptr) {
+        GLOG_ERROR("failed to open ", path, " for trace");
+        return;
+      }
+      fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+      bool       first = true;
+      uint64_t   gen = cur_gen.load();
+      FBLAS_UINT n_written = 0;
+      FBLAS_UINT n_dropped = 0;
+
+      std::unique_lock<std::mutex> lk(buffers_mut);
+      for (auto buf : all_buffers()) {
+        if (buf->name != nullptr) {
+          fprintf(f,
+                  "%s\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,"
+                  "\"tid\":%lu,\"args\":{\"name\":\"%s-%lu\"}}",
+                  first ? "" : ",", (unsigned long) buf->tid, buf->name,
+                  (unsigned long) buf->tid);
+          first = false;
+        }
+        if (buf->gen.load(std::memory_order_acquire) != gen) {
+          continue;
+        }
+        uint64_t n = buf->n_events.load(std::memory_order_acquire);
+        for (uint64_t i = 0; i < n; i++) {
+          Event *chunk = buf->chunks[i / CHUNK_EVENTS].load();
+          write_event(f, buf->tid, chunk[i % CHUNK_EVENTS], first);
+        }
+        n_written += n;
+        n_dropped += buf->n_dropped.load();
+      }
+      lk.unlock();
+
+      fprintf(f, "\n]}\n");
+      fclose(f);
+      GLOG_INFO("trace:", path, ", n_events=", n_written,
+                ", n_dropped=", n_dropped);
+    }
+
+    void name_thread(const char *name) {
+      get_buffer()->name = name;
+    }
+
+    void task_state(FBLAS_UINT tsk_id, TaskStatus from, TaskStatus to) {
+      if (!enabled.load(std::memory_order_relaxed)) {
+        return;
+      }
+      Event evt;
+      evt.ts = now();
+      evt.dur = 0;
+      evt.id = tsk_id;
+      evt.arg = tsk_id;
+      evt.cat = "task";
+      evt.arg_name = "tsk_id";
+      // a task (re-)entering `Wait` has no span open
+      if (from != to && to != Wait) {
+        evt.name = status_name(from);
+        evt.phase = 'e';
+        record(evt);
+      }
+      if (to != Complete) {
+        evt.name = status_name(to);
+        evt.phase = 'b';
+        record(evt);
+      }
+    }
+
+    void span(const char *cat, const char *name, uint64_t start,
+              const char *arg_name, uint64_t arg) {
+      if (!enabled.load(std::memory_order_relaxed)) {
+        return;
+      }
+      uint64_t end = now();
+      if (start > end) {
+        // started before `start()`
+        return;
+      }
+      Event evt;
+      evt.ts = start;
+      evt.dur = end - start;
+      evt.id = 0;
+      evt.arg = arg;
+      evt.cat = cat;
+      evt.name = name;
+      evt.arg_name = arg_name;
+      evt.phase = 'X';
+      record(evt);
+    }
+
+    void instant(const char *cat, const char *name, const char *arg_name,
+                 uint64_t arg) {
+      if (!enabled.load(std::memory_order_relaxed)) {
+        return;
+      }
+      Event evt;
+      evt.ts = now();
+      evt.dur = 0;
+      evt.id = 0;
+      evt.arg = arg;
+      evt.cat = cat;
+      evt.name = name;
+      evt.arg_name = arg_name;
+      evt.phase = 'i';
+      record(evt);
+    }
+  }  // namespace trace
+}  // namespace flash